@@ -0,0 +1,216 @@
+#include "piecewise_linear_function.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <string>
+
+/*
+ * Microbenchmarks of PiecewiseLinearFunction kernels on seeded functions of 2 to 10000 pieces:
+ *
+ *     bench_plf [--csv] [--min-time ms] [filter]
+ *
+ * Each kernel is repeated until it runs at least min time, rows are reported as ns/op, pieces/s and
+ * allocations/op, allocations are counted by replaced global operator new. Inputs are the same on every run,
+ * so numbers before and after a change are comparable. Build with -DCMAKE_BUILD_TYPE=Release.
+ */
+
+static std::atomic<uint64_t> allocations_count{0};
+
+void* operator new(size_t size) {
+    allocations_count.fetch_add(1, std::memory_order_relaxed);
+    if (auto pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept {
+    std::free(pointer);
+}
+
+namespace {
+
+constexpr uint64_t kSeed = 20240601;
+constexpr size_t kQueriesCount = 1024;
+
+// Keeps result of kernel from being optimized out
+template<typename T>
+void Keep(const T& value) {
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+/*
+ * Continuous function of pieces pieces on [0, pieces], breakpoints are jittered around integers, values
+ * increase by at least 0.1 on each piece, so function is strictly monotone and zero is near the middle
+ */
+PiecewiseLinearFunction CreateFunction(size_t pieces, uint64_t stream, bool is_increasing) {
+    RandomStream random(kSeed, stream);
+    std::vector<Point> points;
+    points.reserve(pieces + 1);
+    long double y = 0;
+    for (size_t i = 0; i <= pieces; i++) {
+        long double x = i;
+        if (i > 0 && i < pieces) {
+            x += random.Uniform<long double>(-0.4, 0.4);
+        }
+        if (i > 0) {
+            y += random.Uniform<long double>(0.1, 2);
+        }
+        points.emplace_back(x, y);
+    }
+    auto middle = points[pieces / 2].y_coord_ + 0.05;
+    for (auto&& point : points) {
+        point.y_coord_ = is_increasing ? point.y_coord_ - middle : middle - point.y_coord_;
+    }
+    return PiecewiseLinearFunction(points);
+}
+
+std::vector<long double> CreateQueries(size_t pieces, uint64_t stream) {
+    RandomStream random(kSeed, stream);
+    std::vector<long double> queries(kQueriesCount);
+    for (auto&& query : queries) {
+        query = random.Uniform<long double>(0, pieces);
+    }
+    return queries;
+}
+
+struct Measurement {
+    double ns_per_op;
+    double allocations_per_op;
+};
+
+/*
+ * Doubles iterations count until kernel runs at least min time, first call warms up caches
+ */
+Measurement Measure(const std::function<void()>& kernel, std::chrono::nanoseconds min_time) {
+    kernel();
+    for (uint64_t iterations = 1;; iterations *= 2) {
+        auto allocations_before = allocations_count.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < iterations; i++) {
+            kernel();
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        auto allocations = allocations_count.load(std::memory_order_relaxed) - allocations_before;
+        if (elapsed >= min_time || iterations >= (uint64_t(1) << 40)) {
+            return {std::chrono::duration<double, std::nano>(elapsed).count() / iterations,
+                    static_cast<double>(allocations) / iterations};
+        }
+    }
+}
+
+struct Options {
+    bool is_csv = false;
+    std::chrono::nanoseconds min_time = std::chrono::milliseconds(200);
+    std::string filter;
+};
+
+class Report {
+public:
+    explicit Report(const Options& options) : options_(options) {
+        if (options_.is_csv) {
+            std::printf("kernel,pieces,ns_per_op,pieces_per_s,allocations_per_op\n");
+        } else {
+            std::printf("%-24s %8s %14s %14s %14s\n", "kernel", "pieces", "ns/op", "pieces/s", "allocs/op");
+        }
+    }
+
+    /*
+     * Kernel processes pieces pieces of input per call
+     */
+    void Run(const std::string& name, size_t pieces, const std::function<void()>& kernel) {
+        if (!options_.filter.empty() && name.find(options_.filter) == std::string::npos) {
+            return;
+        }
+        auto measurement = Measure(kernel, options_.min_time);
+        auto pieces_per_s = pieces * 1e9 / measurement.ns_per_op;
+        if (options_.is_csv) {
+            std::printf("%s,%zu,%.1f,%.4g,%.2f\n", name.c_str(), pieces, measurement.ns_per_op, pieces_per_s,
+                    measurement.allocations_per_op);
+        } else {
+            std::printf("%-24s %8zu %14.1f %14.4g %14.2f\n", name.c_str(), pieces, measurement.ns_per_op,
+                    pieces_per_s, measurement.allocations_per_op);
+        }
+        std::fflush(stdout);
+    }
+
+private:
+    const Options& options_;
+};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--csv") == 0) {
+            options.is_csv = true;
+        } else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            options.min_time = std::chrono::milliseconds(std::stoll(argv[++i]));
+        } else {
+            options.filter = argv[i];
+        }
+    }
+#if !defined(__OPTIMIZE__) || !defined(NDEBUG)
+    std::fprintf(stderr, "Warning: bench_plf is built without optimizations or with asserts, "
+            "numbers are not representative\n");
+#endif
+
+    Report report(options);
+    for (size_t pieces : {2, 10, 100, 1000, 10000}) {
+        auto increasing = CreateFunction(pieces, 4 * pieces, true);
+        auto other_increasing = CreateFunction(pieces, 4 * pieces + 1, true);
+        auto decreasing = CreateFunction(pieces, 4 * pieces + 2, false);
+        auto queries = CreateQueries(pieces, 4 * pieces + 3);
+        auto points = increasing.GetPoints();
+        size_t query = 0;
+
+        report.Run("construct_from_points", pieces, [&] {
+            Keep(PiecewiseLinearFunction(points));
+        });
+        report.Run("operator_plus", pieces, [&] {
+            Keep(increasing + other_increasing);
+        });
+        report.Run("operator_minus", pieces, [&] {
+            Keep(increasing - decreasing);
+        });
+        report.Run("inverse", pieces, [&] {
+            Keep(increasing.GetInverseFunction());
+        });
+        report.Run("mirror_x_and_y", pieces, [&] {
+            Keep(increasing.MirrorXAndY());
+        });
+        report.Run("value_at_point", pieces, [&] {
+            Keep(increasing.GetValueAtPoint(queries[query++ % kQueriesCount]));
+        });
+        report.Run("integrate", pieces, [&] {
+            auto from = queries[query++ % kQueriesCount];
+            auto to = queries[query++ % kQueriesCount];
+            Keep(increasing.Integrate(std::min(from, to), std::max(from, to)));
+        });
+        report.Run("find_zero", pieces, [&] {
+            Keep(increasing.FindFunctionZeroValue());
+        });
+    }
+    return 0;
+}
@@ -1,23 +1,26 @@
 #pragma once
 
 #include "star_chain_market.h"
+#include "lines_worklist.h"
+#include "local_search.h"
+#include "tree_dynamic_program.h"
 
-inline int AlgorithmProcessStarEdges(StarChainMarket& market, int& tasks_solved) {
+inline int AlgorithmProcessStarEdges(StarChainMarket& market, LinesWorklist& worklist, int& tasks_solved) {
     auto step1_changed_lines = 0;
     auto changed_lines = 0;
     do {
         step1_changed_lines = 0;
         // AddLinesFromL1ToLplus
-        step1_changed_lines += market.CompareWelrafeAndChangeLinesSubset(EdgeType::STAR_TO_CENTER,
+        step1_changed_lines += worklist.Process(EdgeType::STAR_TO_CENTER,
                 ConcurentTypes, AlgorithmType::L_plus, std::less_equal<>(), tasks_solved);
         //AddLinesFromL2ToLminus
-        step1_changed_lines += market.CompareWelrafeAndChangeLinesSubset(EdgeType::STAR_FROM_CENTER,
+        step1_changed_lines += worklist.Process(EdgeType::STAR_FROM_CENTER,
                 AdditionalTypes, AlgorithmType::L_minus, std::greater_equal<>(), tasks_solved);
         //AddLinesFromL1ToLminus
-        step1_changed_lines += market.CompareWelrafeAndChangeLinesSubset(EdgeType::STAR_TO_CENTER,
+        step1_changed_lines += worklist.Process(EdgeType::STAR_TO_CENTER,
                 AdditionalTypes, AlgorithmType::L_minus, std::greater_equal<>(), tasks_solved);
         //AddLinesFromL2ToLplus
-        step1_changed_lines += market.CompareWelrafeAndChangeLinesSubset(EdgeType::STAR_FROM_CENTER,
+        step1_changed_lines += worklist.Process(EdgeType::STAR_FROM_CENTER,
                 ConcurentTypes, AlgorithmType::L_plus, std::less_equal<>(), tasks_solved);
         changed_lines += step1_changed_lines;
     }
@@ -26,25 +29,25 @@ inline int AlgorithmProcessStarEdges(StarChainMarket& market, int& tasks_solved)
 }
 
 
-inline int AlgorithmProcessChainEdges(StarChainMarket& market, int& tasks_solved) {
+inline int AlgorithmProcessChainEdges(StarChainMarket& market, LinesWorklist& worklist, int& tasks_solved) {
     auto changed_lines = 0;
     auto step2_changed_lines = 0;
     do {
         step2_changed_lines = 0;
         // AddLinesFromL'1ToLplus
-        step2_changed_lines += market.CompareWelrafeAndChangeLinesSubset(EdgeType::CHAIN_TO_CENTER,
+        step2_changed_lines += worklist.Process(EdgeType::CHAIN_TO_CENTER,
                 ConcurentTypes,
                 AlgorithmType::L_plus, std::less_equal<>(), tasks_solved);
 
         //AddLinesFromL'2ToLminus
-        step2_changed_lines += market.CompareWelrafeAndChangeLinesSubset(EdgeType::CHAIN_FROM_CENTER,
+        step2_changed_lines += worklist.Process(EdgeType::CHAIN_FROM_CENTER,
                 AdditionalTypes,
                 AlgorithmType::L_minus, std::greater_equal<>(), tasks_solved);
         //AddLinesFromL'1ToLminus
-        step2_changed_lines += market.CompareWelrafeAndChangeLinesSubset(EdgeType::CHAIN_TO_CENTER,
+        step2_changed_lines += worklist.Process(EdgeType::CHAIN_TO_CENTER,
                 AdditionalTypes, AlgorithmType::L_minus, std::greater_equal<>(), tasks_solved);
         //AddLinesFromL'2ToLplus
-        step2_changed_lines += market.CompareWelrafeAndChangeLinesSubset(EdgeType::CHAIN_FROM_CENTER,
+        step2_changed_lines += worklist.Process(EdgeType::CHAIN_FROM_CENTER,
                 ConcurentTypes, AlgorithmType::L_plus, std::less_equal<>(), tasks_solved);
         changed_lines += step2_changed_lines;
     }
@@ -52,56 +55,93 @@ inline int AlgorithmProcessChainEdges(StarChainMarket& market, int& tasks_solved
     return changed_lines;
 }
 
-inline void Algorithm(StarChainMarket& market) {
+/*
+ * Undefined chain lines are decided jointly by dynamic program going along the chain, which hangs
+ * from the central node as a path, other lines keep their types. Returns count of lines which became L_plus:
+ * undefined lines are not expanded in auxiliary subtask, so only they change the solved market
+ */
+inline int AlgorithmProcessChainLinesJointly(StarChainMarket& market, LinesWorklist& worklist, int& tasks_solved) {
+    const auto undefined_chain_lines = market.GetUndefinedChainEdges();
+    auto result = TreeDynamicProgram(market, undefined_chain_lines).Solve();
+    tasks_solved += result.solved_subtasks_count;
+    auto changed_lines = 0;
+    for (auto&& edge : undefined_chain_lines) {
+        worklist.LineDecided(edge);
+        if (edge->GetAlgorithmType() == AlgorithmType::L_plus) {
+            changed_lines++;
+        }
+    }
+    return changed_lines;
+}
+
+struct AlgorithmOptions {
+    // Chain lines are compared before star lines
+    bool is_chain_first = false;
+    // Order of lines in comparisons, positions of lines in market edges, empty for market edges order
+    std::vector<size_t> lines_order;
+    bool use_local_search = true;
+    LinesOrderPolicy lines_order_policy = LinesOrderPolicy::IMPACT;
+    // Counters are printed to stdout
+    bool is_verbose = true;
+    // Checked between passes and local search moves, undefined lines are left L_minus when it holds
+    std::function<bool()> should_stop;
+};
+
+inline void Algorithm(StarChainMarket& market, const AlgorithmOptions& options = AlgorithmOptions()) {
     int count_solve_subtasks_count = 0;
+    auto should_stop = [&options] {
+        return options.should_stop && options.should_stop();
+    };
+    auto presolve_result = market.Presolve();
+    const auto free_lines = market.GetUndefinedEdges();
+    LinesWorklist worklist(market);
+    if (!options.lines_order.empty()) {
+        worklist.SetLinesOrder(options.lines_order);
+    }
+    worklist.SetLinesOrderPolicy(options.lines_order_policy);
 
     auto multiply_lines_in_chain_changed = 0;
+    int64_t passes_count = 0;
     do {
         auto changed_lines = 0;
         do {
             changed_lines = 0;
-            changed_lines += AlgorithmProcessStarEdges(market, count_solve_subtasks_count);
-            changed_lines += AlgorithmProcessChainEdges(market, count_solve_subtasks_count);
-        } while (market.UndefinedLinesCount() && changed_lines > 0);
+            passes_count++;
+            if (options.is_chain_first) {
+                changed_lines += AlgorithmProcessChainEdges(market, worklist, count_solve_subtasks_count);
+                changed_lines += AlgorithmProcessStarEdges(market, worklist, count_solve_subtasks_count);
+            } else {
+                changed_lines += AlgorithmProcessStarEdges(market, worklist, count_solve_subtasks_count);
+                changed_lines += AlgorithmProcessChainEdges(market, worklist, count_solve_subtasks_count);
+            }
+        } while (market.UndefinedLinesCount() && changed_lines > 0 && !should_stop());
 
         multiply_lines_in_chain_changed = 0;
         const auto undefined_chain_lines_count = market.GetUndefinedChainLinesCount();
-        if (undefined_chain_lines_count < 2) {
+        if (undefined_chain_lines_count < 2 || should_stop()) {
             break;
         }
-        auto bit_masks_map = GenerateBitMasks(undefined_chain_lines_count);
-        auto undefined_chain_lines = market.GetUndefinedChainEdges();
-        for (size_t i = 2; i <= undefined_chain_lines_count && multiply_lines_in_chain_changed == 0; i++) {
-            auto masks = bit_masks_map[i];
-            for (auto&& mask : masks) {
-                std::vector<std::shared_ptr<Edge>> lines_to_change_chain_to_center;
-                std::vector<std::shared_ptr<Edge>> lines_to_change_chain_from_center;
-                for (size_t j = 0; j < undefined_chain_lines.size(); j++) {
-                    if ((mask >> j) & 1) {
-                        auto curr_edge = undefined_chain_lines[i];
-                        if (curr_edge->GetEdgeType() == EdgeType::CHAIN_TO_CENTER) {
-                            lines_to_change_chain_to_center.emplace_back(curr_edge);
-                        } else if (curr_edge->GetEdgeType() == EdgeType::CHAIN_FROM_CENTER) {
-                            lines_to_change_chain_from_center.emplace_back(curr_edge);
-                        } else {
-                            throw std::runtime_error("Unsupported type");
-                        }
-                    }
-                }
-                multiply_lines_in_chain_changed +=
-                        market.CompareWelrafeAndChangeLinesSubsetForChainLines(lines_to_change_chain_to_center,
-                                lines_to_change_chain_from_center, EdgeType::CHAIN_FROM_CENTER, count_solve_subtasks_count);
-                if (multiply_lines_in_chain_changed) {
-                    break;
-                }
-                multiply_lines_in_chain_changed +=
-                        market.CompareWelrafeAndChangeLinesSubsetForChainLines(lines_to_change_chain_from_center,
-                                lines_to_change_chain_to_center, EdgeType::CHAIN_FROM_CENTER, count_solve_subtasks_count);
-                if (multiply_lines_in_chain_changed) {
-                    break;
-                }
-            }
-        }
+        multiply_lines_in_chain_changed = AlgorithmProcessChainLinesJointly(market, worklist, count_solve_subtasks_count);
     } while (market.UndefinedLinesCount() && multiply_lines_in_chain_changed > 0);
-    std::cout << "Algorithm solved AuxularitySubtasksCount: " << count_solve_subtasks_count << std::endl;
+
+    // Lines left undefined are not expanded in auxiliary subtask
+    for (auto&& edge : market.GetUndefinedEdges()) {
+        edge->SetAlgorithmType(AlgorithmType::L_minus);
+    }
+    LocalSearchResult local_search_result;
+    if (options.use_local_search) {
+        LocalSearch local_search(market, free_lines);
+        local_search.SetStopCondition(should_stop);
+        local_search_result = local_search.Solve();
+    }
+    count_solve_subtasks_count += local_search_result.solved_subtasks_count;
+    if (!options.is_verbose) {
+        return;
+    }
+    std::cout << "Algorithm solved AuxularitySubtasksCount: " << count_solve_subtasks_count
+              << " passes: " << passes_count << " (" << worklist.GetPassesCount() << " by line type)"
+              << " line tests: " << worklist.GetTestsCount()
+              << " presolved lines: " << presolve_result.GetFixedLinesCount()
+              << " local search moves: " << local_search_result.flip_moves_count + local_search_result.swap_moves_count
+              << std::endl;
 }
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "local_search.h"
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <optional>
+
+struct AnytimeSolverResult {
+    long double welfare = 0;
+    std::vector<bool> l_plus_lines_mask;
+    // Local optimum was reached before deadline
+    bool is_converged = false;
+    int64_t flip_moves_count = 0;
+    int64_t swap_moves_count = 0;
+    int64_t restarts_count = 0;
+    int64_t solved_subtasks_count = 0;
+    // Presolve is skipped when budget is spent before it starts
+    bool is_presolved = false;
+    // Presolve and first solve of incumbent, deadline isn't checked inside them
+    std::chrono::milliseconds startup_time{0};
+    std::chrono::milliseconds elapsed_time{0};
+};
+
+/*
+ * Solver with wall-clock budget which always keeps feasible incumbent types of lines. Starts from presolved
+ * market with free lines not expanded, then improves incumbent by local search: single line flips first and
+ * swaps of two lines when flips don't help. Time left after local optimum is spent on randomized restarts.
+ * Deadline is checked before presolve and between moves. Presolve and first solve of incumbent can't be
+ * interrupted, so budget is exceeded at most by startup time, reported in result, or by time of one move.
+ * Market is left solved with incumbent.
+ */
+class AnytimeSolver {
+public:
+    using Clock = std::function<std::chrono::steady_clock::time_point()>;
+
+    AnytimeSolver(StarChainMarket& market, std::chrono::milliseconds budget,
+            RandomStream& random = GetThreadRandomStream())
+            : market_(market), budget_(budget), random_(random) {}
+
+    /*
+     * Time is read from clock at start, at each deadline check and at end of solve
+     */
+    void SetClock(Clock clock) {
+        clock_ = std::move(clock);
+    }
+
+    AnytimeSolverResult Solve() {
+        start_time_ = clock_();
+        startup_end_time_.reset();
+        const auto is_presolved = !IsDeadline();
+        if (is_presolved) {
+            market_.Presolve();
+        }
+        auto free_lines = market_.GetUndefinedEdges();
+        for (auto&& edge : free_lines) {
+            edge->SetAlgorithmType(AlgorithmType::L_minus);
+        }
+
+        LocalSearch local_search(market_, free_lines, random_);
+        local_search.SetStopCondition([this] {
+            auto is_deadline = IsDeadline();
+            // Local search checks deadline first after solve of incumbent
+            if (!startup_end_time_) {
+                startup_end_time_ = last_time_;
+            }
+            return is_deadline;
+        });
+        auto local_search_result = local_search.Solve(std::numeric_limits<int64_t>::max());
+
+        AnytimeSolverResult result;
+        result.welfare = local_search_result.welfare;
+        result.l_plus_lines_mask = local_search_result.l_plus_lines_mask;
+        result.is_converged = local_search_result.is_local_optimum;
+        result.flip_moves_count = local_search_result.flip_moves_count;
+        result.swap_moves_count = local_search_result.swap_moves_count;
+        result.restarts_count = local_search_result.restarts_count;
+        result.solved_subtasks_count = local_search_result.solved_subtasks_count;
+        result.is_presolved = is_presolved;
+        result.startup_time = std::chrono::duration_cast<std::chrono::milliseconds>(
+                startup_end_time_.value_or(start_time_) - start_time_);
+        result.elapsed_time = std::chrono::duration_cast<std::chrono::milliseconds>(
+                clock_() - start_time_);
+        return result;
+    }
+
+private:
+    bool IsDeadline() {
+        last_time_ = clock_();
+        return last_time_ - start_time_ >= budget_;
+    }
+
+    StarChainMarket& market_;
+    std::chrono::milliseconds budget_;
+    RandomStream& random_;
+    Clock clock_ = std::chrono::steady_clock::now;
+    std::chrono::steady_clock::time_point start_time_;
+    // Time read by last deadline check
+    std::chrono::steady_clock::time_point last_time_;
+    std::optional<std::chrono::steady_clock::time_point> startup_end_time_;
+};
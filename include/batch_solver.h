@@ -0,0 +1,60 @@
+#pragma once
+
+#include "json.h"
+#include "star_chain_market.h"
+#include <istream>
+#include <ostream>
+#include <thread>
+
+struct BatchSolverResult {
+    int64_t requests_count = 0;
+    int64_t errors_count = 0;
+};
+
+/*
+ * Batch mode: reads requests in JSON Lines, one request per line, and writes one JSON result line per
+ * request in order of requests. Request is object with members
+ *   "id": any value, copied to result;
+ *   "market": {"path": file in text or binary format} or {"text": market in text format} or
+ *     {"shared": name of shared memory object published by SharedMarket} or inline curves
+ *     {"nodes": [{"central": bool, "supply": [[x, y], ...], "demand": [[x, y], ...]}, ...],
+ *      "lines": [{"from": node, "to": node, "type": "STAR_TO_CENTER", "et", "Q", "ef", "Ev_coeff"}, ...]};
+ *   "operation": "solve_mask" with "mask" string of 0 and 1 for L_plus lines in market order,
+ *     "algorithm" or "brute_force";
+ *   "options": {"chain_first", "local_search", "impact_order"} for algorithm, {"presolve"} for brute force.
+ * Result has id, status "ok" with welfare and mask of L_plus lines or status "error" with error message.
+ * Reading, solving on worker threads and writing go concurrently, count of requests read and not yet written
+ * is bounded, so memory doesn't grow with count of requests.
+ */
+class BatchSolver {
+public:
+    explicit BatchSolver(size_t threads_count = std::thread::hardware_concurrency(),
+            size_t max_requests_in_flight = 0)
+            : threads_count_(std::max<size_t>(1, threads_count)),
+              max_requests_in_flight_(max_requests_in_flight ? max_requests_in_flight : 4 * threads_count_) {}
+
+    BatchSolverResult Run(std::istream& in, std::ostream& out);
+
+    /*
+     * Result line without line end for single request line
+     */
+    static std::string SolveRequest(std::string_view request_line, bool& is_error);
+
+    /*
+     * Market described by "market" member of request, tree is built
+     */
+    static StarChainMarket LoadRequestMarket(const JsonValue& market_request);
+
+    /*
+     * Runs "operation" of request on market with undefined line types, appends result members to result
+     */
+    static void SolveOperation(StarChainMarket& market, const JsonValue& request, std::string& result);
+
+private:
+    static constexpr size_t kMaxBruteForceLinesCount = 30;
+
+    static StarChainMarket BuildInlineMarket(const JsonValue& market_request);
+
+    size_t threads_count_;
+    size_t max_requests_in_flight_;
+};
@@ -0,0 +1,205 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+inline uint64_t LowBitsMask(size_t ones_bits_count) {
+    return ones_bits_count >= 64 ? ~uint64_t(0) : (uint64_t(1) << ones_bits_count) - 1;
+}
+
+/*
+ * Next mask with the same ones bits count in increasing order (Gosper's hack), mask must be non-zero
+ */
+inline uint64_t NextMaskWithSameOnesBitsCount(uint64_t mask) {
+    auto lowest_bit = mask & -mask;
+    auto ripple = mask + lowest_bit;
+    return (((ripple ^ mask) >> 2) / lowest_bit) | ripple;
+}
+
+/*
+ * Lazily enumerates masks of length up to 64 in order of increasing ones bits count,
+ * masks with the same ones bits count go in increasing order.
+ * for (BitMasksEnumerator masks(length, 2); !masks.IsEnd(); masks.Next()) { masks.GetMask(); }
+ */
+class BitMasksEnumerator {
+public:
+    BitMasksEnumerator(size_t length, size_t min_ones_bits_count = 0)
+            : BitMasksEnumerator(length, min_ones_bits_count, length) {}
+
+    BitMasksEnumerator(size_t length, size_t min_ones_bits_count, size_t max_ones_bits_count)
+            : length_(length), max_ones_bits_count_(std::min(max_ones_bits_count, length)),
+              ones_bits_count_(min_ones_bits_count), mask_(LowBitsMask(min_ones_bits_count)) {
+        if (length_ > 64) {
+            throw std::runtime_error("Length of mask overflow, use MultiwordBitMasksEnumerator");
+        }
+    }
+
+    bool IsEnd() const noexcept {
+        return ones_bits_count_ > max_ones_bits_count_;
+    }
+
+    void Next() {
+        if (ones_bits_count_ == 0 || mask_ == (LowBitsMask(ones_bits_count_) << (length_ - ones_bits_count_))) {
+            ones_bits_count_++;
+            mask_ = LowBitsMask(ones_bits_count_);
+        } else {
+            mask_ = NextMaskWithSameOnesBitsCount(mask_);
+        }
+    }
+
+    uint64_t GetMask() const noexcept {
+        return mask_;
+    }
+
+    bool IsBitSet(size_t pos) const noexcept {
+        return (mask_ >> pos) & 1;
+    }
+
+    size_t GetOnesBitsCount() const noexcept {
+        return ones_bits_count_;
+    }
+
+    size_t GetLength() const noexcept {
+        return length_;
+    }
+
+private:
+    size_t length_;
+    size_t max_ones_bits_count_;
+    size_t ones_bits_count_;
+    uint64_t mask_;
+};
+
+/*
+ * Same enumeration order as BitMasksEnumerator for masks of any length, mask stored in 64 bit words
+ */
+class MultiwordBitMasksEnumerator {
+public:
+    MultiwordBitMasksEnumerator(size_t length, size_t min_ones_bits_count = 0)
+            : MultiwordBitMasksEnumerator(length, min_ones_bits_count, length) {}
+
+    MultiwordBitMasksEnumerator(size_t length, size_t min_ones_bits_count, size_t max_ones_bits_count)
+            : length_(length), max_ones_bits_count_(std::min(max_ones_bits_count, length)),
+              ones_bits_count_(min_ones_bits_count), words_((length + 63) / 64, 0) {
+        SetLowBits(ones_bits_count_);
+    }
+
+    bool IsEnd() const noexcept {
+        return ones_bits_count_ > max_ones_bits_count_;
+    }
+
+    void Next() {
+        if (ones_bits_count_ == 0) {
+            ones_bits_count_++;
+            SetLowBits(ones_bits_count_);
+            return;
+        }
+        // Move highest bit of the lowest ones run one position up, the rest of the run goes to the bottom
+        auto run_start = FindBit(0, true);
+        auto run_end = FindBit(run_start, false);
+        if (run_end >= length_) {
+            ones_bits_count_++;
+            SetLowBits(ones_bits_count_);
+            return;
+        }
+        for (size_t word = 0; word < run_end / 64; word++) {
+            words_[word] = 0;
+        }
+        words_[run_end / 64] &= ~LowBitsMask(run_end % 64);
+        words_[run_end / 64] |= uint64_t(1) << (run_end % 64);
+        SetLowBits(run_end - run_start - 1, false);
+    }
+
+    const std::vector<uint64_t>& GetMask() const noexcept {
+        return words_;
+    }
+
+    bool IsBitSet(size_t pos) const noexcept {
+        return (words_[pos / 64] >> (pos % 64)) & 1;
+    }
+
+    size_t GetOnesBitsCount() const noexcept {
+        return ones_bits_count_;
+    }
+
+    size_t GetLength() const noexcept {
+        return length_;
+    }
+
+private:
+    void SetLowBits(size_t ones_bits_count, bool clear_others = true) {
+        for (size_t word = 0; word < words_.size(); word++) {
+            auto bits = ones_bits_count > word * 64 ? LowBitsMask(ones_bits_count - word * 64) : 0;
+            words_[word] = clear_others ? bits : words_[word] | bits;
+        }
+    }
+
+    // Position of first bit equal to value starting from pos, length if there is no such bit
+    size_t FindBit(size_t pos, bool value) const noexcept {
+        for (auto word = pos / 64; word < words_.size(); word++) {
+            auto bits = value ? words_[word] : ~words_[word];
+            if (word == pos / 64) {
+                bits &= ~LowBitsMask(pos % 64);
+            }
+            if (bits) {
+                return std::min(length_, word * 64 + __builtin_ctzll(bits));
+            }
+        }
+        return length_;
+    }
+
+    size_t length_;
+    size_t max_ones_bits_count_;
+    size_t ones_bits_count_;
+    std::vector<uint64_t> words_;
+};
+
+/*
+ * Enumerates vectors of counts, count at position i is from 0 to radix i, in reflected Gray code order:
+ * each step changes exactly one count by one.
+ * for (CountsGrayCodeEnumerator counts(radices); !counts.IsEnd(); counts.Next()) { counts.GetCounts(); }
+ */
+class CountsGrayCodeEnumerator {
+public:
+    explicit CountsGrayCodeEnumerator(std::vector<size_t> radices)
+            : radices_(std::move(radices)), counts_(radices_.size(), 0), directions_(radices_.size(), 1) {}
+
+    bool IsEnd() const noexcept {
+        return is_end_;
+    }
+
+    void Next() {
+        for (size_t pos = 0; pos < radices_.size(); pos++) {
+            auto count = static_cast<int64_t>(counts_[pos]) + directions_[pos];
+            if (count >= 0 && count <= static_cast<int64_t>(radices_[pos])) {
+                counts_[pos] = count;
+                changed_pos_ = pos;
+                return;
+            }
+            directions_[pos] = -directions_[pos];
+        }
+        is_end_ = true;
+    }
+
+    const std::vector<size_t>& GetCounts() const noexcept {
+        return counts_;
+    }
+
+    // Position of count changed by last step
+    size_t GetChangedPos() const noexcept {
+        return changed_pos_;
+    }
+
+    // Plus or minus one, change of count by last step
+    int64_t GetChangeDirection() const noexcept {
+        return directions_[changed_pos_];
+    }
+
+private:
+    std::vector<size_t> radices_;
+    std::vector<size_t> counts_;
+    std::vector<int64_t> directions_;
+    size_t changed_pos_ = 0;
+    bool is_end_ = false;
+};
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "star_chain_market.h"
+#include <functional>
+#include <limits>
+
+struct BranchAndBoundResult {
+    long double welfare = 0;
+    std::vector<bool> l_plus_lines_mask;
+    int64_t explored_nodes_count = 0;
+    int64_t pruned_nodes_count = 0;
+    int64_t solved_subtasks_count = 0;
+};
+
+/*
+ * Lines are fixed one by one in order of decreasing fixed costs. Undecided lines are kept expanded,
+ * so welfare of current auxiliary subtask is a feasible solution, and the same welfare with fixed
+ * costs of undecided lines dropped is an upper bound for every completion of current decisions:
+ * expanded line allows any flow that not expanded line allows with the same costs.
+ */
+class BranchAndBound {
+public:
+    explicit BranchAndBound(StarChainMarket& market) : BranchAndBound(market, market.GetEdges()) {}
+
+    /*
+     * Only free lines are branched, other lines keep their types
+     */
+    BranchAndBound(StarChainMarket& market, std::vector<std::shared_ptr<Edge>> free_lines)
+            : market_(market), edges_(std::move(free_lines)) {
+        std::sort(edges_.begin(), edges_.end(), [](auto&& lhs, auto&& rhs) {
+            return lhs->Getef() > rhs->Getef();
+        });
+        undecided_fixed_costs_.assign(edges_.size() + 1, 0);
+        for (size_t i = edges_.size(); i > 0; i--) {
+            undecided_fixed_costs_[i - 1] = undecided_fixed_costs_[i] + edges_[i - 1]->Getef();
+        }
+    }
+
+    /*
+     * Welfare known from elsewhere, e.g. from concurrent heuristics, branches which can't beat it are pruned
+     */
+    void SetExternalLowerBound(std::function<long double()> lower_bound) {
+        external_lower_bound_ = std::move(lower_bound);
+    }
+
+    /*
+     * Finds welfare optimal set of L_plus lines, market is left solved with this set
+     */
+    BranchAndBoundResult Solve() {
+        result_ = BranchAndBoundResult();
+        result_.welfare = -std::numeric_limits<long double>::infinity();
+        for (auto&& edge : edges_) {
+            edge->SetAlgorithmType(AlgorithmType::L_plus);
+        }
+        market_.SolveAuxiliarySubtask();
+        result_.solved_subtasks_count++;
+        auto welfare = market_.CalculateWelfare();
+        Explore(0, welfare + undecided_fixed_costs_[0], welfare);
+
+        auto all_edges = market_.GetEdges();
+        for (size_t i = 0; i < all_edges.size(); i++) {
+            all_edges[i]->SetAlgorithmType(result_.l_plus_lines_mask[i] ? AlgorithmType::L_plus : AlgorithmType::L_minus);
+        }
+        market_.SolveAuxiliarySubtask();
+        result_.solved_subtasks_count++;
+        return result_;
+    }
+
+private:
+    /*
+     * Lines before pos are decided, others are expanded and market is solved with welfare
+     */
+    void Explore(size_t pos, long double upper_bound, long double welfare) {
+        result_.explored_nodes_count++;
+        if (welfare > result_.welfare) {
+            result_.welfare = welfare;
+            result_.l_plus_lines_mask = market_.GetLplushLinesMask();
+        }
+        if (pos == edges_.size()) {
+            return;
+        }
+        auto lower_bound = external_lower_bound_ ? std::max(result_.welfare, external_lower_bound_()) : result_.welfare;
+        if (upper_bound <= lower_bound + kEPS) {
+            result_.pruned_nodes_count++;
+            return;
+        }
+
+        // Line stays expanded, market does not change, only its fixed cost leaves the bound
+        Explore(pos + 1, upper_bound - edges_[pos]->Getef(), welfare);
+
+        edges_[pos]->SetAlgorithmType(AlgorithmType::L_minus);
+        market_.SolveAuxiliarySubtaskAlongPath(edges_[pos]);
+        result_.solved_subtasks_count++;
+        auto welfare_without_line = market_.CalculateWelfare();
+        Explore(pos + 1, welfare_without_line + undecided_fixed_costs_[pos + 1], welfare_without_line);
+
+        edges_[pos]->SetAlgorithmType(AlgorithmType::L_plus);
+        market_.SolveAuxiliarySubtaskAlongPath(edges_[pos]);
+        result_.solved_subtasks_count++;
+    }
+
+    StarChainMarket& market_;
+    // Lines in branching order
+    std::vector<std::shared_ptr<Edge>> edges_;
+    // Sum of fixed costs of lines starting from position in branching order
+    std::vector<long double> undecided_fixed_costs_;
+    std::function<long double()> external_lower_bound_;
+    BranchAndBoundResult result_;
+};
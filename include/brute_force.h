@@ -0,0 +1,67 @@
+#pragma once
+
+#include "star_chain_market.h"
+#include "bit_masks_enumerator.h"
+#include <limits>
+
+struct BruteForceResult {
+    long double welfare = 0;
+    std::vector<bool> l_plus_lines_mask;
+    // Min welfare over enumerated configurations
+    long double min_welfare = 0;
+    int64_t configurations_count = 0;
+    int64_t rebalanced_nodes_count = 0;
+};
+
+/*
+ * Exhaustive search over types of free lines, other lines keep their types. Interchangeable lines give the same
+ * welfare for the same count of L_plus lines among them, so for each class of interchangeable lines only count
+ * of L_plus lines is enumerated. Counts go in Gray code order, so one line changes between consecutive
+ * configurations and only its path to the tree root is rebalanced. Periodically result is checked by full solve.
+ */
+inline BruteForceResult BruteForce(StarChainMarket& market, const std::vector<std::shared_ptr<Edge>>& free_lines) {
+    const auto line_classes = market.FindInterchangeableLines(free_lines);
+    std::vector<size_t> radices;
+    long double configurations_count = 1;
+    for (auto&& line_class : line_classes) {
+        radices.push_back(line_class.size());
+        configurations_count *= line_class.size() + 1;
+    }
+    if (configurations_count >= std::numeric_limits<int64_t>::max()) {
+        throw std::runtime_error("Too many lines for brute force");
+    }
+
+    BruteForceResult result;
+    result.welfare = std::numeric_limits<long double>::lowest();
+    result.min_welfare = std::numeric_limits<long double>::max();
+    const int64_t full_solve_check_period = 64;
+    for (auto&& edge : free_lines) {
+        edge->SetAlgorithmType(AlgorithmType::L_minus);
+    }
+    market.SolveAuxiliarySubtask();
+    for (CountsGrayCodeEnumerator counts(radices); !counts.IsEnd(); counts.Next()) {
+        if (result.configurations_count > 0) {
+            const auto& line_class = line_classes[counts.GetChangedPos()];
+            const auto count = counts.GetCounts()[counts.GetChangedPos()];
+            // First count lines of class are L_plus
+            auto changed_line = counts.GetChangeDirection() > 0 ? line_class[count - 1] : line_class[count];
+            changed_line->SetAlgorithmType(counts.GetChangeDirection() > 0 ? AlgorithmType::L_plus :
+                    AlgorithmType::L_minus);
+            result.rebalanced_nodes_count += market.SolveAuxiliarySubtaskAlongPath(changed_line);
+        }
+        result.configurations_count++;
+        const auto welfare = market.CalculateWelfare();
+        if (result.configurations_count % full_solve_check_period == 0) {
+            market.SolveAuxiliarySubtask();
+            if (fabs(market.CalculateWelfare() - welfare) > kEPS) {
+                throw std::runtime_error("Welfare after path update differs from full solve");
+            }
+        }
+        result.min_welfare = std::min(result.min_welfare, welfare);
+        if (welfare > result.welfare) {
+            result.welfare = welfare;
+            result.l_plus_lines_mask = market.GetLplushLinesMask();
+        }
+    }
+    return result;
+}
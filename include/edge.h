@@ -50,7 +50,7 @@ const std::map<EdgeType, std::set<EdgeType>> ConcurentTypes = {
 
 class Edge {
 public:
-    Edge(double et, double Q, double ef, double Ev_coeff, std::shared_ptr<Node> from,
+    Edge(long double et, long double Q, long double ef, long double Ev_coeff, std::shared_ptr<Node> from,
             std::shared_ptr<Node> to, EdgeType type);
 
     bool operator==(const Edge& other) const;
@@ -61,6 +61,8 @@ public:
     PiecewiseLinearFunction GetDeltaSij() const;
     long double GetEValueAtPoint(long double x);
     bool IsExpand();
+    // Replaces costs and capacity, balance of market must be found again
+    void SetParameters(long double et, long double Q, long double ef, long double Ev_coeff);
     void SetLineExpand();
     void SetLineNotExpand();
     long double Getqij() const;
@@ -70,7 +72,7 @@ public:
         parent_qij_node_ = parent_node;
     }
 
-    long double GetEvCoeff() {
+    long double GetEvCoeff() const {
         return Ev_coeff_;
     }
 
@@ -80,7 +82,7 @@ public:
         return ef_;
     }
     long double GetQ() const;
-    EdgeType GetEdgeType() {
+    EdgeType GetEdgeType() const {
         return type_;
     }
     AlgorithmType GetAlgorithmType() {
@@ -100,7 +102,7 @@ public:
     }
 
     static std::shared_ptr<Edge> GenerateRandomEdge(std::shared_ptr<Node> from, std::shared_ptr<Node> to,
-            EdgeType type);
+            EdgeType type, RandomStream& random = GetThreadRandomStream());
 private:
     void CalcEFunction();
     void CalcevFunction();
@@ -126,7 +128,7 @@ private:
     // Is line expand
     bool is_expand_;
     // Full transportation costs
-    std::function<double(double)> E_;
+    std::function<long double(long double)> E_;
     // Поток через ребро
     long double qij_;
     // тип множества к которому принадлежит ребро, зависит от того находится оно в звезде или в цепочке и куда оно направлено
@@ -1,49 +1,34 @@
 #pragma once
 
 #include "algorithm.h"
-#include <unordered_map>
+#include "branch_and_bound.h"
+#include "brute_force.h"
 
+/*
+ * Compares algorithm with optimum found by brute force on market generated from seed
+ */
 inline auto Experiment(
         int64_t import_from_center_nodes_count,
         int64_t export_to_center_node_nodes_count,
-        int64_t chain_nodes_count) {
+        int64_t chain_nodes_count,
+        uint64_t seed) {
     auto market = StarChainMarket::GenerateRandomMarket(import_from_center_nodes_count,
-            export_to_center_node_nodes_count, chain_nodes_count).value();
+            export_to_center_node_nodes_count, chain_nodes_count, seed).value();
     market.BuildTreeMinDepth();
 
-    auto edges = market.GetEdges();
-    auto bit_masks_map = GenerateBitMasks(edges.size());
-    std::unordered_map<int64_t, float> mask_to_welrafe;
-    float best_brute_force_welrafe = -1e5;
-    int64_t best_mask = 0;
-    for (auto&& [bits_count, masks] : bit_masks_map) {
-        for (auto&& mask : masks) {
-            market.ClearMarketEdgesAlgorithmType();
-            for (size_t i = 0; i < edges.size(); i++) {
-                if ((mask >> i) & 1) {
-                    edges[i]->SetAlgorithmType(AlgorithmType::L_plus);
-                } else {
-                    edges[i]->SetAlgorithmType(AlgorithmType::L_minus);
-                }
-            }
-            market.SolveAuxiliarySubtask();
-            const auto welrafe = market.CalculateWelfare();
-            if (welrafe < 0 ) {
-                market.PrintAll();
-                exit(1);
-            }
-            mask_to_welrafe[mask] = welrafe;
-            //std::cout << "Mask: \n";
-            //PrintVector(MaskToVector(mask, market.GetEdges().size()));
-            //std::cout << std::endl;
-            //PrintVector(market.GetLplushLinesMask());
-            //std::cout << "Welrafe: " << mask_to_welrafe[mask] << std::endl;
-            if (welrafe > best_brute_force_welrafe) {
-                best_mask = mask;
-                best_brute_force_welrafe = welrafe;
-            }
-        }
+    // Brute force goes only over lines which are not decided by presolve
+    auto presolve_result = market.Presolve();
+    std::cout << "Presolve fixed lines: " << presolve_result.GetFixedLinesCount() << " of "
+              << market.GetEdges().size() << std::endl;
+    auto result = BruteForce(market, market.GetUndefinedEdges());
+    if (result.min_welfare < 0) {
+        market.PrintAll();
+        exit(1);
     }
+    float best_brute_force_welrafe = result.welfare;
+    std::cout << "Brute force configurations: " << result.configurations_count << " rebalanced nodes: "
+              << result.rebalanced_nodes_count << " full solves: "
+              << (result.configurations_count - 1) * market.GetNodes().size() << std::endl;
     market.ClearMarketEdgesAlgorithmType();
     Algorithm(market);
     market.SolveAuxiliarySubtask();
@@ -52,7 +37,31 @@ inline auto Experiment(
     PrintVector(market.GetLplushLinesMask());
     std::cout << std::endl;
     std::cout << "brute force best mask: ";
-    PrintVector(MaskToVector(best_mask, market.GetEdges().size()));
+    PrintVector(result.l_plus_lines_mask);
     std::cout << std::endl;
     return std::make_pair(best_brute_force_welrafe, algorithm_welrafe);
 }
+
+/*
+ * Same comparison for markets too large for brute force, optimum is found by branch and bound
+ */
+inline auto ExperimentBranchAndBound(
+        int64_t import_from_center_nodes_count,
+        int64_t export_to_center_node_nodes_count,
+        int64_t chain_nodes_count,
+        uint64_t seed) {
+    auto market = StarChainMarket::GenerateRandomMarket(import_from_center_nodes_count,
+            export_to_center_node_nodes_count, chain_nodes_count, seed).value();
+    market.BuildTreeMinDepth();
+
+    market.Presolve();
+    auto result = BranchAndBound(market, market.GetUndefinedEdges()).Solve();
+    std::cout << "Branch and bound explored nodes: " << result.explored_nodes_count << " pruned: "
+              << result.pruned_nodes_count << " solved subtasks: " << result.solved_subtasks_count << std::endl;
+
+    market.ClearMarketEdgesAlgorithmType();
+    Algorithm(market);
+    market.SolveAuxiliarySubtask();
+    float algorithm_welrafe = market.CalculateWelfare();
+    return std::make_pair(static_cast<float>(result.welfare), algorithm_welrafe);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+/*
+ * Minimal JSON value for request and result lines of batch mode, object keeps order of its members
+ */
+class JsonValue {
+public:
+    using Array = std::vector<JsonValue>;
+    using Object = std::vector<std::pair<std::string, JsonValue>>;
+
+    JsonValue() = default;
+    JsonValue(bool value) : value_(value) {}
+    JsonValue(long double value) : value_(value) {}
+    JsonValue(std::string value) : value_(std::move(value)) {}
+    JsonValue(const char* value) : value_(std::string(value)) {}
+    JsonValue(Array value) : value_(std::move(value)) {}
+    JsonValue(Object value) : value_(std::move(value)) {}
+
+    /*
+     * Parses single JSON value, throws with column of error
+     */
+    static JsonValue Parse(std::string_view text);
+
+    bool IsNull() const {
+        return std::holds_alternative<std::nullptr_t>(value_);
+    }
+
+    bool IsString() const {
+        return std::holds_alternative<std::string>(value_);
+    }
+
+    bool IsArray() const {
+        return std::holds_alternative<Array>(value_);
+    }
+
+    bool IsObject() const {
+        return std::holds_alternative<Object>(value_);
+    }
+
+    // Getters throw if value has another type
+    bool GetBool() const;
+    long double GetNumber() const;
+    int64_t GetInteger() const;
+    const std::string& GetString() const;
+    const Array& GetArray() const;
+    const Object& GetObject() const;
+
+    // Member of object, nullptr if there is no such member
+    const JsonValue* Find(std::string_view key) const;
+    // Member of object, throws if there is no such member
+    const JsonValue& At(std::string_view key) const;
+
+    std::string ToString() const;
+
+private:
+    void Write(std::string& text) const;
+
+    std::variant<std::nullptr_t, bool, long double, std::string, Array, Object> value_ = nullptr;
+};
+
+// Appends JSON string literal with escaped text
+void WriteJsonString(std::string& text, std::string_view value);
+// Appends number in shortest form which is parsed back to the same value, null if number is not finite
+void WriteJsonNumber(std::string& text, long double value);
@@ -34,9 +34,9 @@ public:
         return a_coeff_ == 0;
     }
 
-    static LinearFunction GenerateNonIncreasingLinearFunction();
+    static LinearFunction GenerateNonIncreasingLinearFunction(RandomStream& random = GetThreadRandomStream());
 
-    static LinearFunction GenerateNonDecreasingLinearFunction();
+    static LinearFunction GenerateNonDecreasingLinearFunction(RandomStream& random = GetThreadRandomStream());
 
     long double GetACoeff() const noexcept;
 
@@ -36,9 +36,11 @@ public:
 
     void ShiftXAxis(long double x);
 
-    static LinearFunctionDefineOnSegment GenerateNonIncreasingLinearFunction(long double x_start, long double x_end);
+    static LinearFunctionDefineOnSegment GenerateNonIncreasingLinearFunction(long double x_start, long double x_end,
+            RandomStream& random = GetThreadRandomStream());
 
-    static LinearFunctionDefineOnSegment GenerateNonDecreasingLinearFunction(long double x_start, long double x_end);
+    static LinearFunctionDefineOnSegment GenerateNonDecreasingLinearFunction(long double x_start, long double x_end,
+            RandomStream& random = GetThreadRandomStream());
 
     LinearFunction GetLinearFunction() const {
         if (is_vertical_) {
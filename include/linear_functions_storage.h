@@ -0,0 +1,73 @@
+#pragma once
+#include "linear_function_define_on_segment.h"
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+static_assert(std::is_trivially_copyable_v<LinearFunctionDefineOnSegment>,
+        "Linear functions are borrowed from read only memory as is");
+
+/*
+ * Linear functions of piecewise linear function. Functions are owned, or borrowed from read only memory, e.g.
+ * mapped shared market, which stays mapped while owner is alive. Copy of borrowed functions shares memory,
+ * borrowed functions are copied on first change only.
+ */
+class LinearFunctionsStorage {
+public:
+    LinearFunctionsStorage() = default;
+
+    LinearFunctionsStorage(std::vector<LinearFunctionDefineOnSegment> functions) : functions_(std::move(functions)) {}
+
+    LinearFunctionsStorage(std::shared_ptr<const void> owner, const LinearFunctionDefineOnSegment* functions,
+            size_t size) : owner_(std::move(owner)), borrowed_(functions), borrowed_size_(size) {}
+
+    bool IsBorrowed() const noexcept {
+        return borrowed_ != nullptr;
+    }
+
+    const LinearFunctionDefineOnSegment* begin() const noexcept {
+        return borrowed_ ? borrowed_ : functions_.data();
+    }
+
+    const LinearFunctionDefineOnSegment* end() const noexcept {
+        return begin() + size();
+    }
+
+    size_t size() const noexcept {
+        return borrowed_ ? borrowed_size_ : functions_.size();
+    }
+
+    bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    const LinearFunctionDefineOnSegment& operator[](size_t pos) const noexcept {
+        return begin()[pos];
+    }
+
+    const LinearFunctionDefineOnSegment& back() const noexcept {
+        return end()[-1];
+    }
+
+    std::vector<LinearFunctionDefineOnSegment> ToVector() const {
+        return {begin(), end()};
+    }
+
+    // Functions to change, borrowed functions are copied before
+    std::vector<LinearFunctionDefineOnSegment>& GetMutable() {
+        if (borrowed_) {
+            functions_.assign(begin(), end());
+            owner_.reset();
+            borrowed_ = nullptr;
+            borrowed_size_ = 0;
+        }
+        return functions_;
+    }
+
+private:
+    std::vector<LinearFunctionDefineOnSegment> functions_;
+    // Keeps borrowed memory alive
+    std::shared_ptr<const void> owner_;
+    const LinearFunctionDefineOnSegment* borrowed_ = nullptr;
+    size_t borrowed_size_ = 0;
+};
@@ -0,0 +1,162 @@
+#pragma once
+
+#include "star_chain_market.h"
+#include <array>
+#include <numeric>
+#include <unordered_map>
+
+enum class LinesOrderPolicy {
+    // Lines are tested in lines order
+    FIXED,
+    // Before each pass market is solved with current types and lines are ranked by impact, lines order breaks ties
+    IMPACT,
+};
+
+/*
+ * Schedules welfare comparisons of undefined lines in Algorithm. Each line has a pending test for
+ * moving to L_plus and a pending test for moving to L_minus, test is done once and is queued again only
+ * when some line gets a type after it. Line which gets a type changes flows on its path to the root and so
+ * the root price, and comparison of every line reads the root price, so a decision queues all tests again.
+ * Tests done since the last decision are not repeated, they would give the same result.
+ */
+class LinesWorklist {
+public:
+    explicit LinesWorklist(StarChainMarket& market) : market_(market), edges_(market.GetEdges()) {
+        for (size_t i = 0; i < edges_.size(); i++) {
+            edge_positions_[edges_[i].get()] = i;
+        }
+        // Tests are done before the first decision
+        tested_at_decision_.assign(edges_.size(), {-1, -1});
+        lines_order_.resize(edges_.size());
+        std::iota(lines_order_.begin(), lines_order_.end(), 0);
+    }
+
+    /*
+     * Order in which pending lines are tested, positions of lines in market edges
+     */
+    void SetLinesOrder(std::vector<size_t> lines_order) {
+        if (lines_order.size() != edges_.size()) {
+            throw std::runtime_error("Lines order must contain all lines");
+        }
+        lines_order_ = std::move(lines_order);
+    }
+
+    void SetLinesOrderPolicy(LinesOrderPolicy policy) {
+        policy_ = policy;
+    }
+
+    /*
+     * Sorts lines to be tested for moving to result type by policy, market must be solved. Lines with larger
+     * impact go first for moving to L_plus and last for moving to L_minus
+     */
+    void RankLines(std::vector<std::shared_ptr<Edge>>& lines, AlgorithmType result_line_type) const {
+        if (policy_ == LinesOrderPolicy::FIXED) {
+            return;
+        }
+        std::vector<std::pair<long double, std::shared_ptr<Edge>>> scored_lines;
+        for (auto&& edge : lines) {
+            auto impact = market_.EstimateLineImpact(edge);
+            scored_lines.emplace_back(result_line_type == AlgorithmType::L_plus ? -impact : impact, edge);
+        }
+        std::stable_sort(scored_lines.begin(), scored_lines.end(), [](auto&& lhs, auto&& rhs) {
+            return lhs.first < rhs.first;
+        });
+        for (size_t i = 0; i < lines.size(); i++) {
+            lines[i] = scored_lines[i].second;
+        }
+    }
+
+    /*
+     * Tests pending undefined lines of line type for moving to result type, returns count of changed lines
+     */
+    template<typename CompareWelrafe>
+    int64_t Process(EdgeType line_type, const std::map<EdgeType, std::set<EdgeType>>& other_types,
+            AlgorithmType result_line_type, CompareWelrafe comp, int& tasks_solved) {
+        const auto test = TestIndex(result_line_type);
+        const auto& line_other_types = other_types.at(line_type);
+        std::vector<std::shared_ptr<Edge>> candidate_lines;
+        for (auto i : lines_order_) {
+            if (tested_at_decision_[i][test] == decisions_count_ || edges_[i]->GetEdgeType() != line_type
+                    || edges_[i]->GetAlgorithmType() != AlgorithmType::L_undefined) {
+                continue;
+            }
+            candidate_lines.push_back(edges_[i]);
+        }
+        tests_count_ += candidate_lines.size();
+        if (!candidate_lines.empty()) {
+            passes_count_++;
+        }
+        if (policy_ == LinesOrderPolicy::IMPACT && candidate_lines.size() > 1) {
+            // Expansions and prices are left by the last comparison, impact is estimated for current types
+            market_.SolveAuxiliarySubtask();
+            tasks_solved++;
+            RankLines(candidate_lines, result_line_type);
+        }
+
+        // Candidates share auxiliary subtask if they don't expand each other before and after decision
+        if (!line_other_types.count(line_type) && result_line_type != AlgorithmType::L_plus) {
+            for (auto&& edge : candidate_lines) {
+                tested_at_decision_[GetPos(edge)][test] = decisions_count_;
+            }
+            auto changed_lines = market_.CompareWelrafeAndChangeLinesScreened(candidate_lines, line_other_types,
+                    result_line_type, comp, tasks_solved);
+            for (auto&& edge : changed_lines) {
+                LineDecided(edge);
+            }
+            return changed_lines.size();
+        }
+        int64_t changed_lines_count = 0;
+        for (auto&& edge : candidate_lines) {
+            tested_at_decision_[GetPos(edge)][test] = decisions_count_;
+            if (market_.CompareWelrafeAndChangeLine(edge, other_types, result_line_type, comp, tasks_solved)) {
+                LineDecided(edge);
+                changed_lines_count++;
+            }
+        }
+        return changed_lines_count;
+    }
+
+    /*
+     * Queues again tests of all lines after line got a type
+     */
+    void LineDecided(const std::shared_ptr<Edge>& edge) {
+        if (!edge_positions_.count(edge.get())) {
+            throw std::runtime_error("Line is not in the market");
+        }
+        decisions_count_++;
+    }
+
+    bool IsPending(const std::shared_ptr<Edge>& edge, AlgorithmType result_line_type) const {
+        return tested_at_decision_[GetPos(edge)][TestIndex(result_line_type)] != decisions_count_;
+    }
+
+    int64_t GetTestsCount() const {
+        return tests_count_;
+    }
+
+    // Count of Process calls which tested at least one line
+    int64_t GetPassesCount() const {
+        return passes_count_;
+    }
+
+private:
+    static size_t TestIndex(AlgorithmType result_line_type) {
+        return result_line_type == AlgorithmType::L_plus ? 0 : 1;
+    }
+
+    size_t GetPos(const std::shared_ptr<Edge>& edge) const {
+        return edge_positions_.at(edge.get());
+    }
+
+    StarChainMarket& market_;
+    std::vector<std::shared_ptr<Edge>> edges_;
+    std::unordered_map<const Edge*, size_t> edge_positions_;
+    // Count of decisions made before tests for moving to L_plus and to L_minus, test is pending if
+    // a decision was made after it
+    std::vector<std::array<int64_t, 2>> tested_at_decision_;
+    int64_t decisions_count_ = 0;
+    std::vector<size_t> lines_order_;
+    LinesOrderPolicy policy_ = LinesOrderPolicy::FIXED;
+    int64_t tests_count_ = 0;
+    int64_t passes_count_ = 0;
+};
@@ -0,0 +1,184 @@
+#pragma once
+
+#include "random_stream.h"
+#include "star_chain_market.h"
+#include <functional>
+#include <limits>
+#include <optional>
+
+struct LocalSearchResult {
+    long double welfare = 0;
+    std::vector<bool> l_plus_lines_mask;
+    // First descent reached local optimum before stop
+    bool is_local_optimum = false;
+    int64_t flip_moves_count = 0;
+    int64_t swap_moves_count = 0;
+    int64_t restarts_count = 0;
+    int64_t solved_subtasks_count = 0;
+};
+
+/*
+ * Improves types of free lines by moves from 1-flip neighborhood, type of one line changes, and 2-swap
+ * neighborhood, one L_plus line becomes L_minus and one L_minus line becomes L_plus. Welfare of all flips
+ * from current types is found by one rerooting pass, chosen move is applied by path re-solve and kept only
+ * if welfare improves. Restarts perturb best found types by random flips drawn from random stream and
+ * descend again.
+ */
+class LocalSearch {
+public:
+    LocalSearch(StarChainMarket& market, std::vector<std::shared_ptr<Edge>> free_lines,
+            RandomStream& random = GetThreadRandomStream())
+            : market_(market), free_lines_(std::move(free_lines)), random_(random) {}
+
+    /*
+     * Search is stopped between moves when condition holds
+     */
+    void SetStopCondition(std::function<bool()> should_stop) {
+        should_stop_ = std::move(should_stop);
+    }
+
+    /*
+     * Free lines must be L_plus or L_minus. Market is left solved with best found types
+     */
+    LocalSearchResult Solve(int64_t restarts_count = 0) {
+        result_ = LocalSearchResult();
+        market_.SolveAuxiliarySubtask();
+        result_.solved_subtasks_count++;
+        welfare_ = market_.CalculateWelfare();
+        result_.is_local_optimum = Descend();
+        result_.welfare = welfare_;
+        result_.l_plus_lines_mask = market_.GetLplushLinesMask();
+
+        for (int64_t restart = 0; restart < restarts_count && !free_lines_.empty() && !ShouldStop(); restart++) {
+            result_.restarts_count++;
+            if (market_.GetLplushLinesMask() != result_.l_plus_lines_mask) {
+                RestoreBest();
+            }
+            const auto perturbed_lines_count = std::max<size_t>(1, free_lines_.size() / 4);
+            for (size_t i = 0; i < perturbed_lines_count; i++) {
+                Flip(free_lines_[GenerateRandomValue<size_t>(0, free_lines_.size() - 1, random_)]);
+            }
+            welfare_ = market_.CalculateWelfare();
+            Descend();
+            if (welfare_ > result_.welfare + kEPS) {
+                result_.welfare = welfare_;
+                result_.l_plus_lines_mask = market_.GetLplushLinesMask();
+            }
+        }
+
+        RestoreBest();
+        return result_;
+    }
+
+    /*
+     * Applies improving moves until local optimum or stop, returns whether local optimum is reached
+     */
+    bool Descend() {
+        while (!ShouldStop()) {
+            if (MakeFlipMove()) {
+                result_.flip_moves_count++;
+            } else if (MakeSwapMove()) {
+                result_.swap_moves_count++;
+            } else {
+                return !ShouldStop();
+            }
+        }
+        return false;
+    }
+
+    const LocalSearchResult& GetResult() const {
+        return result_;
+    }
+
+private:
+    bool ShouldStop() const {
+        return should_stop_ && should_stop_();
+    }
+
+    // Sets best found types and solves market with them
+    void RestoreBest() {
+        auto edges = market_.GetEdges();
+        for (size_t i = 0; i < edges.size(); i++) {
+            edges[i]->SetAlgorithmType(result_.l_plus_lines_mask[i] ? AlgorithmType::L_plus : AlgorithmType::L_minus);
+        }
+        market_.SolveAuxiliarySubtask();
+        result_.solved_subtasks_count++;
+        welfare_ = market_.CalculateWelfare();
+    }
+
+    void Flip(std::shared_ptr<Edge> edge) {
+        edge->SetAlgorithmType(edge->GetAlgorithmType() == AlgorithmType::L_plus ? AlgorithmType::L_minus :
+                AlgorithmType::L_plus);
+        market_.SolveAuxiliarySubtaskAlongPath(edge);
+        result_.solved_subtasks_count++;
+    }
+
+    /*
+     * Free lines of given type ordered by decreasing welfare after their flip
+     */
+    std::vector<std::pair<long double, std::shared_ptr<Edge>>> RankFlips(std::optional<AlgorithmType> type) {
+        auto flipped_welfare = market_.CalculateWelfareWithEachLineFlipped();
+        auto edges = market_.GetEdges();
+        std::vector<std::pair<long double, std::shared_ptr<Edge>>> flips;
+        for (auto&& edge : free_lines_) {
+            if (!type || edge->GetAlgorithmType() == *type) {
+                auto pos = std::find(edges.begin(), edges.end(), edge) - edges.begin();
+                flips.emplace_back(flipped_welfare[pos], edge);
+            }
+        }
+        std::sort(flips.begin(), flips.end(), [](auto&& lhs, auto&& rhs) {
+            return lhs.first > rhs.first;
+        });
+        return flips;
+    }
+
+    // Tries flips in rank order, keeps first one which improves welfare
+    bool ApplyBestFlip(const std::vector<std::pair<long double, std::shared_ptr<Edge>>>& flips) {
+        for (auto&& [welfare, edge] : flips) {
+            if (welfare <= welfare_ + kEPS || ShouldStop()) {
+                return false;
+            }
+            Flip(edge);
+            auto new_welfare = market_.CalculateWelfare();
+            if (new_welfare > welfare_ + kEPS) {
+                welfare_ = new_welfare;
+                return true;
+            }
+            Flip(edge);
+        }
+        return false;
+    }
+
+    bool MakeFlipMove() {
+        return ApplyBestFlip(RankFlips(std::nullopt));
+    }
+
+    bool MakeSwapMove() {
+        std::vector<std::shared_ptr<Edge>> l_plus_lines;
+        for (auto&& edge : free_lines_) {
+            if (edge->GetAlgorithmType() == AlgorithmType::L_plus) {
+                l_plus_lines.push_back(edge);
+            }
+        }
+        for (auto&& edge : l_plus_lines) {
+            if (ShouldStop()) {
+                return false;
+            }
+            // Line is L_minus now, partner is found among other L_minus lines
+            Flip(edge);
+            if (ApplyBestFlip(RankFlips(AlgorithmType::L_minus))) {
+                return true;
+            }
+            Flip(edge);
+        }
+        return false;
+    }
+
+    StarChainMarket& market_;
+    std::vector<std::shared_ptr<Edge>> free_lines_;
+    std::function<bool()> should_stop_;
+    RandomStream& random_;
+    // Welfare of current types, market is solved with them between moves
+    long double welfare_ = 0;
+    LocalSearchResult result_;
+};
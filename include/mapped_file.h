@@ -0,0 +1,59 @@
+#pragma once
+
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * Read only file mapped to memory for sequential reading, empty file has empty data
+ */
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) : MappedFile(open(path.c_str(), O_RDONLY), "file " + path) {}
+
+    /*
+     * Maps whole object opened for reading, e.g. shared memory object, descriptor is closed
+     */
+    MappedFile(int fd, const std::string& description) {
+        if (fd < 0) {
+            throw std::runtime_error("Can't open " + description);
+        }
+        struct stat file_stat;
+        if (fstat(fd, &file_stat) < 0) {
+            close(fd);
+            throw std::runtime_error("Can't get size of " + description);
+        }
+        size_ = file_stat.st_size;
+        if (size_ > 0) {
+            data_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        close(fd);
+        if (data_ == MAP_FAILED) {
+            throw std::runtime_error("Can't map " + description);
+        }
+        if (size_ > 0) {
+            madvise(data_, size_, MADV_SEQUENTIAL);
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        if (size_ > 0) {
+            munmap(data_, size_);
+        }
+    }
+
+    std::string_view GetData() const noexcept {
+        return size_ > 0 ? std::string_view(static_cast<const char*>(data_), size_) : std::string_view();
+    }
+
+private:
+    void* data_ = nullptr;
+    size_t size_ = 0;
+};
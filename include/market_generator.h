@@ -0,0 +1,92 @@
+#pragma once
+
+#include "market_snapshot.h"
+#include <ostream>
+#include <thread>
+
+struct MarketGeneratorOptions {
+    // Leaves which import from central node
+    uint64_t import_star_nodes_count = 0;
+    // Leaves which export to central node
+    uint64_t export_star_nodes_count = 0;
+    // Chains starting at central node, each of chain length nodes
+    uint64_t chains_count = 0;
+    uint64_t chain_length = 0;
+    uint64_t seed = 0;
+    size_t threads_count = std::thread::hardware_concurrency();
+    // Nodes or lines generated by one thread at once
+    size_t block_size = 1 << 16;
+};
+
+/*
+ * Random star chain market of any size written straight to text or binary format. Node 0 is central node,
+ * then import star nodes, export star nodes and chains one after another. Line i goes between node i + 1 and
+ * its parent: central node for star nodes and first chain nodes, previous chain node otherwise. Parameters of
+ * node and of line to its parent are drawn from RandomStream of seed and node number, so any range of nodes
+ * is generated independently: blocks of nodes are formatted on several threads and written in order, memory
+ * is bounded by blocks in flight and file is the same for any threads count. Parameters are the same as in
+ * GenerateRandomMarket with the same seed and one chain, domains of all functions are extended to bound of
+ * demand zeroing prices known from options, so no second pass over nodes is needed.
+ */
+class MarketGenerator {
+public:
+    explicit MarketGenerator(MarketGeneratorOptions options);
+
+    uint64_t GetNodesCount() const {
+        return nodes_count_;
+    }
+
+    uint64_t GetLinesCount() const {
+        return nodes_count_ - 1;
+    }
+
+    // Format read by MarketParser
+    void WriteText(std::ostream& os) const;
+
+    // Format read by MarketSnapshot
+    void WriteBinary(std::ostream& os) const;
+
+    /*
+     * Same market built in memory, for small markets
+     */
+    StarChainMarket Generate() const;
+
+private:
+    struct NodeParameters {
+        long double c;
+        long double d;
+    };
+
+    struct LineParameters {
+        uint64_t from;
+        uint64_t to;
+        EdgeType type;
+        long double et;
+        long double Q;
+        long double ef;
+        long double Ev_coeff;
+    };
+
+    NodeParameters GetNodeParameters(uint64_t node) const;
+    // Parameters of line to parent of node, node is not central
+    LineParameters GetLineParameters(uint64_t node) const;
+    std::vector<Point> GetSupplyPoints(const NodeParameters& parameters) const;
+    std::vector<Point> GetDemandPoints(const NodeParameters& parameters) const;
+    uint64_t GetParent(uint64_t node) const;
+    uint64_t GetDegree(uint64_t node) const;
+
+    /*
+     * Calls format(begin, end, block) for blocks of range [0, count) on threads, blocks are written in order
+     */
+    template<typename Format>
+    void WriteBlocks(std::ostream& os, uint64_t count, Format&& format) const;
+
+    MarketGeneratorOptions options_;
+    uint64_t nodes_count_;
+    // First node of chains
+    uint64_t chains_start_;
+    // Zero price of central node
+    long double central_zero_price_;
+    // End of domain of every function, more than demand zeroing price of any node
+    long double domain_end_;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "star_chain_market.h"
+#include <string_view>
+
+/*
+ * Parser of text market format written by MarketWriter: counts of nodes and lines, then
+ * for each node its number and central node flag, supply and demand points "(x,y)" separated by spaces on
+ * one line each, then for each line numbers of its nodes and type, then et Q ef Ev_coeff. Numbers are read
+ * in place with std::from_chars, errors are reported with line and column of text.
+ */
+class MarketParser {
+public:
+    explicit MarketParser(std::string_view text) : text_(text) {}
+
+    StarChainMarket Parse();
+
+    /*
+     * Parses file mapped to memory
+     */
+    static StarChainMarket ParseFile(const std::string& path);
+
+private:
+    struct LineRecord {
+        int64_t from;
+        int64_t to;
+        EdgeType type;
+        long double et, Q, ef, Ev_coeff;
+    };
+
+    void SkipSpaces(bool skip_line_ends = true);
+    int64_t ReadInteger(const char* what);
+    int64_t ReadNodeNumber(int64_t nodes_count, const char* what);
+    long double ReadNumber(const char* what);
+    void ReadPoints(std::vector<Point>& points, const char* what);
+    EdgeType ReadEdgeType();
+    void Expect(char ch, const char* what);
+    [[noreturn]] void Error(const std::string& message) const;
+
+    std::string_view text_;
+    size_t pos_ = 0;
+    // Number of current text line from one and position where it starts
+    size_t line_number_ = 1;
+    size_t line_start_ = 0;
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "star_chain_market.h"
+#include <string_view>
+
+/*
+ * Versioned little endian binary market format. After header go sections aligned to 16 bytes:
+ * offsets of breakpoints of node functions (supply of node i is from offset 2i to 2i+1, demand from 2i+1
+ * to 2i+2), breakpoints as (x, y) pairs, lines in market order and lines of each node in CSR form
+ * (offsets of nodes, then line numbers). Numbers are stored as long double without conversion, so stored
+ * market is restored exactly on machines with the same long double format.
+ */
+class MarketSnapshot {
+public:
+    static constexpr uint32_t kVersion = 1;
+
+    static void Store(std::ostream& os, StarChainMarket& market);
+
+    // Data starts with snapshot magic
+    static bool IsSnapshot(std::string_view data) {
+        return data.size() >= sizeof(kMagic) && data.substr(0, sizeof(kMagic)) == std::string_view(kMagic, sizeof(kMagic));
+    }
+
+    /*
+     * Builds market from snapshot in memory, data must be aligned to 16 bytes. Nodes built before, if given,
+     * e.g. on functions of shared market, are taken instead of reading functions of nodes.
+     */
+    static StarChainMarket Load(std::string_view data, std::vector<std::shared_ptr<Node>> nodes = {});
+
+    /*
+     * Builds market from snapshot file mapped to memory
+     */
+    static StarChainMarket LoadFile(const std::string& path);
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t number_size;
+        uint32_t mantissa_digits;
+        uint32_t reserved;
+        uint64_t nodes_count;
+        uint64_t edges_count;
+        uint64_t points_count;
+        // Number of central node, nodes count if market has no central node
+        uint64_t central_node;
+        // Byte offsets of sections from file start
+        uint64_t point_offsets_offset;
+        uint64_t points_offset;
+        uint64_t edges_offset;
+        uint64_t adjacency_offsets_offset;
+        uint64_t adjacency_offset;
+        uint64_t file_size;
+    };
+
+    struct PointRecord {
+        long double x;
+        long double y;
+    };
+
+    struct EdgeRecord {
+        uint64_t from;
+        uint64_t to;
+        uint32_t type;
+        uint32_t reserved;
+        long double et;
+        long double Q;
+        long double ef;
+        long double Ev_coeff;
+    };
+
+    /*
+     * Header with section offsets for market of given size, central node is nodes count if there is no
+     * central node. Sections go in order of offsets, section starts not covered by data are zero padding.
+     */
+    static Header CreateHeader(uint64_t nodes_count, uint64_t edges_count, uint64_t points_count,
+            uint64_t central_node);
+
+private:
+    static constexpr char kMagic[8] = {'S', 'C', 'M', 'S', 'N', 'A', 'P', '\0'};
+    static constexpr uint64_t kAlignment = 16;
+
+    static uint64_t Align(uint64_t offset) {
+        return (offset + kAlignment - 1) / kAlignment * kAlignment;
+    }
+
+    template<typename T>
+    static const T* GetSection(std::string_view data, uint64_t offset, uint64_t count);
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "star_chain_market.h"
+#include <ostream>
+
+/*
+ * Writes market in text format read by MarketParser. Numbers are formatted with std::to_chars in shortest
+ * form which is read back to the same value, text is collected in buffer and written by large blocks.
+ */
+class MarketWriter {
+public:
+    explicit MarketWriter(std::ostream& os, size_t buffer_size = kDefaultBufferSize)
+            : os_(os), buffer_(std::max(buffer_size, kMaxTokenSize)) {}
+
+    MarketWriter(const MarketWriter&) = delete;
+    MarketWriter& operator=(const MarketWriter&) = delete;
+
+    ~MarketWriter() {
+        Flush();
+    }
+
+    void Write(const StarChainMarket& market);
+
+    /*
+     * Parts of market text in order header, nodes in order of numbers, lines, for markets written without
+     * building them in memory
+     */
+    void WriteHeader(uint64_t nodes_count, uint64_t edges_count);
+    void WriteNode(uint64_t node_number, bool is_central, const std::vector<Point>& supply_points,
+            const std::vector<Point>& demand_points);
+    void WriteLine(uint64_t from, uint64_t to, EdgeType type, long double et, long double Q, long double ef,
+            long double Ev_coeff);
+
+    void Flush();
+
+private:
+    static constexpr size_t kDefaultBufferSize = 1 << 20;
+    // Max length of number or line type
+    static constexpr size_t kMaxTokenSize = 64;
+
+    void WriteNumber(long double value);
+    void WriteInteger(int64_t value);
+    void WriteChar(char ch);
+    void WriteText(std::string_view text);
+    void WritePoints(const std::vector<Point>& points);
+    // Flushes buffer if token may not fit
+    void Reserve();
+
+    std::ostream& os_;
+    std::vector<char> buffer_;
+    size_t size_ = 0;
+};
@@ -2,8 +2,8 @@
 #include "piecewise_linear_function.h"
 #include "utils.h"
 #include <string>
-#include <random>
 #include <memory>
+#include <optional>
 
 class Node {
 public:
@@ -13,6 +13,8 @@ public:
     bool operator==(const Node& other) const;
 
     Node(PiecewiseLinearFunction D, PiecewiseLinearFunction S);
+    // Balance S - D is found before, e.g. taken from shared market
+    Node(PiecewiseLinearFunction D, PiecewiseLinearFunction S, PiecewiseLinearFunction delta_S);
 
     int64_t GetUniqueId() const noexcept;
 
@@ -20,6 +22,8 @@ public:
     void SetDepth(size_t depth);
 
     PiecewiseLinearFunction GetDeltaS();
+    // Replaces demand and supply functions, balance of market must be found again
+    void SetFunctions(PiecewiseLinearFunction D, PiecewiseLinearFunction S);
     void SetDeltaSDash(PiecewiseLinearFunction delta_s_dash);
 
     PiecewiseLinearFunction GetDeltaSDash();
@@ -66,13 +70,17 @@ public:
         p_ = p;
     }
 
+    // Found once for current functions
     long double GetZeroPrice() {
-        return GetDeltaS().FindFunctionZeroValue().GetSinglePoint();
+        if (!zero_price_) {
+            zero_price_ = delta_S_.FindFunctionZeroValue().GetSinglePoint();
+        }
+        return *zero_price_;
     }
 
     long double GetDemandZeroingPrice() {
         long double result = -1;
-        for (auto&& func : D_.GetFunctions()) {
+        for (auto&& func : D_.GetFunctionsStorage()) {
             if (func.IsHorizontal() && func.GetLinearFunction().GetACoeff() == 0 && func.GetLinearFunction().GetCCoeff() == 0) {
                 result = func.GetXStartCoordinate();
                 break;
@@ -90,10 +98,12 @@ public:
     }
 
     static std::shared_ptr<Node> GenerateRandomNode(long double c, long double d);
-    static std::shared_ptr<Node> GenerateRandomNodeWithZeroPriceMoreThan(long double p);
-    static std::shared_ptr<Node> GenerateRandomNodeWithZeroPriceLessThan(long double p);
+    static std::shared_ptr<Node> GenerateRandomNodeWithZeroPriceMoreThan(long double p,
+            RandomStream& random = GetThreadRandomStream());
+    static std::shared_ptr<Node> GenerateRandomNodeWithZeroPriceLessThan(long double p,
+            RandomStream& random = GetThreadRandomStream());
 private:
-    // Unique identifier for node
+    // Unique identifier for node, taken from process wide counter, copies of node keep it
     int64_t unique_id_;
     // Функция спроса
     PiecewiseLinearFunction D_;
@@ -101,6 +111,8 @@ private:
     PiecewiseLinearFunction S_;
     // Функция чистого предложения
     PiecewiseLinearFunction delta_S_;
+    // Price where delta S is zero, not found yet if empty
+    std::optional<long double> zero_price_;
     // S-D balance
     PiecewiseLinearFunction delta_S_dash_;
     // Глубина вершины в дереве
@@ -1,6 +1,7 @@
 #pragma once
 #include "linear_function.h"
 #include "linear_function_define_on_segment.h"
+#include "linear_functions_storage.h"
 #include "segment.h"
 #include <vector>
 #include <iostream>
@@ -16,11 +17,16 @@ public:
      * Zero function only
      */
     PiecewiseLinearFunction() noexcept {
-        functions_.push_back(LinearFunctionDefineOnSegment(LinearFunction(0, 1, 0), -kINF, kINF));
+        functions_.GetMutable().push_back(LinearFunctionDefineOnSegment(LinearFunction(0, 1, 0), -kINF, kINF));
     }
 
     PiecewiseLinearFunction(std::vector<LinearFunctionDefineOnSegment> functions, Segment function_domain);
     PiecewiseLinearFunction(std::vector<Point> points);
+    /*
+     * Function on functions taken from other function as is, e.g. borrowed from shared market, domain is from
+     * start of first function to end of last one
+     */
+    explicit PiecewiseLinearFunction(LinearFunctionsStorage functions);
 
     PiecewiseLinearFunction GetInverseFunction() const;
 
@@ -41,7 +47,7 @@ public:
             throw std::runtime_error("Can't extend x end coordinate of vertical function");
         } else if (function_domain_.GetEnd() < x) {
             function_domain_.SetEnd(x);
-            functions_.back().SetXEndCoordinate(x);
+            functions_.GetMutable().back().SetXEndCoordinate(x);
         }
     }
 
@@ -68,11 +74,20 @@ public:
     }
 
     std::vector<LinearFunctionDefineOnSegment> GetFunctions() const {
+        return functions_.ToVector();
+    }
+
+    const LinearFunctionsStorage& GetFunctionsStorage() const noexcept {
         return functions_;
     }
 
     PiecewiseLinearFunction MirrorXAndY() const noexcept;
 
+    /*
+     * Same function without segments of zero length, they appear in sums of functions with common breakpoints
+     */
+    PiecewiseLinearFunction RemoveEmptySegments() const;
+
     Segment FindFunctionZeroValue() const;
 
     std::vector<Point> GetPoints() const {
@@ -96,10 +111,12 @@ public:
     static PiecewiseLinearFunction CreateSpFunction(long double c, long double d);
     static PiecewiseLinearFunction CreateDpFunction(long double c, long double d);
 
-    static PiecewiseLinearFunction GenerateSpFunction();
-    static PiecewiseLinearFunction GenerateDpFunction();
-    static PiecewiseLinearFunction GenerateNonIncreasingLinearFunction(Segment function_domain);
-    static PiecewiseLinearFunction GenerateNonDecreasingLinearFunction(Segment function_domain);
+    static PiecewiseLinearFunction GenerateSpFunction(RandomStream& random = GetThreadRandomStream());
+    static PiecewiseLinearFunction GenerateDpFunction(RandomStream& random = GetThreadRandomStream());
+    static PiecewiseLinearFunction GenerateNonIncreasingLinearFunction(Segment function_domain,
+            RandomStream& random = GetThreadRandomStream());
+    static PiecewiseLinearFunction GenerateNonDecreasingLinearFunction(Segment function_domain,
+            RandomStream& random = GetThreadRandomStream());
 
 private:
     static constexpr long double kDpXEndCoodinate = 1000;
@@ -126,9 +143,9 @@ private:
 
     template<typename FunctionGenerator, typename ShiftComparator>
     static PiecewiseLinearFunction GenerateLinearFunction(FunctionGenerator linear_function_generator,
-            ShiftComparator shift_comparator, Segment function_domain);
+            ShiftComparator shift_comparator, Segment function_domain, RandomStream& random);
     void ValidateFunctions();
-    std::vector<LinearFunctionDefineOnSegment> functions_;
+    LinearFunctionsStorage functions_;
     //Segment where function define
     Segment function_domain_;
 };
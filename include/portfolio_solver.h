@@ -0,0 +1,189 @@
+#pragma once
+
+#include "algorithm.h"
+#include "branch_and_bound.h"
+#include "local_search.h"
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <utility>
+
+struct PortfolioResult {
+    long double welfare = 0;
+    std::vector<bool> l_plus_lines_mask;
+    std::string best_strategy;
+    // Welfare found by each strategy in order of strategies
+    std::vector<std::pair<std::string, long double>> strategies_welfare;
+    // Exact strategy finished, so welfare is optimal
+    bool is_optimal = false;
+};
+
+/*
+ * Best welfare found by concurrent strategies
+ */
+class SharedIncumbent {
+public:
+    void Offer(const std::string& strategy, long double welfare, std::vector<bool> l_plus_lines_mask) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (l_plus_lines_mask_.empty() || welfare > welfare_) {
+            welfare_ = welfare;
+            l_plus_lines_mask_ = std::move(l_plus_lines_mask);
+            strategy_ = strategy;
+        }
+    }
+
+    long double GetWelfare() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return l_plus_lines_mask_.empty() ? std::numeric_limits<long double>::lowest() : welfare_;
+    }
+
+    void SetOptimal() {
+        is_optimal_ = true;
+    }
+
+    bool IsOptimal() const {
+        return is_optimal_;
+    }
+
+    void FillResult(PortfolioResult& result) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        result.welfare = welfare_;
+        result.l_plus_lines_mask = l_plus_lines_mask_;
+        result.best_strategy = strategy_;
+        result.is_optimal = is_optimal_;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    long double welfare_ = 0;
+    std::vector<bool> l_plus_lines_mask_;
+    std::string strategy_;
+    std::atomic<bool> is_optimal_{false};
+};
+
+/*
+ * Runs strategies concurrently, each on its own copy of market, and returns best result. Strategies are
+ * Algorithm with impact ranking of lines, Algorithm with star or chain lines first and with different fixed
+ * orders of lines, local search with restarts and branch and bound for markets with few free lines. Branch
+ * and bound prunes by best welfare of all strategies, Algorithm and local search stop when branch and bound
+ * proved optimum. Orders of lines are added until every thread has a strategy. Market is left solved with
+ * best result.
+ */
+class PortfolioSolver {
+public:
+    using Strategy = std::function<void(StarChainMarket&, SharedIncumbent&)>;
+
+    explicit PortfolioSolver(StarChainMarket& market, size_t threads_count = std::thread::hardware_concurrency())
+            : market_(market), threads_count_(std::max<size_t>(1, threads_count)) {}
+
+    PortfolioResult Solve() {
+        auto strategies = CreateStrategies();
+        SharedIncumbent incumbent;
+        std::vector<long double> strategies_welfare(strategies.size());
+        std::atomic<size_t> next_strategy{0};
+        auto worker = [&] {
+            for (auto i = next_strategy++; i < strategies.size(); i = next_strategy++) {
+                auto market = market_.Clone();
+                strategies[i].second(market, incumbent);
+                market.SolveAuxiliarySubtask();
+                strategies_welfare[i] = market.CalculateWelfare();
+                incumbent.Offer(strategies[i].first, strategies_welfare[i], market.GetLplushLinesMask());
+            }
+        };
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < std::min(threads_count_, strategies.size()); i++) {
+            threads.emplace_back(worker);
+        }
+        for (auto&& thread : threads) {
+            thread.join();
+        }
+
+        PortfolioResult result;
+        incumbent.FillResult(result);
+        for (size_t i = 0; i < strategies.size(); i++) {
+            result.strategies_welfare.emplace_back(strategies[i].first, strategies_welfare[i]);
+        }
+        auto edges = market_.GetEdges();
+        for (size_t i = 0; i < edges.size(); i++) {
+            edges[i]->SetAlgorithmType(result.l_plus_lines_mask[i] ? AlgorithmType::L_plus : AlgorithmType::L_minus);
+        }
+        market_.SolveAuxiliarySubtask();
+        return result;
+    }
+
+private:
+    static constexpr size_t kExactSearchMaxLinesCount = 24;
+
+    std::vector<std::pair<std::string, Strategy>> CreateStrategies() {
+        std::vector<std::pair<std::string, Strategy>> strategies;
+        auto add_algorithm = [&](std::string name, AlgorithmOptions options) {
+            options.is_verbose = false;
+            strategies.emplace_back(std::move(name), [options](StarChainMarket& market, SharedIncumbent& incumbent) {
+                auto stoppable_options = options;
+                stoppable_options.should_stop = [&incumbent] {
+                    return incumbent.IsOptimal();
+                };
+                Algorithm(market, stoppable_options);
+            });
+        };
+        const auto edges_count = market_.GetEdges().size();
+        std::vector<size_t> lines_order(edges_count);
+        std::iota(lines_order.begin(), lines_order.end(), 0);
+
+        auto fixed_order_options = [](bool is_chain_first, std::vector<size_t> order) {
+            AlgorithmOptions options;
+            options.is_chain_first = is_chain_first;
+            options.lines_order = std::move(order);
+            options.lines_order_policy = LinesOrderPolicy::FIXED;
+            return options;
+        };
+
+        add_algorithm("impact_order", AlgorithmOptions());
+        add_algorithm("star_first", fixed_order_options(false, {}));
+        add_algorithm("chain_first", fixed_order_options(true, {}));
+        add_algorithm("reversed_order", fixed_order_options(false, {lines_order.rbegin(), lines_order.rend()}));
+        auto edges = market_.GetEdges();
+        auto fixed_cost_order = lines_order;
+        std::sort(fixed_cost_order.begin(), fixed_cost_order.end(), [&](auto lhs, auto rhs) {
+            return edges[lhs]->Getef() < edges[rhs]->Getef();
+        });
+        add_algorithm("fixed_cost_order", fixed_order_options(false, fixed_cost_order));
+
+        strategies.emplace_back("local_search", [](StarChainMarket& market, SharedIncumbent& incumbent) {
+            market.Presolve();
+            auto free_lines = market.GetUndefinedEdges();
+            for (auto&& edge : free_lines) {
+                edge->SetAlgorithmType(AlgorithmType::L_minus);
+            }
+            LocalSearch local_search(market, free_lines);
+            local_search.SetStopCondition([&incumbent] {
+                return incumbent.IsOptimal();
+            });
+            local_search.Solve(free_lines.size());
+        });
+
+        if (edges_count <= kExactSearchMaxLinesCount) {
+            strategies.emplace_back("branch_and_bound", [](StarChainMarket& market, SharedIncumbent& incumbent) {
+                market.Presolve();
+                BranchAndBound branch_and_bound(market, market.GetUndefinedEdges());
+                branch_and_bound.SetExternalLowerBound([&incumbent] {
+                    return incumbent.GetWelfare();
+                });
+                auto result = branch_and_bound.Solve();
+                incumbent.Offer("branch_and_bound", result.welfare, result.l_plus_lines_mask);
+                incumbent.SetOptimal();
+            });
+        }
+
+        for (size_t seed = 0; strategies.size() < threads_count_; seed++) {
+            auto shuffled_order = lines_order;
+            std::shuffle(shuffled_order.begin(), shuffled_order.end(), std::mt19937(seed));
+            add_algorithm("shuffled_order_" + std::to_string(seed), fixed_order_options(seed % 2 == 1, shuffled_order));
+        }
+        return strategies;
+    }
+
+    StarChainMarket& market_;
+    size_t threads_count_;
+};
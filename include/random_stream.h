@@ -0,0 +1,87 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <type_traits>
+
+/*
+ * Counter based random generator Philox4x32-10. Value number n of stream is Philox of counter (n, stream)
+ * with seed as key, so it doesn't depend on other streams or on values drawn before: each node or line
+ * derives own stream from its number, and generation in parallel gives the same values for any threads
+ * count. Values are mapped to ranges without std distributions, so they are the same for any standard library.
+ */
+class RandomStream {
+public:
+    using Block = std::array<uint32_t, 4>;
+
+    explicit RandomStream(uint64_t seed, uint64_t stream = 0)
+            : key_{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)}, stream_(stream) {}
+
+    static Block Philox(Block counter, std::array<uint32_t, 2> key) {
+        for (int round = 0; round < 10; round++) {
+            auto product0 = uint64_t(0xD2511F53) * counter[0];
+            auto product1 = uint64_t(0xCD9E8D57) * counter[2];
+            counter = {static_cast<uint32_t>(product1 >> 32) ^ counter[1] ^ key[0], static_cast<uint32_t>(product1),
+                    static_cast<uint32_t>(product0 >> 32) ^ counter[3] ^ key[1], static_cast<uint32_t>(product0)};
+            key[0] += 0x9E3779B9;
+            key[1] += 0xBB67AE85;
+        }
+        return counter;
+    }
+
+    uint64_t Next() {
+        if (buffered_count_ == 0) {
+            block_ = Philox({static_cast<uint32_t>(position_), static_cast<uint32_t>(position_ >> 32),
+                    static_cast<uint32_t>(stream_), static_cast<uint32_t>(stream_ >> 32)}, key_);
+            position_++;
+            buffered_count_ = 2;
+        }
+        auto i = 2 * (2 - buffered_count_--);
+        return uint64_t(block_[i]) | uint64_t(block_[i + 1]) << 32;
+    }
+
+    /*
+     * Integral value in [min_value, max_value], floating point value in [min_value, max_value)
+     */
+    template<typename T>
+    T Uniform(T min_value, T max_value) {
+        if constexpr (std::is_floating_point<T>::value) {
+            auto unit = static_cast<T>(Next() >> 11) * static_cast<T>(1.0 / (uint64_t(1) << 53));
+            return min_value + (max_value - min_value) * unit;
+        } else {
+            auto range = static_cast<uint64_t>(max_value) - static_cast<uint64_t>(min_value) + 1;
+            // Range 0 is the whole 64 bit range
+            auto offset = range == 0 ? Next() :
+                    static_cast<uint64_t>((static_cast<unsigned __int128>(Next()) * range) >> 64);
+            return static_cast<T>(static_cast<uint64_t>(min_value) + offset);
+        }
+    }
+
+private:
+    std::array<uint32_t, 2> key_;
+    uint64_t stream_;
+    // Number of next block in stream
+    uint64_t position_ = 0;
+    Block block_{};
+    // Values of block not returned yet
+    int buffered_count_ = 0;
+};
+
+/*
+ * Stream used when generator is called without stream, each thread has own stream seeded by random device
+ */
+inline RandomStream& GetThreadRandomStream() {
+    thread_local RandomStream stream([] {
+        std::random_device device;
+        return uint64_t(device()) << 32 | device();
+    }());
+    return stream;
+}
+
+/*
+ * Makes following generation on this thread reproducible
+ */
+inline void SetThreadRandomSeed(uint64_t seed) {
+    GetThreadRandomStream() = RandomStream(seed);
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "star_chain_market.h"
+#include <ostream>
+#include <string_view>
+
+/*
+ * Results of solved market as typed columns, node columns are in market nodes order and line columns in
+ * market edges order. Flow is oriented from start to end of line.
+ */
+struct ResultColumns {
+    std::vector<double> nodes_prices;
+    std::vector<double> nodes_vs;
+    std::vector<double> nodes_vd;
+    std::vector<double> nodes_zero_prices;
+
+    std::vector<uint32_t> lines_from;
+    std::vector<uint32_t> lines_to;
+    std::vector<double> lines_flows;
+    std::vector<uint8_t> lines_expand;
+    std::vector<uint8_t> lines_algorithm_types;
+    // et * |flow|
+    std::vector<double> lines_transport_costs;
+    // ef of expanded line
+    std::vector<double> lines_fixed_costs;
+    // Ev_coeff * (|flow| - Q)^2 of expanded line
+    std::vector<double> lines_expansion_costs;
+
+    static ResultColumns Collect(StarChainMarket& market);
+};
+
+/*
+ * Columnar export of solved market. Binary file is little endian: header, column descriptors, then
+ * column data, each column aligned to 64 bytes, so file mapped to memory is read as plain arrays.
+ * CSV has one file for nodes and one for lines with column names in the first row.
+ */
+class ResultExport {
+public:
+    static constexpr uint32_t kVersion = 1;
+
+    enum class Table : uint32_t {
+        NODES = 0,
+        LINES = 1
+    };
+
+    enum class ColumnType : uint32_t {
+        FLOAT64 = 0,
+        UINT32 = 1,
+        UINT8 = 2
+    };
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t columns_count;
+        uint64_t nodes_count;
+        uint64_t lines_count;
+        uint64_t file_size;
+    };
+
+    struct ColumnRecord {
+        char name[32];
+        Table table;
+        ColumnType type;
+        // Byte offset of data from file start
+        uint64_t offset;
+    };
+
+    static void StoreBinary(std::ostream& os, const ResultColumns& columns);
+
+    static void StoreNodesCsv(std::ostream& os, const ResultColumns& columns);
+
+    static void StoreLinesCsv(std::ostream& os, const ResultColumns& columns);
+
+    /*
+     * Columns of binary export in memory without copying, data must be aligned to 64 bytes
+     * (memory mapped file is)
+     */
+    class View {
+    public:
+        explicit View(std::string_view data);
+
+        uint64_t GetNodesCount() const {
+            return header_->nodes_count;
+        }
+
+        uint64_t GetLinesCount() const {
+            return header_->lines_count;
+        }
+
+        const std::vector<ColumnRecord>& GetColumns() const {
+            return columns_;
+        }
+
+        /*
+         * Pointer to column values, count of values is count of nodes or lines of column table
+         */
+        template<typename T>
+        const T* GetColumn(std::string_view name) const;
+
+    private:
+        std::string_view data_;
+        const Header* header_;
+        std::vector<ColumnRecord> columns_;
+    };
+
+private:
+    static constexpr char kMagic[8] = {'S', 'C', 'M', 'R', 'S', 'L', 'T', '\0'};
+    static constexpr uint64_t kAlignment = 64;
+
+    static uint64_t Align(uint64_t offset) {
+        return (offset + kAlignment - 1) / kAlignment * kAlignment;
+    }
+
+    template<typename T>
+    static constexpr ColumnType GetColumnType();
+};
+
+template<typename T>
+constexpr ResultExport::ColumnType ResultExport::GetColumnType() {
+    if constexpr (std::is_same_v<T, double>) {
+        return ColumnType::FLOAT64;
+    } else if constexpr (std::is_same_v<T, uint32_t>) {
+        return ColumnType::UINT32;
+    } else {
+        static_assert(std::is_same_v<T, uint8_t>, "Unsupported column type");
+        return ColumnType::UINT8;
+    }
+}
+
+template<typename T>
+const T* ResultExport::View::GetColumn(std::string_view name) const {
+    for (auto&& column : columns_) {
+        if (name == column.name) {
+            if (column.type != GetColumnType<T>()) {
+                throw std::runtime_error("Result column " + std::string(name) + " has another type");
+            }
+            return reinterpret_cast<const T*>(data_.data() + column.offset);
+        }
+    }
+    throw std::runtime_error("No result column " + std::string(name));
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "json.h"
+#include "star_chain_market.h"
+#include <array>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <tuple>
+
+struct NodeFunctionsDelta {
+    size_t node_pos;
+    // Functions which are not set are kept
+    std::optional<PiecewiseLinearFunction> supply;
+    std::optional<PiecewiseLinearFunction> demand;
+};
+
+struct LineParametersDelta {
+    size_t edge_pos;
+    // Parameters which are not set are kept
+    std::optional<long double> et;
+    std::optional<long double> Q;
+    std::optional<long double> ef;
+    std::optional<long double> Ev_coeff;
+};
+
+struct ScenarioDelta {
+    std::vector<NodeFunctionsDelta> nodes;
+    std::vector<LineParametersDelta> lines;
+};
+
+struct ScenarioResult {
+    long double welfare = 0;
+    long double welfare_change = 0;
+    // Prices of changed nodes and flows of changed lines in order of delta
+    std::vector<long double> nodes_prices;
+    std::vector<long double> lines_flows;
+    int64_t rebalanced_nodes_count = 0;
+};
+
+/*
+ * What-if scenarios on resident base market with fixed line types. Scenario delta is applied to base market,
+ * S-D balances are recomputed only on paths from changed nodes and lines to the tree root, and after
+ * result is taken base functions, parameters, balances and market parameters are restored without solve.
+ * Scenario stream is JSON Lines, one scenario per line:
+ *   {"id": any value, "nodes": [{"node": number, "supply": [[x, y], ...], "demand": [[x, y], ...]}, ...],
+ *    "lines": [{"line": number, "et": value, "Q": value, "ef": value, "Ev_coeff": value}, ...]}
+ */
+class ScenarioRunner {
+public:
+    /*
+     * Base market is solved with its line types
+     */
+    explicit ScenarioRunner(StarChainMarket& base);
+
+    ScenarioResult Run(const ScenarioDelta& delta);
+
+    long double GetBaseWelfare() const {
+        return base_welfare_;
+    }
+
+    static ScenarioDelta ParseDelta(const JsonValue& scenario);
+
+    // Appends result members to JSON object text
+    static void WriteResult(std::string& text, const ScenarioResult& result);
+
+    /*
+     * Writes result line for each scenario line, returns count of scenarios with errors
+     */
+    int64_t RunStream(std::istream& in, std::ostream& out);
+
+private:
+    struct SavedState {
+        std::vector<std::pair<std::shared_ptr<Node>, PiecewiseLinearFunction>> nodes_delta_s_dash;
+        std::vector<std::pair<std::shared_ptr<Edge>, PiecewiseLinearFunction>> edges_delta_s;
+        std::vector<std::tuple<std::shared_ptr<Node>, PiecewiseLinearFunction, PiecewiseLinearFunction>> nodes_functions;
+        std::vector<std::tuple<std::shared_ptr<Edge>, long double, long double, long double, long double>> edges_parameters;
+    };
+
+    void SaveMarketParameters();
+    void Restore(const SavedState& state);
+
+    StarChainMarket& market_;
+    std::vector<std::shared_ptr<Node>> nodes_;
+    std::vector<std::shared_ptr<Edge>> edges_;
+    long double base_welfare_;
+    // Prices, volumes and flows of base market
+    std::vector<std::array<long double, 3>> nodes_parameters_;
+    std::vector<std::pair<long double, std::shared_ptr<Node>>> edges_flows_;
+};
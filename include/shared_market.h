@@ -0,0 +1,95 @@
+#pragma once
+
+#include "mapped_file.h"
+#include "market_snapshot.h"
+#include <memory>
+
+enum class SharedMarketSource {
+    SHARED_MEMORY,
+    FILE
+};
+
+/*
+ * Read only market model published once and attached by several worker processes. Layout is position
+ * independent: header, market snapshot, then functions of nodes which workers solve on, demand, supply and
+ * balance S - D as linear functions laid out like in memory, and tree root. Model is published as POSIX shared
+ * memory object or stored to file, attached model is mapped, so all workers share its pages. Workspace of
+ * worker borrows functions of nodes from the mapping and keeps it mapped, and holds only solve state: nodes
+ * and lines with prices, volumes, flows, balances of subtrees and types of lines. Function borrowed by
+ * workspace is copied only if solve changes it, e.g. when supply and demand are extended.
+ */
+class SharedMarket {
+public:
+    static constexpr uint32_t kVersion = 2;
+
+    /*
+     * Tree root of market is stored if tree is built
+     */
+    static void Store(std::ostream& os, StarChainMarket& market);
+
+    /*
+     * Publishes model as shared memory object with name like "/market", object with the same name is
+     * replaced, workers attached to it before keep old model. Header is written after all sections, so
+     * worker attaching during publish fails instead of reading part of model.
+     */
+    static void Publish(const std::string& name, StarChainMarket& market);
+
+    static void Unpublish(const std::string& name);
+
+    explicit SharedMarket(const std::string& name, SharedMarketSource source = SharedMarketSource::SHARED_MEMORY);
+
+    uint64_t GetNodesCount() const {
+        return header_->nodes_count;
+    }
+
+    uint64_t GetLinesCount() const {
+        return header_->edges_count;
+    }
+
+    /*
+     * Market of worker to solve on, its nodes borrow functions from the model, tree is built. Workspace
+     * may outlive the model object.
+     */
+    StarChainMarket CreateWorkspace() const;
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t reserved;
+        uint64_t nodes_count;
+        uint64_t edges_count;
+        // Nodes count if tree is not built
+        uint64_t tree_root;
+        uint64_t snapshot_offset;
+        uint64_t snapshot_size;
+        // Demand of node i is from offset 3i to 3i + 1, supply to 3i + 2, balance S - D to 3i + 3
+        uint64_t function_offsets_offset;
+        uint64_t functions_offset;
+        uint64_t functions_count;
+        uint64_t file_size;
+    };
+
+private:
+    static constexpr char kMagic[8] = {'S', 'C', 'M', 'S', 'H', 'A', 'R', 'E'};
+    // Snapshot sections are aligned to 16 bytes from its start
+    static constexpr uint64_t kAlignment = 64;
+
+    static uint64_t Align(uint64_t offset) {
+        return (offset + kAlignment - 1) / kAlignment * kAlignment;
+    }
+
+    static int Open(const std::string& name, SharedMarketSource source);
+
+    // Header of model found from market without storing it
+    static Header CreateHeader(StarChainMarket& market);
+
+    // Writes sections of model after header
+    static void StoreSections(std::ostream& os, StarChainMarket& market, const Header& header);
+
+    // Shared with workspaces borrowing functions
+    std::shared_ptr<const MappedFile> file_;
+    std::string_view data_;
+    const Header* header_;
+    const uint64_t* function_offsets_;
+    const LinearFunctionDefineOnSegment* functions_;
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "json.h"
+#include "scenario_runner.h"
+#include "star_chain_market.h"
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+
+class ThreadPool;
+
+/*
+ * Solver daemon keeping parsed markets resident by id. Requests and responses are JSON Lines, response has id
+ * of request and goes when request is solved, so responses of one client may go out of order. Requests are
+ * batch mode requests (see BatchSolver) with "market_id" of resident market instead of "market", and
+ *   {"operation": "load", "market_id": id, "market": market} to load or replace market,
+ *   {"operation": "unload", "market_id": id}, {"operation": "list"},
+ *   {"operation": "what_if", "market_id": id, "mask": L_plus lines, "scenario": delta} for scenario delta
+ *     (see ScenarioRunner), lines are not expanded if mask is not set. Market solved for the mask is kept
+ *     for following what_if requests with the same mask.
+ * Requests with the same market id, load and unload included, wait in queue of the id and go to worker pool
+ * one by one in order of arrival, so waiting requests don't hold workers. Requests to different markets go
+ * concurrently. Clients are served over Unix domain socket by epoll event loop or over stdin and stdout.
+ */
+class SolverService {
+public:
+    explicit SolverService(size_t threads_count = std::thread::hardware_concurrency())
+            : threads_count_(std::max<size_t>(1, threads_count)) {}
+
+    /*
+     * Response line without line end, thread safe
+     */
+    std::string Handle(std::string_view request_line);
+
+    /*
+     * Serves requests from in until its end
+     */
+    void ServeStream(std::istream& in, std::ostream& out);
+
+    /*
+     * Serves clients of socket at path until Stop
+     */
+    void ServeSocket(const std::string& path);
+
+    /*
+     * Makes ServeSocket return, thread safe
+     */
+    void Stop();
+
+private:
+    struct ResidentMarket {
+        std::mutex mutex;
+        StarChainMarket market;
+        // Runner of last what_if with market solved for its mask, reset by other operations
+        std::unique_ptr<ScenarioRunner> scenario_runner;
+        std::string scenario_mask;
+    };
+
+    using Respond = std::function<void(std::string)>;
+
+    // Requests of market id not yet solved
+    struct MarketQueue {
+        // Request of market id is on worker pool
+        bool is_busy = false;
+        std::deque<std::pair<JsonValue, Respond>> requests;
+    };
+
+    std::shared_ptr<ResidentMarket> FindMarket(const JsonValue& request);
+    std::string HandleRequest(const JsonValue& request);
+    void HandleOperation(const JsonValue& request, std::string& result);
+
+    /*
+     * Solves request on pool and passes response line to respond, called by one thread
+     */
+    void Submit(ThreadPool& pool, std::string_view request_line, Respond respond);
+    // Solves first request of market id queue and submits the next one
+    void RunQueued(ThreadPool& pool, const std::string& market_id);
+
+    size_t threads_count_;
+    std::shared_mutex markets_mutex_;
+    std::unordered_map<std::string, std::shared_ptr<ResidentMarket>> markets_;
+    std::mutex queues_mutex_;
+    // Queues of market ids with requests, queue is removed when it gets empty
+    std::unordered_map<std::string, MarketQueue> queues_;
+    std::atomic<bool> is_stopped_{false};
+    // Event file descriptor which wakes event loop, -1 if loop is not running
+    std::atomic<int> wake_fd_{-1};
+};
@@ -5,27 +5,67 @@
 #include <unordered_map>
 #include <memory>
 #include <fstream>
+#include <limits>
+#include <optional>
+
+struct LineExpansionBound {
+    long double lower;
+    long double upper;
+};
+
+struct PresolveResult {
+    // Lines which can't carry flow
+    int64_t no_flow_lines_count = 0;
+    // Lines whose flow can't reach Q
+    int64_t not_saturated_lines_count = 0;
+    // Lines without fixed cost of expansion
+    int64_t free_expansion_lines_count = 0;
+
+    int64_t GetFixedLinesCount() const {
+        return no_flow_lines_count + not_saturated_lines_count + free_expansion_lines_count;
+    }
+};
 
 class StarChainMarket {
 public:
     StarChainMarket() = default;
 
+    /*
+     * Deep copy with own nodes and lines, so copy can be solved independently, e.g. in another thread
+     */
+    StarChainMarket Clone() const;
+
     bool AddNode(std::shared_ptr<Node> node, bool is_central_market_node = false);
     bool AddEdge(std::shared_ptr<Edge> edge);
     bool AddNodeAndEdge(std::shared_ptr<Node> node, std::shared_ptr<Edge> edge);
+    // Reserves memory for bulk adding of nodes and lines
+    void Reserve(size_t nodes_count, size_t edges_count);
+    // Reserves lines of added nodes, degrees are in order of nodes
+    void ReserveAdjacency(const std::vector<size_t>& degrees);
     void SetCentralNode(std::shared_ptr<Node> node);
     bool MarketContainNode(std::shared_ptr<Node> node) const noexcept;
+    // Lines connect all nodes and there are no cycles
+    bool IsTree() const;
     void BuildTreeMinDepth();
     int64_t GetVectorPosByNode(std::shared_ptr<Node> node);
+    // Throws if market doesn't contain node
+    int64_t GetVectorPosByNode(std::shared_ptr<Node> node) const;
 
     static std::optional<StarChainMarket> GenerateRandomMarket(int64_t import_from_center_nodes_count,
             int64_t export_to_center_node_nodes_count, int64_t chain_nodes_count);
 
-    std::vector<std::shared_ptr<Node>> GetNodes() {
+    /*
+     * Same market for the same seed: node i and line to it are drawn from stream i of seed, in order central
+     * node, import nodes, export nodes, chain
+     */
+    static std::optional<StarChainMarket> GenerateRandomMarket(int64_t import_from_center_nodes_count,
+            int64_t export_to_center_node_nodes_count, int64_t chain_nodes_count, uint64_t seed);
+
+    std::vector<std::shared_ptr<Node>> GetNodes() const {
         return nodes_;
     }
 
-    std::vector<std::shared_ptr<Edge>> GetEdges() {
+    std::vector<std::shared_ptr<Edge>> GetEdges() const {
         return edges_;
     }
 
@@ -41,6 +81,16 @@ public:
         return result;
     }
 
+    std::vector<std::shared_ptr<Edge>> GetUndefinedEdges() {
+        std::vector<std::shared_ptr<Edge>> result;
+        for (auto&& edge : edges_) {
+            if (edge->GetAlgorithmType() == AlgorithmType::L_undefined) {
+                result.emplace_back(edge);
+            }
+        }
+        return result;
+    }
+
     std::vector<std::vector<std::shared_ptr<Edge>>>& GetMatrix() {
         return matrix_;
     }
@@ -57,6 +107,14 @@ public:
         return tree_root_pos_;
     }
 
+    // Sets tree root found before instead of BuildTreeMinDepth
+    void SetRootNodePos(int64_t pos) {
+        if (pos < 0 || pos >= static_cast<int64_t>(nodes_.size())) {
+            throw std::runtime_error("Tree root out of market nodes");
+        }
+        tree_root_pos_ = pos;
+    }
+
     std::vector<bool> GetLplushLinesMask() {
         std::vector<bool> answer;
         for (auto&& edge : edges_) {
@@ -71,8 +129,73 @@ public:
 
     void SolveAuxiliarySubtask();
 
+    /*
+     * Solve auxiliary subtask with lines expansion already set, algorithm types of lines are ignored
+     */
+    void SolveAuxiliarySubtaskForLinesExpansion();
+
+    /*
+     * Re-solve auxiliary subtask after expansion of single line changed according to its algorithm type.
+     * S-D balance recomputed only on the path from the line to the tree root, market parameters on whole tree.
+     * Full SolveAuxiliarySubtask must be called before. Returns count of rebalanced nodes.
+     */
+    int64_t SolveAuxiliarySubtaskAlongPath(std::shared_ptr<Edge> changed_edge);
+
+    /*
+     * Re-solve auxiliary subtask after changes of functions of nodes and parameters of lines. S-D balance
+     * recomputed only on paths from changed nodes and lines to the tree root, market parameters on whole tree.
+     * Full SolveAuxiliarySubtask must be called before. Returns count of rebalanced nodes.
+     */
+    int64_t SolveAuxiliarySubtaskAlongPaths(const std::vector<size_t>& changed_nodes,
+            const std::vector<std::shared_ptr<Edge>>& changed_edges);
+
+    /*
+     * Positions of nodes whose balances are recomputed by SolveAuxiliarySubtaskAlongPaths, children go
+     * before parents
+     */
+    std::vector<size_t> GetPathsToRoot(const std::vector<size_t>& changed_nodes,
+            const std::vector<std::shared_ptr<Edge>>& changed_edges);
+
+    // Line to parent in tree of last solve, nullptr for the tree root
+    std::shared_ptr<Edge> GetParentEdge(size_t node_pos) const {
+        return parent_edges_.at(node_pos);
+    }
+
+    /*
+     * Splits lines into classes of interchangeable lines: lines to leaves of the same node with equal line
+     * parameters and direction and equal leaf curves. Lines which are not spokes form single line classes
+     */
+    std::vector<std::vector<std::shared_ptr<Edge>>> FindInterchangeableLines(
+            const std::vector<std::shared_ptr<Edge>>& lines);
+
+    /*
+     * Fixes types of undefined lines decided by bounds which hold for any set of expanded lines,
+     * other lines are left undefined
+     */
+    PresolveResult Presolve();
+
     void Dfs(size_t node_pos, std::vector<bool>& used, int64_t depth = 0);
 
+    /*
+     * Flow through line to node from another line node as function of node price,
+     * S-D balance of another node must be found
+     */
+    static PiecewiseLinearFunction CreateDeltaSForLine(std::shared_ptr<Node> node, std::shared_ptr<Edge> edge);
+
+    /*
+     * Same flow for given S-D balance of another line node
+     */
+    static PiecewiseLinearFunction CreateDeltaSForLine(std::shared_ptr<Node> node, std::shared_ptr<Edge> edge,
+            const PiecewiseLinearFunction& another_node_balance);
+
+    /*
+     * Welfare of market with expansion of single line flipped, for all lines in market edges order.
+     * Market must be solved. Balance of subtree side of each line is left by FindSDBalance, balance of
+     * complement side is found by one top-down pass, so equilibrium with flipped line is found at the line
+     * and welfare change is integral of side balances between old and new prices.
+     */
+    std::vector<long double> CalculateWelfareWithEachLineFlipped();
+
     void PrintAll() {
         std::cout << "Tree Root position:\n";
         std::cout << tree_root_pos_ << std::endl;
@@ -133,7 +256,12 @@ public:
     }
 
     static StarChainMarket LoadMarket(std::ifstream&);
-    static void StoreMarket(std::ofstream&, StarChainMarket market);
+    // Loads market file in text or binary format mapped to memory
+    static StarChainMarket LoadMarket(const std::string& path);
+    static void StoreMarket(std::ofstream&, const StarChainMarket& market);
+    // Binary snapshot without loss of precision, see MarketSnapshot
+    static void StoreMarketBinary(std::ofstream&, StarChainMarket& market);
+    static StarChainMarket LoadMarketBinary(const std::string& path);
 
     void PrintNodes() {
         for (auto&& node : nodes_) {
@@ -166,6 +294,146 @@ public:
             EdgeType edge_type,
             int& tasks_solved);
 
+    /*
+     * Expands L_plus lines and undefined lines of other types except excluded line, other lines are not expanded
+     */
+    void SetLinesExpansionForComparison(const std::set<EdgeType>& other_types, std::shared_ptr<Edge> excluded_line) {
+        for (auto&& e : edges_) {
+            if (e->GetAlgorithmType() == AlgorithmType::L_plus) {
+                e->SetLineExpand();
+            } else if (e->GetAlgorithmType() == AlgorithmType::L_undefined
+                    && other_types.count(e->GetEdgeType()) && e != excluded_line) {
+                e->SetLineExpand();
+            } else {
+                e->SetLineNotExpand();
+            }
+        }
+    }
+
+    /*
+     * Bounds of welfare change from expanding single not expanded line, market must be solved.
+     * Welfare is concave in line capacity and its derivative at Q is the price gap over transport cost,
+     * so extra flow x gives at most gap * x - Ev_coeff * x^2 minus fixed cost. Not saturated line has zero gap.
+     */
+    LineExpansionBound EstimateLineExpansion(std::shared_ptr<Edge> edge) const {
+        auto price_gap = fabs(edge->GetEndNode()->GetP() - edge->GetStartNode()->GetP()) - edge->Getet();
+        price_gap = std::max<long double>(0, price_gap);
+        auto max_gain = edge->GetEvCoeff() > 0 ? price_gap * price_gap / (4 * edge->GetEvCoeff()) : std::numeric_limits<long double>::infinity();
+        return {-edge->Getef(), max_gain - edge->Getef()};
+    }
+
+    /*
+     * Expected effect of changing line type, market must be solved: price gap over transport cost times share
+     * of capacity used. Saturated line with large gap gains most from expansion, idle line loses least without it
+     */
+    long double EstimateLineImpact(std::shared_ptr<Edge> edge) const {
+        auto price_gap = fabs(edge->GetEndNode()->GetP() - edge->GetStartNode()->GetP()) - edge->Getet();
+        auto saturation = edge->GetQ() > 0 ? std::min<long double>(1, fabs(edge->Getqij()) / edge->GetQ()) : 1;
+        return std::max<long double>(0, price_gap) * saturation;
+    }
+
+    /*
+     * Bounds for all lines in market edges order, market must be solved
+     */
+    std::vector<LineExpansionBound> ScreenLinesExpansion() const {
+        std::vector<LineExpansionBound> bounds;
+        bounds.reserve(edges_.size());
+        for (auto&& edge : edges_) {
+            bounds.push_back(EstimateLineExpansion(edge));
+        }
+        return bounds;
+    }
+
+    /*
+     * Result of comparison of welfare without and with line if it is the same for all welfare changes
+     * within bound, comparison must be monotone in welfare with line
+     */
+    template<typename CompareWelrafe>
+    static std::optional<bool> CompareWelrafeByBound(LineExpansionBound bound, CompareWelrafe comp) {
+        bool at_lower = comp(0.0L, bound.lower - kEPS);
+        bool at_upper = comp(0.0L, bound.upper + kEPS);
+        if (at_lower != at_upper) {
+            return std::nullopt;
+        }
+        return at_lower;
+    }
+
+    /*
+     * Compares welfare without and with undefined line, other undefined lines of other types are expanded.
+     * Line gets result type if comparison holds, returns whether line type changed. Solve with line is
+     * skipped if expansion bound decides comparison.
+     */
+    template<typename CompareWelrafe>
+    bool CompareWelrafeAndChangeLine(std::shared_ptr<Edge> edge,
+            const std::map<EdgeType, std::set<EdgeType>>& other_types,
+            AlgorithmType result_line_type,
+            CompareWelrafe comp,
+            int& tasks_solved) {
+        SetLinesExpansionForComparison(other_types.at(edge->GetEdgeType()), edge);
+        SolveAuxiliarySubtaskForLinesExpansion();
+        tasks_solved++;
+
+        auto is_changed = CompareWelrafeByBound(EstimateLineExpansion(edge), comp);
+        if (!is_changed) {
+            auto welrafe_without_line = CalculateWelfare();
+            edge->SetLineExpand();
+            SolveAuxiliarySubtaskForLinesExpansion();
+            tasks_solved++;
+            is_changed = comp(welrafe_without_line, CalculateWelfare());
+        }
+        if (*is_changed) {
+            edge->SetAlgorithmType(result_line_type);
+        }
+        return *is_changed;
+    }
+
+    /*
+     * Same comparison for candidate lines which share one auxiliary subtask: their type is not among
+     * other types and result type keeps them not expanded. Bounds of all candidates come from one solve,
+     * solve with line is done only for candidates with not decisive bound. Returns changed lines.
+     */
+    template<typename CompareWelrafe>
+    std::vector<std::shared_ptr<Edge>> CompareWelrafeAndChangeLinesScreened(
+            const std::vector<std::shared_ptr<Edge>>& candidate_lines,
+            const std::set<EdgeType>& other_types,
+            AlgorithmType result_line_type,
+            CompareWelrafe comp,
+            int& tasks_solved) {
+        std::vector<std::shared_ptr<Edge>> changed_lines;
+        if (candidate_lines.empty()) {
+            return changed_lines;
+        }
+        SetLinesExpansionForComparison(other_types, nullptr);
+        SolveAuxiliarySubtaskForLinesExpansion();
+        tasks_solved++;
+        auto welrafe_without_line = CalculateWelfare();
+        auto bounds = ScreenLinesExpansion();
+
+        std::vector<std::shared_ptr<Edge>> inconclusive_lines;
+        for (auto&& edge : candidate_lines) {
+            auto pos = std::find(edges_.begin(), edges_.end(), edge) - edges_.begin();
+            auto is_changed = CompareWelrafeByBound(bounds[pos], comp);
+            if (!is_changed) {
+                inconclusive_lines.push_back(edge);
+            } else if (*is_changed) {
+                changed_lines.push_back(edge);
+            }
+        }
+        for (auto&& edge : inconclusive_lines) {
+            edge->SetLineExpand();
+            SolveAuxiliarySubtaskForLinesExpansion();
+            tasks_solved++;
+            if (comp(welrafe_without_line, CalculateWelfare())) {
+                changed_lines.push_back(edge);
+            }
+            edge->SetLineNotExpand();
+        }
+        for (auto&& edge : changed_lines) {
+            edge->SetAlgorithmType(result_line_type);
+        }
+        return changed_lines;
+    }
+
     template<typename CompareWelrafe>
     int64_t CompareWelrafeAndChangeLinesSubset(EdgeType line_type,
             std::map<EdgeType, std::set<EdgeType>> other_types,
@@ -175,30 +443,7 @@ public:
         int64_t add_lines_count = 0;
         for (auto&& edge : GetEdges()) {
             if (edge->GetAlgorithmType() == AlgorithmType::L_undefined && edge->GetEdgeType() == line_type) {
-                for (auto&& e : GetEdges()) {
-                    if (e->GetAlgorithmType() == AlgorithmType::L_plus) {
-                        e->SetLineExpand();
-                    } else if (e->GetAlgorithmType() == AlgorithmType::L_undefined
-                            && other_types[line_type].count(e->GetEdgeType()) && e != edge) {
-                        e->SetLineExpand();
-                    } else {
-                        e->SetLineNotExpand();
-                    }
-                }
-
-                SolveAuxiliarySubtask();
-                tasks_solved++;
-                auto welrafe_without_line = CalculateWelfare();
-
-                edge->SetLineExpand();
-                SolveAuxiliarySubtask();
-                tasks_solved++;
-                auto welrafe_with_line = CalculateWelfare();
-
-                //std::cout << "Welrafe: " << welrafe_without_line << " " << welrafe_with_line << std::endl;
-
-                if (comp(welrafe_without_line, welrafe_with_line)) {
-                    edge->SetAlgorithmType(result_line_type);
+                if (CompareWelrafeAndChangeLine(edge, other_types, result_line_type, comp, tasks_solved)) {
                     add_lines_count++;
                 }
             }
@@ -211,13 +456,28 @@ private:
     static constexpr long double kdMax = 20;
     static constexpr long double kcMin = 10;
     static constexpr long double kcMax = 20;
-    static PiecewiseLinearFunction CreateDeltaSForLine(std::shared_ptr<Node> node, std::shared_ptr<Edge> edge);
 
     void FindMarketParameters(std::shared_ptr<Edge> edge, size_t node_pos, std::vector<bool>& used,
             double lambda);
 
     void FindSDBalance(size_t node_pos, std::vector<bool>& used);
 
+    void SumChildrenSDBalance(size_t node_pos);
+
+    // Parameters of line to leaf which are equal for interchangeable lines, nullopt if line is not to leaf
+    std::optional<std::vector<long double>> GetSpokeCanonicalKey(std::shared_ptr<Edge> edge);
+
+    void FindComplementSDBalance(size_t node_pos, const std::optional<PiecewiseLinearFunction>& outside_balance,
+            long double welfare, const std::unordered_map<const Edge*, size_t>& edge_positions,
+            std::vector<long double>& flipped_welfare);
+
+    void FlipChildLines(size_t node_pos, const std::vector<std::shared_ptr<Edge>>& child_edges, size_t begin,
+            size_t end, const PiecewiseLinearFunction& balance_without_children, long double welfare,
+            const std::unordered_map<const Edge*, size_t>& edge_positions, std::vector<long double>& flipped_welfare);
+
+    long double CalculateWelfareWithLineFlipped(std::shared_ptr<Edge> edge, size_t parent_pos,
+            PiecewiseLinearFunction complement_balance, long double welfare);
+
     bool FindTreeRootWithMinDepth(size_t node_pos, size_t to, int64_t path_length, std::vector<bool>& used);
 
     // Get by node unique id position in vector
@@ -232,4 +492,6 @@ private:
     std::shared_ptr<Node> central_market_node_;
     // Все ребра в маркете
     std::vector<std::shared_ptr<Edge>> edges_;
+    // Edge to parent node for each node in tree, nullptr for root, filled while finding S-D balance
+    std::vector<std::shared_ptr<Edge>> parent_edges_;
 };
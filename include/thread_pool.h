@@ -0,0 +1,66 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Fixed count of worker threads running submitted tasks in order of submission, destructor waits for
+ * all submitted tasks
+ */
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threads_count = std::thread::hardware_concurrency()) {
+        for (size_t i = 0; i < std::max<size_t>(1, threads_count); i++) {
+            threads_.emplace_back([this] {
+                Work();
+            });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            is_stopped_ = true;
+        }
+        tasks_changed_.notify_all();
+        for (auto&& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    void Submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push_back(std::move(task));
+        }
+        tasks_changed_.notify_one();
+    }
+
+private:
+    void Work() {
+        while (true) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            tasks_changed_.wait(lock, [this] { return !tasks_.empty() || is_stopped_; });
+            if (tasks_.empty()) {
+                return;
+            }
+            auto task = std::move(tasks_.front());
+            tasks_.pop_front();
+            lock.unlock();
+            task();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable tasks_changed_;
+    std::deque<std::function<void()>> tasks_;
+    bool is_stopped_ = false;
+    std::vector<std::thread> threads_;
+};
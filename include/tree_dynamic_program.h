@@ -0,0 +1,245 @@
+#pragma once
+
+#include "star_chain_market.h"
+#include <limits>
+
+struct TreeDynamicProgramResult {
+    long double welfare = 0;
+    std::vector<bool> l_plus_lines_mask;
+    // Count of subtree configurations built while merging
+    int64_t configurations_count = 0;
+    // Max count of non-dominated configurations kept for one subtree
+    size_t max_frontier_size = 0;
+    // Configurations of whole tree solved for root price, plus final solve with chosen types
+    int64_t solved_subtasks_count = 0;
+};
+
+/*
+ * Exact optimizer over expansion sets which goes up the tree from leaves.
+ * Subtree configuration is described by balance function q(p) of subtree, flow to parent as function of
+ * parent price, and subtree surplus at reference price: surplus at any price p is reference surplus
+ * plus integral of q from reference price to p. Configuration is dropped if another configuration of the
+ * same subtree has not less surplus for every price which can be equilibrium price.
+ */
+class TreeDynamicProgram {
+public:
+    explicit TreeDynamicProgram(StarChainMarket& market) : TreeDynamicProgram(market, market.GetEdges()) {}
+
+    /*
+     * Only free lines are decided, other lines are expanded if they are L_plus and not expanded otherwise
+     */
+    TreeDynamicProgram(StarChainMarket& market, std::vector<std::shared_ptr<Edge>> free_lines)
+            : market_(market), edges_(market.GetEdges()), free_lines_(std::move(free_lines)) {
+        min_price_ = std::numeric_limits<long double>::max();
+        max_price_ = std::numeric_limits<long double>::lowest();
+        // Node with max price can't export and node with min price can't import, so prices are between zero prices
+        for (auto&& node : market_.GetNodes()) {
+            min_price_ = std::min(min_price_, node->GetZeroPrice());
+            max_price_ = std::max(max_price_, node->GetZeroPrice());
+        }
+    }
+
+    /*
+     * Finds welfare optimal types of free lines, market is left solved with them
+     */
+    TreeDynamicProgramResult Solve() {
+        result_ = TreeDynamicProgramResult();
+        std::vector<bool> used(market_.GetNodes().size(), false);
+        auto frontier = BuildFrontier(market_.GetRootNodePos(), used);
+
+        long double best_welfare = std::numeric_limits<long double>::lowest();
+        for (auto&& config : frontier) {
+            result_.solved_subtasks_count++;
+            auto root_price = config.balance.FindFunctionZeroValue().GetStart();
+            auto welfare = config.reference_surplus + Integrate(config.balance, min_price_, root_price);
+            if (welfare > best_welfare) {
+                best_welfare = welfare;
+                result_.l_plus_lines_mask = config.l_plus_lines_mask;
+            }
+        }
+
+        for (size_t i = 0; i < edges_.size(); i++) {
+            if (IsFreeLine(edges_[i])) {
+                edges_[i]->SetAlgorithmType(result_.l_plus_lines_mask[i] ? AlgorithmType::L_plus :
+                        AlgorithmType::L_minus);
+            }
+        }
+        market_.SolveAuxiliarySubtask();
+        result_.solved_subtasks_count++;
+        result_.welfare = market_.CalculateWelfare();
+        result_.l_plus_lines_mask = market_.GetLplushLinesMask();
+        return result_;
+    }
+
+private:
+    struct Configuration {
+        PiecewiseLinearFunction balance;
+        long double reference_surplus;
+        std::vector<bool> l_plus_lines_mask;
+    };
+
+    /*
+     * Configurations of subtree with its root price as argument of balance
+     */
+    std::vector<Configuration> BuildFrontier(size_t node_pos, std::vector<bool>& used) {
+        used[node_pos] = true;
+        auto node = market_.GetNodes()[node_pos];
+        std::vector<Configuration> frontier;
+        Insert(frontier, {node->GetDeltaS(), NodeSurplus(node, min_price_), std::vector<bool>(edges_.size(), false)});
+
+        for (auto&& edge : market_.GetMatrix()[node_pos]) {
+            auto to_index = market_.GetVectorPosByNode(edge->GetAnotherNode(node));
+            if (used[to_index]) {
+                continue;
+            }
+            auto line_frontier = AddLine(node, edge, BuildFrontier(to_index, used));
+            std::vector<Configuration> merged_frontier;
+            for (auto&& config : frontier) {
+                for (auto&& line_config : line_frontier) {
+                    auto mask = config.l_plus_lines_mask;
+                    for (size_t i = 0; i < mask.size(); i++) {
+                        mask[i] = mask[i] || line_config.l_plus_lines_mask[i];
+                    }
+                    Insert(merged_frontier, {config.balance + line_config.balance,
+                            config.reference_surplus + line_config.reference_surplus, mask});
+                }
+            }
+            frontier = std::move(merged_frontier);
+        }
+        return frontier;
+    }
+
+    /*
+     * Configurations of child subtree together with line to parent, parent price is argument of balance
+     */
+    std::vector<Configuration> AddLine(std::shared_ptr<Node> parent, std::shared_ptr<Edge> edge,
+            std::vector<Configuration> child_frontier) {
+        auto child = edge->GetAnotherNode(parent);
+        auto edge_pos = std::find(edges_.begin(), edges_.end(), edge) - edges_.begin();
+        std::vector<Configuration> frontier;
+        std::vector<bool> expand_variants{edge->GetAlgorithmType() == AlgorithmType::L_plus};
+        if (IsFreeLine(edge)) {
+            expand_variants = {false, true};
+        }
+        for (auto&& config : child_frontier) {
+            for (bool is_expand : expand_variants) {
+                if (is_expand) {
+                    edge->SetLineExpand();
+                } else {
+                    edge->SetLineNotExpand();
+                }
+                child->SetDeltaSDash(config.balance);
+                auto response = StarChainMarket::CreateDeltaSForLine(parent, edge);
+
+                // Child subtree sells q at child price, line delivers it to parent price
+                auto q = response.GetValueAtPoint(min_price_).GetStart();
+                if (!is_expand) {
+                    q = std::max(-edge->GetQ(), std::min(edge->GetQ(), q));
+                }
+                auto child_price = config.balance.GetInverseFunction().GetValueAtPoint(q).GetStart();
+                auto child_surplus = config.reference_surplus + Integrate(config.balance, min_price_, child_price);
+                auto surplus = child_surplus + (min_price_ - child_price) * q - edge->GetEValueAtPoint(q);
+
+                auto mask = config.l_plus_lines_mask;
+                mask[edge_pos] = is_expand;
+                Insert(frontier, {response, surplus, mask});
+            }
+        }
+        return frontier;
+    }
+
+    void Insert(std::vector<Configuration>& frontier, Configuration config) {
+        result_.configurations_count++;
+        for (auto&& kept : frontier) {
+            if (Dominates(kept, config)) {
+                return;
+            }
+        }
+        frontier.erase(std::remove_if(frontier.begin(), frontier.end(), [&](auto&& kept) {
+            return Dominates(config, kept);
+        }), frontier.end());
+        frontier.push_back(std::move(config));
+        result_.max_frontier_size = std::max(result_.max_frontier_size, frontier.size());
+    }
+
+    /*
+     * Surplus difference is piecewise quadratic, so its minimum is at breakpoints of balances or
+     * where difference of balances changes sign from minus to plus
+     */
+    bool Dominates(Configuration& lhs, Configuration& rhs) {
+        auto lhs_functions = lhs.balance.GetFunctions();
+        auto rhs_functions = rhs.balance.GetFunctions();
+        auto range_start = std::max({min_price_, lhs.balance.GetFunctionDomain().GetStart(),
+                rhs.balance.GetFunctionDomain().GetStart()});
+        auto range_end = std::min({max_price_, lhs.balance.GetFunctionDomain().GetEnd(),
+                rhs.balance.GetFunctionDomain().GetEnd()});
+
+        std::vector<long double> points{range_start, range_end};
+        for (auto functions : {&lhs_functions, &rhs_functions}) {
+            for (auto&& func : *functions) {
+                for (auto x : {func.GetXStartCoordinate(), func.GetXEndCoordinate()}) {
+                    if (x > range_start && x < range_end) {
+                        points.push_back(x);
+                    }
+                }
+            }
+        }
+        std::sort(points.begin(), points.end());
+        points.erase(std::unique(points.begin(), points.end()), points.end());
+
+        auto candidates = points;
+        for (size_t i = 1; i < points.size(); i++) {
+            auto mid = (points[i - 1] + points[i]) / 2;
+            auto diff_start = ValueOnPiece(lhs_functions, mid, points[i - 1]) - ValueOnPiece(rhs_functions, mid, points[i - 1]);
+            auto diff_end = ValueOnPiece(lhs_functions, mid, points[i]) - ValueOnPiece(rhs_functions, mid, points[i]);
+            if (diff_start < 0 && diff_end > 0) {
+                candidates.push_back(points[i - 1] + (points[i] - points[i - 1]) * diff_start / (diff_start - diff_end));
+            }
+        }
+
+        for (auto x : candidates) {
+            auto difference = lhs.reference_surplus - rhs.reference_surplus + Integrate(lhs.balance, min_price_, x)
+                    - Integrate(rhs.balance, min_price_, x);
+            if (difference < -kEPS) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Value at x of not vertical piece which contains inner point
+    static long double ValueOnPiece(const std::vector<LinearFunctionDefineOnSegment>& functions,
+            long double inner_point, long double x) {
+        for (auto&& func : functions) {
+            if (!func.IsVertical() && func.GetXStartCoordinate() <= inner_point && func.GetXEndCoordinate() >= inner_point) {
+                return func.GetLinearFunction().GetValueAtPoint(x);
+            }
+        }
+        throw std::runtime_error("Point out of function domain");
+    }
+
+    bool IsFreeLine(std::shared_ptr<Edge> edge) const {
+        return std::find(free_lines_.begin(), free_lines_.end(), edge) != free_lines_.end();
+    }
+
+    static long double Integrate(PiecewiseLinearFunction& func, long double from, long double to) {
+        return from <= to ? func.Integrate(from, to) : -func.Integrate(to, from);
+    }
+
+    /*
+     * Consumer and producer surplus of node at price
+     */
+    static long double NodeSurplus(std::shared_ptr<Node> node, long double price) {
+        auto D = node->GetD();
+        auto S = node->GetS();
+        return D.Integrate(price, D.GetFunctionDomain().GetEnd()) + S.Integrate(0, price);
+    }
+
+    StarChainMarket& market_;
+    std::vector<std::shared_ptr<Edge>> edges_;
+    std::vector<std::shared_ptr<Edge>> free_lines_;
+    // Range of possible equilibrium prices, start of range is reference price
+    long double min_price_;
+    long double max_price_;
+    TreeDynamicProgramResult result_;
+};
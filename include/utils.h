@@ -1,6 +1,6 @@
 #pragma once
+#include "random_stream.h"
 #include "segment.h"
-#include <random>
 #include <vector>
 #include <algorithm>
 #include <type_traits>
@@ -15,32 +15,23 @@ constexpr int64_t kINF = 1e4;
 template<typename T>
 using is_sampled = std::__or_<std::is_integral<T>, std::is_floating_point<T>>;
 
+/*
+ * Stream of thread is used by default, so markets can be built concurrently
+ */
 template<typename T>
 typename std::enable_if<is_sampled<T>::value, T>::type GenerateRandomValue(const T& kMinValue,
-        const T& kMaxValue) {
-    static std::random_device rd;
-    static std::mt19937 rng(rd());
-    if constexpr(std::is_floating_point<T>::value) {
-        std::uniform_real_distribution<T> uni(kMinValue, kMaxValue);
-        auto res = uni(rng);
-        return res;
-    }
-    else if constexpr (std::is_integral<T>::value) {
-        std::uniform_int_distribution<T> uni(kMinValue, kMaxValue);
-        auto res = uni(rng);
-        return res;
-    }
-
+        const T& kMaxValue, RandomStream& random = GetThreadRandomStream()) {
+    return random.Uniform<T>(kMinValue, kMaxValue);
 }
 
 template<typename T>
 typename std::enable_if<is_sampled<T>::value, std::vector<T>>::type GenerateVectorOfValues(
-        const T& kMinValue, const T& kMaxValue, size_t sequence_size) {
+        const T& kMinValue, const T& kMaxValue, size_t sequence_size, RandomStream& random = GetThreadRandomStream()) {
     std::unordered_set<T> already_generated_values;
     std::vector<T> result;
     size_t num = 0;
     while (num < sequence_size) {
-        auto val = GenerateRandomValue(kMinValue, kMaxValue);
+        auto val = GenerateRandomValue(kMinValue, kMaxValue, random);
         if (!already_generated_values.count(val)) {
             result.emplace_back(val);
             already_generated_values.insert(val);
@@ -74,31 +65,7 @@ inline auto Split(const std::string& txt, std::vector<std::stringstream>& strs,
 }
 
 inline auto GetOnesBitsCount(int64_t mask) {
-    int result = 0;
-    for (auto i = 0; i < 64; i++) {
-        if ((mask >> i) & 1) {
-            result++;
-        }
-    }
-    return result;
-}
-
-inline auto GenerateBitMasks(size_t length) {
-    if (length > 64) {
-        throw std::runtime_error("Length of mask overflow");
-    }
-    int64_t mask = 0;
-    for (size_t i = 0; i < length; i++) {
-        mask |= (1 << i);
-    }
-    std::unordered_map<size_t, std::vector<int64_t>> ones_bits_to_masks;
-    while (mask != 0) {
-        auto ones_bits_count = GetOnesBitsCount(mask);
-        ones_bits_to_masks[ones_bits_count].emplace_back(mask);
-        mask--;
-    }
-    ones_bits_to_masks[0].emplace_back(0);
-    return ones_bits_to_masks;
+    return __builtin_popcountll(mask);
 }
 
 inline auto MaskToVector(int64_t mask, size_t edges_count) {
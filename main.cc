@@ -1,6 +1,13 @@
 #include "algorithm.h"
+#include "batch_solver.h"
+#include "market_generator.h"
+#include "result_export.h"
+#include "scenario_runner.h"
+#include "shared_market.h"
+#include "solver_service.h"
 #include "star_chain_market.h"
 #include "experiment.h"
+#include <cstring>
 #include <iostream>
 #include <fstream>
 
@@ -12,21 +19,180 @@ void StoreGeneratedMarket(char** argv) {
 }
 
 inline auto LoadMarket(char** argv) {
-    std::ifstream f(argv[1], std::ios_base::in);
-    auto market = StarChainMarket::LoadMarket(f);
-    f.close();
-    return market;
+    return StarChainMarket::LoadMarket(std::string(argv[1]));
+}
+
+/*
+ * start_chain_market --batch [requests.jsonl]: solves requests from file or stdin, see BatchSolver
+ */
+inline int RunBatch(int argc, char** argv) {
+    BatchSolverResult result;
+    if (argc > 2 && std::strcmp(argv[2], "-") != 0) {
+        std::ifstream f(argv[2], std::ios_base::in);
+        if (!f) {
+            std::cerr << "Can't open " << argv[2] << std::endl;
+            return 1;
+        }
+        result = BatchSolver().Run(f, std::cout);
+    } else {
+        result = BatchSolver().Run(std::cin, std::cout);
+    }
+    std::cerr << "Requests: " << result.requests_count << " errors: " << result.errors_count << std::endl;
+    return 0;
+}
+
+/*
+ * start_chain_market --scenarios market [scenarios.jsonl]: solves scenarios from file or stdin on base market,
+ * see ScenarioRunner
+ */
+inline int RunScenarios(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Market file expected" << std::endl;
+        return 1;
+    }
+    auto market = StarChainMarket::LoadMarket(std::string(argv[2]));
+    market.BuildTreeMinDepth();
+    ScenarioRunner runner(market);
+    int64_t errors_count = 0;
+    if (argc > 3 && std::strcmp(argv[3], "-") != 0) {
+        std::ifstream f(argv[3], std::ios_base::in);
+        if (!f) {
+            std::cerr << "Can't open " << argv[3] << std::endl;
+            return 1;
+        }
+        errors_count = runner.RunStream(f, std::cout);
+    } else {
+        errors_count = runner.RunStream(std::cin, std::cout);
+    }
+    std::cerr << "Base welfare: " << runner.GetBaseWelfare() << " errors: " << errors_count << std::endl;
+    return 0;
+}
+
+/*
+ * start_chain_market --serve [socket]: solver daemon on Unix domain socket or stdin and stdout, see SolverService
+ */
+inline int RunService(int argc, char** argv) {
+    SolverService service;
+    if (argc > 2) {
+        service.ServeSocket(argv[2]);
+    } else {
+        service.ServeStream(std::cin, std::cout);
+    }
+    return 0;
+}
+
+/*
+ * start_chain_market --export market output [csv]: solves market by algorithm and writes results as binary
+ * columns to output, or as CSV to output_nodes.csv and output_lines.csv, see ResultExport
+ */
+inline int RunExport(int argc, char** argv) {
+    if (argc < 4) {
+        std::cerr << "Market file and output expected" << std::endl;
+        return 1;
+    }
+    auto market = StarChainMarket::LoadMarket(std::string(argv[2]));
+    market.BuildTreeMinDepth();
+    AlgorithmOptions options;
+    options.is_verbose = false;
+    Algorithm(market, options);
+    market.SolveAuxiliarySubtask();
+    auto columns = ResultColumns::Collect(market);
+    std::string output = argv[3];
+    if (argc > 4 && std::strcmp(argv[4], "csv") == 0) {
+        std::ofstream nodes_file(output + "_nodes.csv", std::ios_base::out);
+        ResultExport::StoreNodesCsv(nodes_file, columns);
+        std::ofstream lines_file(output + "_lines.csv", std::ios_base::out);
+        ResultExport::StoreLinesCsv(lines_file, columns);
+    } else {
+        std::ofstream file(output, std::ios_base::binary);
+        ResultExport::StoreBinary(file, columns);
+    }
+    std::cerr << "Welfare: " << market.CalculateWelfare() << std::endl;
+    return 0;
+}
+
+/*
+ * start_chain_market --publish market name: publishes market with built tree as shared memory object for
+ * workers, e.g. batch requests with {"shared": name} market, see SharedMarket
+ */
+inline int RunPublish(int argc, char** argv) {
+    if (argc < 4) {
+        std::cerr << "Market file and shared memory object name expected" << std::endl;
+        return 1;
+    }
+    auto market = StarChainMarket::LoadMarket(std::string(argv[2]));
+    market.BuildTreeMinDepth();
+    SharedMarket::Publish(argv[3], market);
+    std::cerr << "Published " << market.GetNodes().size() << " nodes and " << market.GetEdges().size()
+              << " lines as " << argv[3] << std::endl;
+    return 0;
+}
+
+/*
+ * start_chain_market --generate output import_stars export_stars chains chain_length [seed] [text|binary]:
+ * writes random market of any size without building it in memory, see MarketGenerator
+ */
+inline int RunGenerate(int argc, char** argv) {
+    if (argc < 7) {
+        std::cerr << "Output and counts of import stars, export stars, chains and chain length expected" << std::endl;
+        return 1;
+    }
+    MarketGeneratorOptions options;
+    options.import_star_nodes_count = std::stoull(argv[3]);
+    options.export_star_nodes_count = std::stoull(argv[4]);
+    options.chains_count = std::stoull(argv[5]);
+    options.chain_length = std::stoull(argv[6]);
+    options.seed = argc > 7 ? std::stoull(argv[7]) : std::random_device()();
+    MarketGenerator generator(options);
+    std::ofstream f(argv[2], std::ios_base::binary);
+    if (argc > 8 && std::strcmp(argv[8], "binary") == 0) {
+        generator.WriteBinary(f);
+    } else {
+        generator.WriteText(f);
+    }
+    std::cerr << "Generated " << generator.GetNodesCount() << " nodes and " << generator.GetLinesCount()
+              << " lines with seed " << options.seed << std::endl;
+    return 0;
 }
 
 int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv) {
+    if (argc > 1 && std::strcmp(argv[1], "--batch") == 0) {
+        return RunBatch(argc, argv);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--scenarios") == 0) {
+        return RunScenarios(argc, argv);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--serve") == 0) {
+        return RunService(argc, argv);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--export") == 0) {
+        return RunExport(argc, argv);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--publish") == 0) {
+        return RunPublish(argc, argv);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--generate") == 0) {
+        return RunGenerate(argc, argv);
+    }
+    // start_chain_market --seed seed repeats experiments of previous run, thread stream is seeded too, so node ids
+    // and tree roots are the same
+    uint64_t seed = argc > 2 && std::strcmp(argv[1], "--seed") == 0 ? std::stoull(argv[2]) : std::random_device()();
+    std::cout << "Seed: " << seed << std::endl;
+    SetThreadRandomSeed(seed);
     const auto max_lines = 12;
     for (int i = 1; i < 6; i++) {
         for (int j = 1; j < 6; j++) {
-            auto&& [brute_force_welrafe, algorithm_welrafe] = Experiment(i, j, max_lines - i - j);
-            if (algorithm_welrafe >= brute_force_welrafe) {
-                std::cout << "Success algorithm: " << algorithm_welrafe << " brute_force: " << brute_force_welrafe << std::flush << std::endl;
-            } else {
-                std::cout << "Fail algorithm: " << algorithm_welrafe << " brute_force: " << brute_force_welrafe << std::flush << std::endl;
+            auto experiment_seed = seed++;
+            try {
+                auto&& [brute_force_welrafe, algorithm_welrafe] = Experiment(i, j, max_lines - i - j, experiment_seed);
+                if (algorithm_welrafe >= brute_force_welrafe) {
+                    std::cout << "Success algorithm: " << algorithm_welrafe << " brute_force: " << brute_force_welrafe << std::flush << std::endl;
+                } else {
+                    std::cout << "Fail algorithm: " << algorithm_welrafe << " brute_force: " << brute_force_welrafe << std::flush << std::endl;
+                }
+            } catch (const std::exception& error) {
+                // Market of experiment is repeated by its seed
+                std::cout << "Error in experiment with seed " << experiment_seed << ": " << error.what() << std::flush << std::endl;
             }
         }
     }
@@ -0,0 +1,225 @@
+#include "batch_solver.h"
+#include "algorithm.h"
+#include "brute_force.h"
+#include "market_parser.h"
+#include "shared_market.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+BatchSolverResult BatchSolver::Run(std::istream& in, std::ostream& out) {
+    std::mutex mutex;
+    std::condition_variable tasks_changed, results_changed, in_flight_changed;
+    std::deque<std::pair<int64_t, std::string>> tasks;
+    // Solved requests waiting for earlier ones, by request number
+    std::map<int64_t, std::string> results;
+    int64_t requests_count = 0, errors_count = 0, written_count = 0;
+    bool is_input_end = false;
+
+    auto solve = [&] {
+        while (true) {
+            std::unique_lock<std::mutex> lock(mutex);
+            tasks_changed.wait(lock, [&] { return !tasks.empty() || is_input_end; });
+            if (tasks.empty()) {
+                return;
+            }
+            auto [number, line] = std::move(tasks.front());
+            tasks.pop_front();
+            lock.unlock();
+
+            bool is_error = false;
+            auto result = SolveRequest(line, is_error);
+
+            lock.lock();
+            errors_count += is_error;
+            results.emplace(number, std::move(result));
+            results_changed.notify_one();
+        }
+    };
+    auto write = [&] {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            results_changed.wait(lock, [&] {
+                return results.count(written_count) || (is_input_end && written_count == requests_count);
+            });
+            if (!results.count(written_count)) {
+                return;
+            }
+            auto result = std::move(results[written_count]);
+            results.erase(written_count);
+            lock.unlock();
+            out << result << '\n';
+            lock.lock();
+            written_count++;
+            in_flight_changed.notify_one();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < threads_count_; i++) {
+        threads.emplace_back(solve);
+    }
+    std::thread writer(write);
+
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        in_flight_changed.wait(lock, [&] {
+            return requests_count - written_count < static_cast<int64_t>(max_requests_in_flight_);
+        });
+        tasks.emplace_back(requests_count++, std::move(line));
+        tasks_changed.notify_one();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        is_input_end = true;
+    }
+    tasks_changed.notify_all();
+    results_changed.notify_one();
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+    writer.join();
+    out.flush();
+    return {requests_count, errors_count};
+}
+
+std::string BatchSolver::SolveRequest(std::string_view request_line, bool& is_error) {
+    std::string id = "null";
+    std::string result = ",\"status\":";
+    try {
+        auto request = JsonValue::Parse(request_line);
+        if (auto id_value = request.Find("id")) {
+            id = id_value->ToString();
+        }
+        auto market = LoadRequestMarket(request.At("market"));
+        std::string operation_result;
+        SolveOperation(market, request, operation_result);
+        result += "\"ok\"" + operation_result;
+        is_error = false;
+    } catch (const std::exception& error) {
+        result += "\"error\",\"error\":";
+        WriteJsonString(result, error.what());
+        is_error = true;
+    }
+    return "{\"id\":" + id + result + "}";
+}
+
+StarChainMarket BatchSolver::LoadRequestMarket(const JsonValue& market_request) {
+    if (auto name = market_request.Find("shared")) {
+        return SharedMarket(name->GetString()).CreateWorkspace();
+    }
+    StarChainMarket market;
+    if (auto path = market_request.Find("path")) {
+        market = StarChainMarket::LoadMarket(path->GetString());
+    } else if (auto text = market_request.Find("text")) {
+        market = MarketParser(text->GetString()).Parse();
+    } else {
+        market = BuildInlineMarket(market_request);
+    }
+    if (market.GetNodes().empty()) {
+        throw std::runtime_error("Market has no nodes");
+    }
+    if (!market.IsTree()) {
+        throw std::runtime_error("Market lines must connect all nodes without cycles");
+    }
+    market.BuildTreeMinDepth();
+    return market;
+}
+
+StarChainMarket BatchSolver::BuildInlineMarket(const JsonValue& market_request) {
+    const auto& nodes_request = market_request.At("nodes").GetArray();
+    const auto& lines_request = market_request.At("lines").GetArray();
+    StarChainMarket market;
+    market.Reserve(nodes_request.size(), lines_request.size());
+    std::vector<std::shared_ptr<Node>> nodes;
+    auto read_points = [](const JsonValue& points_request) {
+        std::vector<Point> points;
+        for (auto&& point : points_request.GetArray()) {
+            const auto& coordinates = point.GetArray();
+            if (coordinates.size() != 2) {
+                throw std::runtime_error("Point must be [x, y]");
+            }
+            points.emplace_back(coordinates[0].GetNumber(), coordinates[1].GetNumber());
+        }
+        return points;
+    };
+    for (auto&& node_request : nodes_request) {
+        auto central = node_request.Find("central");
+        auto node = std::make_shared<Node>(PiecewiseLinearFunction(read_points(node_request.At("demand"))),
+                PiecewiseLinearFunction(read_points(node_request.At("supply"))));
+        market.AddNode(node, central && central->GetBool());
+        nodes.push_back(node);
+    }
+    for (auto&& line_request : lines_request) {
+        auto from = line_request.At("from").GetInteger();
+        auto to = line_request.At("to").GetInteger();
+        if (from < 0 || to < 0 || from >= static_cast<int64_t>(nodes.size()) || to >= static_cast<int64_t>(nodes.size())) {
+            throw std::runtime_error("Line node number out of range");
+        }
+        auto type = StrToEdgeType.find(line_request.At("type").GetString());
+        if (type == StrToEdgeType.end()) {
+            throw std::runtime_error("Unknown line type " + line_request.At("type").GetString());
+        }
+        market.AddEdge(std::make_shared<Edge>(line_request.At("et").GetNumber(), line_request.At("Q").GetNumber(),
+                line_request.At("ef").GetNumber(), line_request.At("Ev_coeff").GetNumber(), nodes[from], nodes[to],
+                type->second));
+    }
+    return market;
+}
+
+void BatchSolver::SolveOperation(StarChainMarket& market, const JsonValue& request, std::string& result) {
+    const auto& operation = request.At("operation").GetString();
+    const auto* options = request.Find("options");
+    auto get_option = [&](std::string_view key, bool default_value) {
+        auto option = options ? options->Find(key) : nullptr;
+        return option ? option->GetBool() : default_value;
+    };
+    auto edges = market.GetEdges();
+
+    if (operation == "solve_mask") {
+        const auto& mask = request.At("mask").GetString();
+        if (mask.size() != edges.size() || mask.find_first_not_of("01") != std::string::npos) {
+            throw std::runtime_error("Mask must have 0 or 1 for each of " + std::to_string(edges.size()) + " lines");
+        }
+        for (size_t i = 0; i < edges.size(); i++) {
+            edges[i]->SetAlgorithmType(mask[i] == '1' ? AlgorithmType::L_plus : AlgorithmType::L_minus);
+        }
+    } else if (operation == "algorithm") {
+        AlgorithmOptions algorithm_options;
+        algorithm_options.is_chain_first = get_option("chain_first", false);
+        algorithm_options.use_local_search = get_option("local_search", true);
+        algorithm_options.lines_order_policy = get_option("impact_order", true) ? LinesOrderPolicy::IMPACT :
+                LinesOrderPolicy::FIXED;
+        algorithm_options.is_verbose = false;
+        Algorithm(market, algorithm_options);
+    } else if (operation == "brute_force") {
+        if (get_option("presolve", true)) {
+            market.Presolve();
+        }
+        auto free_lines = market.GetUndefinedEdges();
+        if (free_lines.size() > kMaxBruteForceLinesCount) {
+            throw std::runtime_error("Too many free lines for brute force: " + std::to_string(free_lines.size()));
+        }
+        auto brute_force_result = BruteForce(market, free_lines);
+        result += ",\"configurations_count\":" + std::to_string(brute_force_result.configurations_count);
+        for (size_t i = 0; i < edges.size(); i++) {
+            edges[i]->SetAlgorithmType(brute_force_result.l_plus_lines_mask[i] ? AlgorithmType::L_plus :
+                    AlgorithmType::L_minus);
+        }
+    } else {
+        throw std::runtime_error("Unknown operation " + operation);
+    }
+
+    market.SolveAuxiliarySubtask();
+    result += ",\"welfare\":";
+    WriteJsonNumber(result, market.CalculateWelfare());
+    result += ",\"mask\":\"";
+    for (auto is_l_plus : market.GetLplushLinesMask()) {
+        result.push_back(is_l_plus ? '1' : '0');
+    }
+    result.push_back('"');
+}
@@ -1,32 +1,29 @@
 #include "edge.h"
 
-Edge::Edge(double et, double Q, double ef, double Ev_coeff, std::shared_ptr<Node> from,
+Edge::Edge(long double et, long double Q, long double ef, long double Ev_coeff, std::shared_ptr<Node> from,
         std::shared_ptr<Node> to, EdgeType type)
         :et_(et), Q_(Q), ef_(ef), Ev_coeff_(Ev_coeff), from_(from), to_(to), is_expand_(false), qij_(-1),
          type_(type), algorithm_edge_type_(AlgorithmType::L_undefined) {
-    if (from->GetZeroPrice() > to->GetZeroPrice()) {
-        //throw std::runtime_error("Edge must start in node with zero price less than end");
-    }
     CalcEFunction();
     CalcevFunction();
 }
 
 void Edge::CalcEFunction() {
     if (is_expand_) {
-        E_ = [&](auto&& q)-> double {
-            if (fabs(q) > Q_) {
-                auto val = (fabs(q) - Q_);
-                return ef_ + Ev_coeff_ * val * val + et_ * fabs(q);
+        E_ = [&](auto&& q)-> long double {
+            if (std::fabs(q) > Q_) {
+                auto val = (std::fabs(q) - Q_);
+                return ef_ + Ev_coeff_ * val * val + et_ * std::fabs(q);
             } else {
-                return ef_ + et_ * fabs(q);
+                return ef_ + et_ * std::fabs(q);
             }
         };
     } else {
-        E_ = [&](auto&& q) -> double {
-            if (fabs(q) > Q_) {
+        E_ = [&](auto&& q) -> long double {
+            if (std::fabs(q) > Q_) {
                 throw std::runtime_error("Edge is not expand");
             } else {
-                return et_ * fabs(q);
+                return et_ * std::fabs(q);
             }
         };
     }
@@ -67,6 +64,15 @@ bool Edge::IsExpand() {
     return is_expand_;
 }
 
+void Edge::SetParameters(long double et, long double Q, long double ef, long double Ev_coeff) {
+    et_ = et;
+    Q_ = Q;
+    ef_ = ef;
+    Ev_coeff_ = Ev_coeff;
+    CalcEFunction();
+    CalcevFunction();
+}
+
 void Edge::SetLineExpand() {
     is_expand_ = true;
     CalcEFunction();
@@ -79,11 +85,12 @@ void Edge::SetLineNotExpand() {
     CalcevFunction();
 }
 
-std::shared_ptr<Edge> Edge::GenerateRandomEdge(std::shared_ptr<Node> from, std::shared_ptr<Node> to, EdgeType type) {
-    auto et = GenerateRandomValue(1, 10);
-    auto Q = GenerateRandomValue(1, 10);
-    auto ef = GenerateRandomValue(1, 10);
-    auto Ev_coeff = GenerateRandomValue(1, 10);
+std::shared_ptr<Edge> Edge::GenerateRandomEdge(std::shared_ptr<Node> from, std::shared_ptr<Node> to, EdgeType type,
+        RandomStream& random) {
+    auto et = GenerateRandomValue(1, 10, random);
+    auto Q = GenerateRandomValue(1, 10, random);
+    auto ef = GenerateRandomValue(1, 10, random);
+    auto Ev_coeff = GenerateRandomValue(1, 10, random);
     return std::make_shared<Edge>(et, Q, ef, Ev_coeff, from, to, type);
 }
 
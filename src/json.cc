@@ -0,0 +1,322 @@
+#include "json.h"
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+class JsonParser {
+public:
+    explicit JsonParser(std::string_view text) : text_(text) {}
+
+    JsonValue ParseDocument() {
+        auto value = ParseValue();
+        SkipSpaces();
+        if (pos_ != text_.size()) {
+            Error("end of value expected");
+        }
+        return value;
+    }
+
+private:
+    JsonValue ParseValue() {
+        SkipSpaces();
+        if (pos_ >= text_.size()) {
+            Error("value expected");
+        }
+        switch (text_[pos_]) {
+            case '{':
+                return ParseObject();
+            case '[':
+                return ParseArray();
+            case '"':
+                return ParseString();
+            case 't':
+                ExpectWord("true");
+                return JsonValue(true);
+            case 'f':
+                ExpectWord("false");
+                return JsonValue(false);
+            case 'n':
+                ExpectWord("null");
+                return JsonValue();
+            default:
+                return ParseNumber();
+        }
+    }
+
+    JsonValue ParseObject() {
+        pos_++;
+        JsonValue::Object object;
+        SkipSpaces();
+        if (pos_ < text_.size() && text_[pos_] == '}') {
+            pos_++;
+            return object;
+        }
+        while (true) {
+            SkipSpaces();
+            if (pos_ >= text_.size() || text_[pos_] != '"') {
+                Error("member name expected");
+            }
+            auto key = ParseString();
+            Expect(':');
+            object.emplace_back(std::move(key), ParseValue());
+            SkipSpaces();
+            if (pos_ < text_.size() && text_[pos_] == ',') {
+                pos_++;
+                continue;
+            }
+            Expect('}');
+            return object;
+        }
+    }
+
+    JsonValue ParseArray() {
+        pos_++;
+        JsonValue::Array array;
+        SkipSpaces();
+        if (pos_ < text_.size() && text_[pos_] == ']') {
+            pos_++;
+            return array;
+        }
+        while (true) {
+            array.push_back(ParseValue());
+            SkipSpaces();
+            if (pos_ < text_.size() && text_[pos_] == ',') {
+                pos_++;
+                continue;
+            }
+            Expect(']');
+            return array;
+        }
+    }
+
+    std::string ParseString() {
+        pos_++;
+        std::string result;
+        while (pos_ < text_.size() && text_[pos_] != '"') {
+            auto ch = text_[pos_++];
+            if (ch != '\\') {
+                result.push_back(ch);
+                continue;
+            }
+            if (pos_ >= text_.size()) {
+                break;
+            }
+            ch = text_[pos_++];
+            switch (ch) {
+                case 'b': result.push_back('\b'); break;
+                case 'f': result.push_back('\f'); break;
+                case 'n': result.push_back('\n'); break;
+                case 'r': result.push_back('\r'); break;
+                case 't': result.push_back('\t'); break;
+                case 'u': AppendUtf8(result, ParseHex()); break;
+                default: result.push_back(ch); break;
+            }
+        }
+        if (pos_ >= text_.size()) {
+            Error("end of string expected");
+        }
+        pos_++;
+        return result;
+    }
+
+    uint32_t ParseHex() {
+        uint32_t code = 0;
+        auto [end, error] = std::from_chars(text_.data() + pos_, text_.data() + std::min(pos_ + 4, text_.size()),
+                code, 16);
+        if (error != std::errc() || end != text_.data() + pos_ + 4) {
+            Error("four hex digits expected");
+        }
+        pos_ += 4;
+        return code;
+    }
+
+    static void AppendUtf8(std::string& text, uint32_t code) {
+        if (code < 0x80) {
+            text.push_back(code);
+        } else if (code < 0x800) {
+            text.push_back(0xC0 | (code >> 6));
+            text.push_back(0x80 | (code & 0x3F));
+        } else {
+            text.push_back(0xE0 | (code >> 12));
+            text.push_back(0x80 | ((code >> 6) & 0x3F));
+            text.push_back(0x80 | (code & 0x3F));
+        }
+    }
+
+    JsonValue ParseNumber() {
+        long double value = 0;
+        auto [end, error] = std::from_chars(text_.data() + pos_, text_.data() + text_.size(), value);
+        if (error != std::errc()) {
+            Error("value expected");
+        }
+        pos_ = end - text_.data();
+        return JsonValue(value);
+    }
+
+    void ExpectWord(std::string_view word) {
+        if (text_.substr(pos_, word.size()) != word) {
+            Error("value expected");
+        }
+        pos_ += word.size();
+    }
+
+    void Expect(char ch) {
+        SkipSpaces();
+        if (pos_ >= text_.size() || text_[pos_] != ch) {
+            Error(std::string("'") + ch + "' expected");
+        }
+        pos_++;
+    }
+
+    void SkipSpaces() {
+        while (pos_ < text_.size() && (text_[pos_] == ' ' || text_[pos_] == '\t' || text_[pos_] == '\r'
+                || text_[pos_] == '\n')) {
+            pos_++;
+        }
+    }
+
+    [[noreturn]] void Error(const std::string& message) const {
+        throw std::runtime_error("JSON parse error at column " + std::to_string(pos_ + 1) + ": " + message);
+    }
+
+    std::string_view text_;
+    size_t pos_ = 0;
+};
+
+}
+
+JsonValue JsonValue::Parse(std::string_view text) {
+    return JsonParser(text).ParseDocument();
+}
+
+bool JsonValue::GetBool() const {
+    if (auto value = std::get_if<bool>(&value_)) {
+        return *value;
+    }
+    throw std::runtime_error("JSON bool expected");
+}
+
+long double JsonValue::GetNumber() const {
+    if (auto value = std::get_if<long double>(&value_)) {
+        return *value;
+    }
+    throw std::runtime_error("JSON number expected");
+}
+
+int64_t JsonValue::GetInteger() const {
+    auto value = GetNumber();
+    if (value != std::trunc(value)) {
+        throw std::runtime_error("JSON integer expected");
+    }
+    return static_cast<int64_t>(value);
+}
+
+const std::string& JsonValue::GetString() const {
+    if (auto value = std::get_if<std::string>(&value_)) {
+        return *value;
+    }
+    throw std::runtime_error("JSON string expected");
+}
+
+const JsonValue::Array& JsonValue::GetArray() const {
+    if (auto value = std::get_if<Array>(&value_)) {
+        return *value;
+    }
+    throw std::runtime_error("JSON array expected");
+}
+
+const JsonValue::Object& JsonValue::GetObject() const {
+    if (auto value = std::get_if<Object>(&value_)) {
+        return *value;
+    }
+    throw std::runtime_error("JSON object expected");
+}
+
+const JsonValue* JsonValue::Find(std::string_view key) const {
+    for (auto&& [member_key, member] : GetObject()) {
+        if (member_key == key) {
+            return &member;
+        }
+    }
+    return nullptr;
+}
+
+const JsonValue& JsonValue::At(std::string_view key) const {
+    if (auto member = Find(key)) {
+        return *member;
+    }
+    throw std::runtime_error("JSON member \"" + std::string(key) + "\" expected");
+}
+
+std::string JsonValue::ToString() const {
+    std::string text;
+    Write(text);
+    return text;
+}
+
+void JsonValue::Write(std::string& text) const {
+    if (IsNull()) {
+        text += "null";
+    } else if (auto value = std::get_if<bool>(&value_)) {
+        text += *value ? "true" : "false";
+    } else if (auto value = std::get_if<long double>(&value_)) {
+        WriteJsonNumber(text, *value);
+    } else if (auto value = std::get_if<std::string>(&value_)) {
+        WriteJsonString(text, *value);
+    } else if (auto value = std::get_if<Array>(&value_)) {
+        text.push_back('[');
+        for (size_t i = 0; i < value->size(); i++) {
+            if (i > 0) {
+                text.push_back(',');
+            }
+            (*value)[i].Write(text);
+        }
+        text.push_back(']');
+    } else {
+        auto& object = std::get<Object>(value_);
+        text.push_back('{');
+        for (size_t i = 0; i < object.size(); i++) {
+            if (i > 0) {
+                text.push_back(',');
+            }
+            WriteJsonString(text, object[i].first);
+            text.push_back(':');
+            object[i].second.Write(text);
+        }
+        text.push_back('}');
+    }
+}
+
+void WriteJsonString(std::string& text, std::string_view value) {
+    text.push_back('"');
+    for (auto ch : value) {
+        switch (ch) {
+            case '"': text += "\\\""; break;
+            case '\\': text += "\\\\"; break;
+            case '\n': text += "\\n"; break;
+            case '\r': text += "\\r"; break;
+            case '\t': text += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(ch) < 0x20) {
+                    char code[7];
+                    snprintf(code, sizeof(code), "\\u%04x", ch);
+                    text += code;
+                } else {
+                    text.push_back(ch);
+                }
+        }
+    }
+    text.push_back('"');
+}
+
+void WriteJsonNumber(std::string& text, long double value) {
+    if (!std::isfinite(value)) {
+        text += "null";
+        return;
+    }
+    char buffer[64];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    text.append(buffer, result.ptr);
+}
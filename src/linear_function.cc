@@ -59,15 +59,15 @@ long double LinearFunction::GetCCoeff() const noexcept {
     return c_coeff_;
 }
 
-LinearFunction LinearFunction::GenerateNonIncreasingLinearFunction() {
-    auto a_coeff = GenerateRandomValue<int>(-15, 15);
-    auto b_coeff = GenerateRandomValue<int>(-15, 15);
+LinearFunction LinearFunction::GenerateNonIncreasingLinearFunction(RandomStream& random) {
+    auto a_coeff = GenerateRandomValue<int>(-15, 15, random);
+    auto b_coeff = GenerateRandomValue<int>(-15, 15, random);
     while (b_coeff == 0) {
-        b_coeff = GenerateRandomValue(-15, 15);
+        b_coeff = GenerateRandomValue(-15, 15, random);
     }
-    auto c_coeff = GenerateRandomValue(-15, 15);
+    auto c_coeff = GenerateRandomValue(-15, 15, random);
     if (a_coeff * b_coeff < 0) {
-        if (GenerateRandomValue(0, 100) % 2 == 0) {
+        if (GenerateRandomValue(0, 100, random) % 2 == 0) {
             a_coeff *= -1;
         }
         else {
@@ -77,15 +77,15 @@ LinearFunction LinearFunction::GenerateNonIncreasingLinearFunction() {
     return LinearFunction(a_coeff, b_coeff, c_coeff);
 }
 
-LinearFunction LinearFunction::GenerateNonDecreasingLinearFunction() {
-    auto a_coeff = GenerateRandomValue(-15., 15.);
-    auto b_coeff = GenerateRandomValue(-15., 15.);
+LinearFunction LinearFunction::GenerateNonDecreasingLinearFunction(RandomStream& random) {
+    auto a_coeff = GenerateRandomValue(-15., 15., random);
+    auto b_coeff = GenerateRandomValue(-15., 15., random);
     while (b_coeff == 0) {
-        b_coeff = GenerateRandomValue(-15., 15.);
+        b_coeff = GenerateRandomValue(-15., 15., random);
     }
-    auto c_coeff = GenerateRandomValue(-15., 15.);
+    auto c_coeff = GenerateRandomValue(-15., 15., random);
     if (a_coeff * b_coeff > 0) {
-        if (GenerateRandomValue(0, 100) % 2 == 0) {
+        if (GenerateRandomValue(0, 100, random) % 2 == 0) {
             a_coeff *= -1;
         } else {
             b_coeff *= -1;
@@ -182,14 +182,14 @@ void LinearFunctionDefineOnSegment::ShiftXAxis(long double x) {
 }
 
 LinearFunctionDefineOnSegment LinearFunctionDefineOnSegment::GenerateNonIncreasingLinearFunction(
-        long double x_start, long double x_end) {
-    return LinearFunctionDefineOnSegment(LinearFunction::GenerateNonIncreasingLinearFunction(), x_start,
+        long double x_start, long double x_end, RandomStream& random) {
+    return LinearFunctionDefineOnSegment(LinearFunction::GenerateNonIncreasingLinearFunction(random), x_start,
             x_end);
 }
 
 LinearFunctionDefineOnSegment LinearFunctionDefineOnSegment::GenerateNonDecreasingLinearFunction(
-        long double x_start, long double x_end) {
-    return LinearFunctionDefineOnSegment(LinearFunction::GenerateNonDecreasingLinearFunction(), x_start,
+        long double x_start, long double x_end, RandomStream& random) {
+    return LinearFunctionDefineOnSegment(LinearFunction::GenerateNonDecreasingLinearFunction(random), x_start,
             x_end);
 }
 
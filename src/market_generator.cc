@@ -0,0 +1,280 @@
+#include "market_generator.h"
+#include "market_writer.h"
+#include <cstring>
+#include <sstream>
+
+MarketGenerator::MarketGenerator(MarketGeneratorOptions options) : options_(options) {
+    if (options_.chain_length == 0) {
+        options_.chains_count = 0;
+    }
+    chains_start_ = 1 + options_.import_star_nodes_count + options_.export_star_nodes_count;
+    nodes_count_ = chains_start_ + options_.chains_count * options_.chain_length;
+    if (nodes_count_ < 2) {
+        throw std::runtime_error("Generated market must have lines");
+    }
+    auto central = GetNodeParameters(0);
+    central_zero_price_ = central.d / central.c;
+    // Demand zeroing price 2d/c is at most 20 for central, export star and chain nodes, import star nodes
+    // have zero price more than central by at most 10
+    auto max_demand_zeroing_price = options_.import_star_nodes_count > 0 ? 2 * (10 + central_zero_price_) : 20;
+    domain_end_ = max_demand_zeroing_price + 10;
+}
+
+uint64_t MarketGenerator::GetParent(uint64_t node) const {
+    if (node < chains_start_ || (node - chains_start_) % options_.chain_length == 0) {
+        return 0;
+    }
+    return node - 1;
+}
+
+uint64_t MarketGenerator::GetDegree(uint64_t node) const {
+    if (node == 0) {
+        return chains_start_ - 1 + options_.chains_count;
+    }
+    if (node < chains_start_ || (node - chains_start_ + 1) % options_.chain_length == 0) {
+        return 1;
+    }
+    return 2;
+}
+
+MarketGenerator::NodeParameters MarketGenerator::GetNodeParameters(uint64_t node) const {
+    RandomStream random(options_.seed, node);
+    long double c = GenerateRandomValue<int64_t>(1, 10, random);
+    if (node == 0 || node >= chains_start_) {
+        return {c, c * GenerateRandomValue<int64_t>(1, 10, random)};
+    }
+    if (node <= options_.import_star_nodes_count) {
+        return {c, (GenerateRandomValue<int64_t>(1, 10, random) + central_zero_price_) * c};
+    }
+    return {c, c * GenerateRandomValue<int64_t>(1, static_cast<int64_t>(central_zero_price_), random)};
+}
+
+MarketGenerator::LineParameters MarketGenerator::GetLineParameters(uint64_t node) const {
+    RandomStream random(options_.seed, node);
+    // Line parameters follow node parameters in stream of node
+    GenerateRandomValue<int64_t>(1, 10, random);
+    GenerateRandomValue<int64_t>(1, 10, random);
+    LineParameters line;
+    auto parent = GetParent(node);
+    if (node < chains_start_) {
+        auto is_import = node <= options_.import_star_nodes_count;
+        line.from = is_import ? parent : node;
+        line.to = is_import ? node : parent;
+        line.type = is_import ? EdgeType::STAR_FROM_CENTER : EdgeType::STAR_TO_CENTER;
+    } else {
+        auto parameters = GetNodeParameters(node);
+        auto parent_parameters = GetNodeParameters(parent);
+        auto is_from_center = parameters.d / parameters.c > parent_parameters.d / parent_parameters.c;
+        line.from = is_from_center ? parent : node;
+        line.to = is_from_center ? node : parent;
+        line.type = is_from_center ? EdgeType::CHAIN_FROM_CENTER : EdgeType::CHAIN_TO_CENTER;
+    }
+    line.et = GenerateRandomValue<int64_t>(1, 10, random);
+    line.Q = GenerateRandomValue<int64_t>(1, 10, random);
+    line.ef = GenerateRandomValue<int64_t>(1, 10, random);
+    line.Ev_coeff = GenerateRandomValue<int64_t>(1, 10, random);
+    return line;
+}
+
+/*
+ * Same curves as CreateSpFunction and CreateDpFunction with domain up to domain end
+ */
+std::vector<Point> MarketGenerator::GetSupplyPoints(const NodeParameters& parameters) const {
+    auto demand_zeroing_price = 2 * parameters.d / parameters.c;
+    return {Point(0, 0), Point(demand_zeroing_price, parameters.d),
+            Point(domain_end_, parameters.c * domain_end_ - parameters.d)};
+}
+
+std::vector<Point> MarketGenerator::GetDemandPoints(const NodeParameters& parameters) const {
+    auto demand_zeroing_price = 2 * parameters.d / parameters.c;
+    return {Point(0, parameters.d), Point(demand_zeroing_price, 0), Point(domain_end_, 0)};
+}
+
+template<typename Format>
+void MarketGenerator::WriteBlocks(std::ostream& os, uint64_t count, Format&& format) const {
+    auto threads_count = std::max<size_t>(1, options_.threads_count);
+    auto block_size = std::max<size_t>(1, options_.block_size);
+    std::vector<std::string> blocks(threads_count);
+    for (uint64_t start = 0; start < count; start += threads_count * block_size) {
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < threads_count; i++) {
+            auto begin = std::min(count, start + i * block_size);
+            auto end = std::min(count, begin + block_size);
+            blocks[i].clear();
+            if (begin == end) {
+                continue;
+            }
+            if (threads_count == 1) {
+                format(begin, end, blocks[i]);
+            } else {
+                threads.emplace_back([&format, &blocks, i, begin, end] {
+                    format(begin, end, blocks[i]);
+                });
+            }
+        }
+        for (auto&& thread : threads) {
+            thread.join();
+        }
+        for (auto&& block : blocks) {
+            os.write(block.data(), block.size());
+        }
+    }
+}
+
+void MarketGenerator::WriteText(std::ostream& os) const {
+    {
+        MarketWriter writer(os);
+        writer.WriteHeader(nodes_count_, GetLinesCount());
+    }
+    WriteBlocks(os, nodes_count_, [&](uint64_t begin, uint64_t end, std::string& block) {
+        std::ostringstream stream;
+        MarketWriter writer(stream);
+        for (auto node = begin; node < end; node++) {
+            auto parameters = GetNodeParameters(node);
+            writer.WriteNode(node, node == 0, GetSupplyPoints(parameters), GetDemandPoints(parameters));
+        }
+        writer.Flush();
+        block = stream.str();
+    });
+    WriteBlocks(os, GetLinesCount(), [&](uint64_t begin, uint64_t end, std::string& block) {
+        std::ostringstream stream;
+        MarketWriter writer(stream);
+        for (auto line_number = begin; line_number < end; line_number++) {
+            auto line = GetLineParameters(line_number + 1);
+            writer.WriteLine(line.from, line.to, line.type, line.et, line.Q, line.ef, line.Ev_coeff);
+        }
+        writer.Flush();
+        block = stream.str();
+    });
+}
+
+void MarketGenerator::WriteBinary(std::ostream& os) const {
+    auto lines_count = GetLinesCount();
+    // Each function has 3 breakpoints
+    auto header = MarketSnapshot::CreateHeader(nodes_count_, lines_count, 6 * nodes_count_, 0);
+    uint64_t written = 0;
+    auto pad = [&](uint64_t offset, uint64_t section_size) {
+        static const char kPadding[64] = {};
+        while (written < offset) {
+            auto size = std::min<uint64_t>(sizeof(kPadding), offset - written);
+            os.write(kPadding, size);
+            written += size;
+        }
+        written += section_size;
+    };
+    auto append = [](std::string& block, const auto& value) {
+        block.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+
+    pad(0, sizeof(header));
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    pad(header.point_offsets_offset, (2 * nodes_count_ + 1) * sizeof(uint64_t));
+    WriteBlocks(os, 2 * nodes_count_ + 1, [&](uint64_t begin, uint64_t end, std::string& block) {
+        for (auto i = begin; i < end; i++) {
+            append(block, uint64_t(3 * i));
+        }
+    });
+
+    pad(header.points_offset, header.points_count * sizeof(MarketSnapshot::PointRecord));
+    WriteBlocks(os, nodes_count_, [&](uint64_t begin, uint64_t end, std::string& block) {
+        MarketSnapshot::PointRecord record;
+        std::memset(&record, 0, sizeof(record));
+        for (auto node = begin; node < end; node++) {
+            auto parameters = GetNodeParameters(node);
+            for (auto&& points : {GetSupplyPoints(parameters), GetDemandPoints(parameters)}) {
+                for (auto&& point : points) {
+                    record.x = point.x_coord_;
+                    record.y = point.y_coord_;
+                    append(block, record);
+                }
+            }
+        }
+    });
+
+    pad(header.edges_offset, lines_count * sizeof(MarketSnapshot::EdgeRecord));
+    WriteBlocks(os, lines_count, [&](uint64_t begin, uint64_t end, std::string& block) {
+        MarketSnapshot::EdgeRecord record;
+        std::memset(&record, 0, sizeof(record));
+        for (auto line_number = begin; line_number < end; line_number++) {
+            auto line = GetLineParameters(line_number + 1);
+            record.from = line.from;
+            record.to = line.to;
+            record.type = static_cast<uint32_t>(line.type);
+            record.et = line.et;
+            record.Q = line.Q;
+            record.ef = line.ef;
+            record.Ev_coeff = line.Ev_coeff;
+            append(block, record);
+        }
+    });
+
+    // Lines of nodes before node: every node before has line to parent, chain nodes before which are not
+    // last in chain have line to child, and central node has lines to its children
+    auto adjacency_offset = [&](uint64_t node) -> uint64_t {
+        if (node == 0) {
+            return 0;
+        }
+        auto chain_nodes = node > chains_start_ ? node - chains_start_ : 0;
+        return GetDegree(0) + (node - 1) + chain_nodes - chain_nodes / std::max<uint64_t>(1, options_.chain_length);
+    };
+    pad(header.adjacency_offsets_offset, (nodes_count_ + 1) * sizeof(uint64_t));
+    WriteBlocks(os, nodes_count_ + 1, [&](uint64_t begin, uint64_t end, std::string& block) {
+        for (auto node = begin; node < end; node++) {
+            append(block, adjacency_offset(node));
+        }
+    });
+
+    // Lines of node in increasing order: central node has lines of star nodes and first chain nodes, other
+    // node has line to parent and line to child in chain
+    pad(header.adjacency_offset, 2 * lines_count * sizeof(uint64_t));
+    WriteBlocks(os, 2 * lines_count, [&](uint64_t begin, uint64_t end, std::string& block) {
+        uint64_t node = 0;
+        uint64_t node_end = nodes_count_;
+        while (node + 1 < node_end) {
+            auto middle = (node + node_end) / 2;
+            if (adjacency_offset(middle) <= begin) {
+                node = middle;
+            } else {
+                node_end = middle;
+            }
+        }
+        for (auto pos = begin; pos < end; node++) {
+            auto node_offset = adjacency_offset(node);
+            for (auto i = pos - node_offset; i < GetDegree(node) && pos < end; i++, pos++) {
+                if (node == 0) {
+                    auto stars_count = chains_start_ - 1;
+                    append(block, uint64_t(i < stars_count ? i :
+                            chains_start_ + (i - stars_count) * options_.chain_length - 1));
+                } else {
+                    append(block, uint64_t(node - 1 + i));
+                }
+            }
+        }
+    });
+    pad(header.file_size, 0);
+}
+
+StarChainMarket MarketGenerator::Generate() const {
+    StarChainMarket market;
+    market.Reserve(nodes_count_, GetLinesCount());
+    std::vector<std::shared_ptr<Node>> nodes;
+    nodes.reserve(nodes_count_);
+    std::vector<size_t> degrees;
+    degrees.reserve(nodes_count_);
+    for (uint64_t i = 0; i < nodes_count_; i++) {
+        auto parameters = GetNodeParameters(i);
+        auto node = std::make_shared<Node>(PiecewiseLinearFunction(GetDemandPoints(parameters)),
+                PiecewiseLinearFunction(GetSupplyPoints(parameters)));
+        market.AddNode(node, i == 0);
+        nodes.push_back(node);
+        degrees.push_back(GetDegree(i));
+    }
+    market.ReserveAdjacency(degrees);
+    for (uint64_t i = 1; i < nodes_count_; i++) {
+        auto line = GetLineParameters(i);
+        market.AddEdge(std::make_shared<Edge>(line.et, line.Q, line.ef, line.Ev_coeff, nodes[line.from],
+                nodes[line.to], line.type));
+    }
+    return market;
+}
@@ -0,0 +1,154 @@
+#include "market_parser.h"
+#include "mapped_file.h"
+#include <charconv>
+
+StarChainMarket MarketParser::Parse() {
+    auto nodes_count = ReadInteger("nodes count");
+    auto edges_count = ReadInteger("lines count");
+    if (nodes_count < 0 || edges_count < 0) {
+        Error("counts must be non negative");
+    }
+
+    StarChainMarket market;
+    market.Reserve(nodes_count, edges_count);
+    std::vector<std::shared_ptr<Node>> nodes;
+    nodes.reserve(nodes_count);
+    std::vector<Point> supply_points, demand_points;
+    for (int64_t node_number = 0; node_number < nodes_count; node_number++) {
+        if (ReadInteger("node number") != node_number) {
+            Error("node number " + std::to_string(node_number) + " expected");
+        }
+        bool is_central_market_node = ReadInteger("central node flag") != 0;
+        ReadPoints(supply_points, "supply point");
+        ReadPoints(demand_points, "demand point");
+        auto node = std::make_shared<Node>(PiecewiseLinearFunction(demand_points),
+                PiecewiseLinearFunction(supply_points));
+        market.AddNode(node, is_central_market_node);
+        nodes.push_back(node);
+    }
+
+    std::vector<LineRecord> lines;
+    lines.reserve(edges_count);
+    std::vector<size_t> degrees(nodes_count, 0);
+    for (int64_t edge_number = 0; edge_number < edges_count; edge_number++) {
+        LineRecord line;
+        line.from = ReadNodeNumber(nodes_count, "line start node");
+        line.to = ReadNodeNumber(nodes_count, "line end node");
+        line.type = ReadEdgeType();
+        line.et = ReadNumber("et");
+        line.Q = ReadNumber("Q");
+        line.ef = ReadNumber("ef");
+        line.Ev_coeff = ReadNumber("Ev_coeff");
+        degrees[line.from]++;
+        degrees[line.to]++;
+        lines.push_back(line);
+    }
+    SkipSpaces();
+    if (pos_ != text_.size()) {
+        Error("end of market expected");
+    }
+
+    market.ReserveAdjacency(degrees);
+    for (auto&& line : lines) {
+        market.AddEdge(std::make_shared<Edge>(line.et, line.Q, line.ef, line.Ev_coeff, nodes[line.from],
+                nodes[line.to], line.type));
+    }
+    return market;
+}
+
+StarChainMarket MarketParser::ParseFile(const std::string& path) {
+    MappedFile file(path);
+    return MarketParser(file.GetData()).Parse();
+}
+
+void MarketParser::SkipSpaces(bool skip_line_ends) {
+    while (pos_ < text_.size()) {
+        auto ch = text_[pos_];
+        if (ch == '\n' && skip_line_ends) {
+            line_number_++;
+            line_start_ = pos_ + 1;
+        } else if (ch != ' ' && ch != '\t' && ch != '\r') {
+            return;
+        }
+        pos_++;
+    }
+}
+
+int64_t MarketParser::ReadInteger(const char* what) {
+    SkipSpaces();
+    int64_t value = 0;
+    auto [end, error] = std::from_chars(text_.data() + pos_, text_.data() + text_.size(), value);
+    if (error != std::errc()) {
+        Error(std::string(what) + " expected");
+    }
+    pos_ = end - text_.data();
+    return value;
+}
+
+int64_t MarketParser::ReadNodeNumber(int64_t nodes_count, const char* what) {
+    SkipSpaces();
+    auto start = pos_;
+    auto node_number = ReadInteger(what);
+    if (node_number < 0 || node_number >= nodes_count) {
+        pos_ = start;
+        Error(std::string(what) + " out of range");
+    }
+    return node_number;
+}
+
+long double MarketParser::ReadNumber(const char* what) {
+    SkipSpaces();
+    long double value = 0;
+    auto [end, error] = std::from_chars(text_.data() + pos_, text_.data() + text_.size(), value);
+    if (error != std::errc()) {
+        Error(std::string(what) + " expected");
+    }
+    pos_ = end - text_.data();
+    return value;
+}
+
+void MarketParser::ReadPoints(std::vector<Point>& points, const char* what) {
+    points.clear();
+    SkipSpaces();
+    while (pos_ < text_.size() && text_[pos_] != '\n') {
+        Expect('(', what);
+        auto x = ReadNumber(what);
+        Expect(',', what);
+        auto y = ReadNumber(what);
+        Expect(')', what);
+        points.emplace_back(x, y);
+        SkipSpaces(false);
+    }
+    if (points.empty()) {
+        Error(std::string(what) + " expected");
+    }
+}
+
+EdgeType MarketParser::ReadEdgeType() {
+    SkipSpaces();
+    auto start = pos_;
+    while (pos_ < text_.size() && (isalpha(text_[pos_]) || text_[pos_] == '_')) {
+        pos_++;
+    }
+    auto text = text_.substr(start, pos_ - start);
+    for (size_t i = 0; i < EdgeTypeText.size(); i++) {
+        if (text == EdgeTypeText[i]) {
+            return static_cast<EdgeType>(i);
+        }
+    }
+    pos_ = start;
+    Error("line type expected");
+}
+
+void MarketParser::Expect(char ch, const char* what) {
+    SkipSpaces(false);
+    if (pos_ >= text_.size() || text_[pos_] != ch) {
+        Error(std::string("'") + ch + "' in " + what + " expected");
+    }
+    pos_++;
+}
+
+void MarketParser::Error(const std::string& message) const {
+    throw std::runtime_error("Market parse error at line " + std::to_string(line_number_) + " column " +
+            std::to_string(pos_ - line_start_ + 1) + ": " + message);
+}
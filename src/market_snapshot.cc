@@ -0,0 +1,182 @@
+#include "market_snapshot.h"
+#include "mapped_file.h"
+#include <cfloat>
+#include <cstring>
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "Market snapshot is little endian");
+
+void MarketSnapshot::Store(std::ostream& os, StarChainMarket& market) {
+    auto nodes = market.GetNodes();
+    auto edges = market.GetEdges();
+
+    std::vector<uint64_t> point_offsets{0};
+    std::vector<PointRecord> points;
+    // Padding bytes of long double are zeroed, so the same market is stored to the same bytes
+    PointRecord record;
+    std::memset(&record, 0, sizeof(record));
+    for (auto&& node : nodes) {
+        for (auto&& func : {node->GetS(), node->GetD()}) {
+            for (auto&& point : func.GetPoints()) {
+                record.x = point.x_coord_;
+                record.y = point.y_coord_;
+                points.push_back(record);
+            }
+            point_offsets.push_back(points.size());
+        }
+    }
+
+    std::vector<EdgeRecord> edge_records(edges.size());
+    std::memset(edge_records.data(), 0, edge_records.size() * sizeof(EdgeRecord));
+    std::vector<uint64_t> adjacency_offsets(nodes.size() + 1, 0);
+    for (size_t i = 0; i < edges.size(); i++) {
+        auto& record = edge_records[i];
+        record.from = market.GetVectorPosByNode(edges[i]->GetStartNode());
+        record.to = market.GetVectorPosByNode(edges[i]->GetEndNode());
+        record.type = static_cast<uint32_t>(edges[i]->GetEdgeType());
+        record.et = edges[i]->Getet();
+        record.Q = edges[i]->GetQ();
+        record.ef = edges[i]->Getef();
+        record.Ev_coeff = edges[i]->GetEvCoeff();
+        adjacency_offsets[record.from + 1]++;
+        adjacency_offsets[record.to + 1]++;
+    }
+    for (size_t i = 0; i < nodes.size(); i++) {
+        adjacency_offsets[i + 1] += adjacency_offsets[i];
+    }
+    std::vector<uint64_t> adjacency(2 * edges.size());
+    auto next_pos = adjacency_offsets;
+    for (size_t i = 0; i < edges.size(); i++) {
+        adjacency[next_pos[edge_records[i].from]++] = i;
+        adjacency[next_pos[edge_records[i].to]++] = i;
+    }
+
+    uint64_t central_node = nodes.size();
+    for (size_t i = 0; i < nodes.size(); i++) {
+        if (market.IsCentralNode(nodes[i])) {
+            central_node = i;
+        }
+    }
+    auto header = CreateHeader(nodes.size(), edges.size(), points.size(), central_node);
+
+    uint64_t written = 0;
+    auto write = [&](uint64_t offset, const void* data, uint64_t size) {
+        static const char kPadding[kAlignment] = {};
+        os.write(kPadding, offset - written);
+        os.write(static_cast<const char*>(data), size);
+        written = offset + size;
+    };
+    write(0, &header, sizeof(header));
+    write(header.point_offsets_offset, point_offsets.data(), point_offsets.size() * sizeof(uint64_t));
+    write(header.points_offset, points.data(), points.size() * sizeof(PointRecord));
+    write(header.edges_offset, edge_records.data(), edge_records.size() * sizeof(EdgeRecord));
+    write(header.adjacency_offsets_offset, adjacency_offsets.data(), adjacency_offsets.size() * sizeof(uint64_t));
+    write(header.adjacency_offset, adjacency.data(), adjacency.size() * sizeof(uint64_t));
+    write(header.file_size, nullptr, 0);
+}
+
+MarketSnapshot::Header MarketSnapshot::CreateHeader(uint64_t nodes_count, uint64_t edges_count,
+        uint64_t points_count, uint64_t central_node) {
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.number_size = sizeof(long double);
+    header.mantissa_digits = LDBL_MANT_DIG;
+    header.nodes_count = nodes_count;
+    header.edges_count = edges_count;
+    header.points_count = points_count;
+    header.central_node = central_node;
+    header.point_offsets_offset = Align(sizeof(Header));
+    header.points_offset = Align(header.point_offsets_offset + (2 * nodes_count + 1) * sizeof(uint64_t));
+    header.edges_offset = Align(header.points_offset + points_count * sizeof(PointRecord));
+    header.adjacency_offsets_offset = Align(header.edges_offset + edges_count * sizeof(EdgeRecord));
+    header.adjacency_offset = Align(header.adjacency_offsets_offset + (nodes_count + 1) * sizeof(uint64_t));
+    header.file_size = Align(header.adjacency_offset + 2 * edges_count * sizeof(uint64_t));
+    return header;
+}
+
+template<typename T>
+const T* MarketSnapshot::GetSection(std::string_view data, uint64_t offset, uint64_t count) {
+    if (offset % alignof(T) != 0 || offset > data.size() || count > (data.size() - offset) / sizeof(T)) {
+        throw std::runtime_error("Market snapshot section out of file");
+    }
+    return reinterpret_cast<const T*>(data.data() + offset);
+}
+
+StarChainMarket MarketSnapshot::Load(std::string_view data, std::vector<std::shared_ptr<Node>> nodes) {
+    if (reinterpret_cast<uintptr_t>(data.data()) % kAlignment != 0) {
+        throw std::runtime_error("Market snapshot must be aligned");
+    }
+    const auto& header = *GetSection<Header>(data, 0, 1);
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+        throw std::runtime_error("Not a market snapshot");
+    }
+    if (header.version != kVersion) {
+        throw std::runtime_error("Unsupported market snapshot version " + std::to_string(header.version));
+    }
+    if (header.number_size != sizeof(long double) || header.mantissa_digits != LDBL_MANT_DIG) {
+        throw std::runtime_error("Market snapshot has another long double format");
+    }
+    if (header.file_size != data.size()) {
+        throw std::runtime_error("Market snapshot is truncated");
+    }
+    auto nodes_count = header.nodes_count;
+    auto edges_count = header.edges_count;
+    auto is_nodes_given = !nodes.empty();
+    if (is_nodes_given && nodes.size() != nodes_count) {
+        throw std::runtime_error("Nodes count differs from market snapshot nodes count");
+    }
+    auto point_offsets = GetSection<uint64_t>(data, header.point_offsets_offset, 2 * nodes_count + 1);
+    auto points = GetSection<PointRecord>(data, header.points_offset, header.points_count);
+    auto edge_records = GetSection<EdgeRecord>(data, header.edges_offset, edges_count);
+    auto adjacency_offsets = GetSection<uint64_t>(data, header.adjacency_offsets_offset, nodes_count + 1);
+    GetSection<uint64_t>(data, header.adjacency_offset, 2 * edges_count);
+
+    StarChainMarket market;
+    market.Reserve(nodes_count, edges_count);
+    nodes.reserve(nodes_count);
+    std::vector<Point> supply_points, demand_points;
+    auto read_points = [&](size_t func_pos, std::vector<Point>& func_points) {
+        auto start = point_offsets[func_pos];
+        auto end = point_offsets[func_pos + 1];
+        if (start > end || end > header.points_count) {
+            throw std::runtime_error("Market snapshot breakpoints out of range");
+        }
+        func_points.clear();
+        for (auto i = start; i < end; i++) {
+            func_points.emplace_back(points[i].x, points[i].y);
+        }
+    };
+    for (uint64_t i = 0; i < nodes_count; i++) {
+        if (!is_nodes_given) {
+            read_points(2 * i, supply_points);
+            read_points(2 * i + 1, demand_points);
+            nodes.push_back(std::make_shared<Node>(PiecewiseLinearFunction(demand_points),
+                    PiecewiseLinearFunction(supply_points)));
+        }
+        market.AddNode(nodes[i], i == header.central_node);
+    }
+
+    std::vector<size_t> degrees(nodes_count);
+    for (uint64_t i = 0; i < nodes_count; i++) {
+        if (adjacency_offsets[i] > adjacency_offsets[i + 1] || adjacency_offsets[i + 1] > 2 * edges_count) {
+            throw std::runtime_error("Market snapshot lines of node out of range");
+        }
+        degrees[i] = adjacency_offsets[i + 1] - adjacency_offsets[i];
+    }
+    market.ReserveAdjacency(degrees);
+    for (uint64_t i = 0; i < edges_count; i++) {
+        const auto& record = edge_records[i];
+        if (record.from >= nodes_count || record.to >= nodes_count || record.type >= EdgeTypeText.size()) {
+            throw std::runtime_error("Market snapshot line " + std::to_string(i) + " is invalid");
+        }
+        market.AddEdge(std::make_shared<Edge>(record.et, record.Q, record.ef, record.Ev_coeff, nodes[record.from],
+                nodes[record.to], static_cast<EdgeType>(record.type)));
+    }
+    return market;
+}
+
+StarChainMarket MarketSnapshot::LoadFile(const std::string& path) {
+    MappedFile file(path);
+    return Load(file.GetData());
+}
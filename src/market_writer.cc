@@ -0,0 +1,100 @@
+#include "market_writer.h"
+#include <charconv>
+
+void MarketWriter::Write(const StarChainMarket& market) {
+    auto nodes = market.GetNodes();
+    auto edges = market.GetEdges();
+    WriteHeader(nodes.size(), edges.size());
+    for (size_t node_number = 0; node_number < nodes.size(); node_number++) {
+        WriteNode(node_number, market.IsCentralNode(nodes[node_number]), nodes[node_number]->GetS().GetPoints(),
+                nodes[node_number]->GetD().GetPoints());
+    }
+    for (auto&& edge : edges) {
+        WriteLine(market.GetVectorPosByNode(edge->GetStartNode()), market.GetVectorPosByNode(edge->GetEndNode()),
+                edge->GetEdgeType(), edge->Getet(), edge->GetQ(), edge->Getef(), edge->GetEvCoeff());
+    }
+    Flush();
+}
+
+void MarketWriter::WriteHeader(uint64_t nodes_count, uint64_t edges_count) {
+    WriteInteger(nodes_count);
+    WriteChar(' ');
+    WriteInteger(edges_count);
+    WriteChar('\n');
+}
+
+void MarketWriter::WriteNode(uint64_t node_number, bool is_central, const std::vector<Point>& supply_points,
+        const std::vector<Point>& demand_points) {
+    WriteInteger(node_number);
+    WriteChar(' ');
+    WriteInteger(is_central);
+    WriteChar('\n');
+    WritePoints(supply_points);
+    WritePoints(demand_points);
+}
+
+void MarketWriter::WriteLine(uint64_t from, uint64_t to, EdgeType type, long double et, long double Q, long double ef,
+        long double Ev_coeff) {
+    WriteInteger(from);
+    WriteChar(' ');
+    WriteInteger(to);
+    WriteChar(' ');
+    WriteText(EdgeTypeText[static_cast<int>(type)]);
+    WriteChar('\n');
+    WriteNumber(et);
+    WriteChar(' ');
+    WriteNumber(Q);
+    WriteChar(' ');
+    WriteNumber(ef);
+    WriteChar(' ');
+    WriteNumber(Ev_coeff);
+    WriteChar('\n');
+}
+
+void MarketWriter::Flush() {
+    os_.write(buffer_.data(), size_);
+    size_ = 0;
+}
+
+void MarketWriter::WriteNumber(long double value) {
+    Reserve();
+    auto result = std::to_chars(buffer_.data() + size_, buffer_.data() + buffer_.size(), value);
+    size_ = result.ptr - buffer_.data();
+}
+
+void MarketWriter::WriteInteger(int64_t value) {
+    Reserve();
+    auto result = std::to_chars(buffer_.data() + size_, buffer_.data() + buffer_.size(), value);
+    size_ = result.ptr - buffer_.data();
+}
+
+void MarketWriter::WriteChar(char ch) {
+    Reserve();
+    buffer_[size_++] = ch;
+}
+
+void MarketWriter::WriteText(std::string_view text) {
+    Reserve();
+    std::copy(text.begin(), text.end(), buffer_.data() + size_);
+    size_ += text.size();
+}
+
+void MarketWriter::WritePoints(const std::vector<Point>& points) {
+    for (size_t i = 0; i < points.size(); i++) {
+        if (i > 0) {
+            WriteChar(' ');
+        }
+        WriteChar('(');
+        WriteNumber(points[i].x_coord_);
+        WriteChar(',');
+        WriteNumber(points[i].y_coord_);
+        WriteChar(')');
+    }
+    WriteChar('\n');
+}
+
+void MarketWriter::Reserve() {
+    if (buffer_.size() - size_ < kMaxTokenSize) {
+        Flush();
+    }
+}
@@ -1,10 +1,16 @@
 #include "node.h"
+#include <atomic>
 
 Node::Node(PiecewiseLinearFunction D, PiecewiseLinearFunction S)
 : D_(D), S_(S), delta_S_(S_ - D_), vs_(-1), vd_(-1), p_(-1), is_leaf_(false) {
     GenerateNewUniqueId();
 }
 
+Node::Node(PiecewiseLinearFunction D, PiecewiseLinearFunction S, PiecewiseLinearFunction delta_S)
+: D_(std::move(D)), S_(std::move(S)), delta_S_(std::move(delta_S)), vs_(-1), vd_(-1), p_(-1), is_leaf_(false) {
+    GenerateNewUniqueId();
+}
+
 bool Node::operator==(const Node& other) const {
     return unique_id_ == other.unique_id_;
 }
@@ -21,6 +27,13 @@ PiecewiseLinearFunction Node::GetDeltaS() {
     return delta_S_;
 }
 
+void Node::SetFunctions(PiecewiseLinearFunction D, PiecewiseLinearFunction S) {
+    D_ = std::move(D);
+    S_ = std::move(S);
+    delta_S_ = S_ - D_;
+    zero_price_.reset();
+}
+
 PiecewiseLinearFunction Node::GetDeltaSDash() {
     return delta_S_dash_;
 }
@@ -34,7 +47,8 @@ void Node::SetDepth(size_t depth) {
 }
 
 void Node::GenerateNewUniqueId() noexcept {
-    unique_id_ = GenerateRandomValue<int64_t>(1, kINF);
+    static std::atomic<int64_t> next_unique_id{1};
+    unique_id_ = next_unique_id.fetch_add(1, std::memory_order_relaxed);
 }
 
 std::shared_ptr<Node> Node::GenerateRandomNode(long double c, long double d) {
@@ -45,17 +59,17 @@ std::shared_ptr<Node> Node::GenerateRandomNode(long double c, long double d) {
 /*
  * d / c > p
  */
-std::shared_ptr<Node> Node::GenerateRandomNodeWithZeroPriceMoreThan(long double p) {
-    auto c = GenerateRandomValue<int64_t>(1, 10);
-    auto d = GenerateRandomValue<int64_t>(1, 10);
+std::shared_ptr<Node> Node::GenerateRandomNodeWithZeroPriceMoreThan(long double p, RandomStream& random) {
+    auto c = GenerateRandomValue<int64_t>(1, 10, random);
+    auto d = GenerateRandomValue<int64_t>(1, 10, random);
     return GenerateRandomNode(c, (d + p) * c);
 }
 
 /*
  * d / c < p
  */
-std::shared_ptr<Node> Node::GenerateRandomNodeWithZeroPriceLessThan(long double p) {
-    auto c = GenerateRandomValue<int64_t>(1, 10);
-    auto d = GenerateRandomValue<int64_t>(1, p);
+std::shared_ptr<Node> Node::GenerateRandomNodeWithZeroPriceLessThan(long double p, RandomStream& random) {
+    auto c = GenerateRandomValue<int64_t>(1, 10, random);
+    auto d = GenerateRandomValue<int64_t>(1, p, random);
     return GenerateRandomNode(c, d * c);
 }
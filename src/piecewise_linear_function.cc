@@ -4,12 +4,13 @@
 #include <cassert>
 
 PiecewiseLinearFunction::PiecewiseLinearFunction(std::vector<LinearFunctionDefineOnSegment> functions, Segment function_domain)
-        : functions_(std::move(functions)), function_domain_(function_domain) {
-    std::sort(functions_.begin(), functions_.end(), [&](auto&& lhs, auto&& rhs) {
+        : function_domain_(function_domain) {
+    std::sort(functions.begin(), functions.end(), [&](auto&& lhs, auto&& rhs) {
         return lhs.GetXStartCoordinate() < rhs.GetXStartCoordinate() ||
             (lhs.GetXStartCoordinate() == rhs.GetXStartCoordinate() &&
                     lhs.IsVertical());
     });
+    functions_ = std::move(functions);
     ValidateFunctions();
 }
 
@@ -19,18 +20,27 @@ PiecewiseLinearFunction::PiecewiseLinearFunction(std::vector<Point> points) {
     });
     function_domain_.SetStart(points[0].x_coord_);
     function_domain_.SetEnd(points.back().x_coord_);
+    auto& functions = functions_.GetMutable();
     for (size_t i = 1; i < points.size(); i++) {
         if (points[i - 1].x_coord_ == points[i].x_coord_) {
-            functions_.emplace_back(points[i - 1].y_coord_, points[i].y_coord_, points[i].x_coord_);
+            functions.emplace_back(points[i - 1].y_coord_, points[i].y_coord_, points[i].x_coord_);
         } else {
-            functions_.emplace_back(points[i - 1], points[i]);
+            functions.emplace_back(points[i - 1], points[i]);
         }
     }
     ValidateFunctions();
 }
 
+PiecewiseLinearFunction::PiecewiseLinearFunction(LinearFunctionsStorage functions) : functions_(std::move(functions)) {
+    if (functions_.empty()) {
+        throw std::runtime_error("Function without segments");
+    }
+    function_domain_ = Segment(functions_[0].GetXStartCoordinate(), functions_.back().GetXEndCoordinate());
+    ValidateFunctions();
+}
+
 void PiecewiseLinearFunction::Shift(long double x) {
-    for (auto& func : functions_) {
+    for (auto& func : functions_.GetMutable()) {
         func.Shift(x);
     }
 }
@@ -62,7 +72,7 @@ PiecewiseLinearFunction PiecewiseLinearFunction::GetInverseFunction() const {
 
 PiecewiseLinearFunction PiecewiseLinearFunction::MirrorXAndY() const noexcept {
     Segment function_domain(-function_domain_.GetEnd(), -function_domain_.GetStart());
-    decltype(functions_) functions;
+    std::vector<LinearFunctionDefineOnSegment> functions;
     for (auto&& func : functions_) {
         functions.push_back(func.MirrorXAndY());
     }
@@ -70,6 +80,21 @@ PiecewiseLinearFunction PiecewiseLinearFunction::MirrorXAndY() const noexcept {
 }
 
 
+PiecewiseLinearFunction PiecewiseLinearFunction::RemoveEmptySegments() const {
+    std::vector<LinearFunctionDefineOnSegment> functions;
+    for (auto&& func : functions_) {
+        auto is_empty = fabs(func.GetXEndCoordinate() - func.GetXStartCoordinate()) < kEPS
+                && fabs(func.GetValueAtEndPoint().GetEnd() - func.GetValueAtStartPoint().GetStart()) < kEPS;
+        if (!is_empty) {
+            functions.push_back(func);
+        }
+    }
+    if (functions.empty()) {
+        functions.push_back(functions_[0]);
+    }
+    return PiecewiseLinearFunction(functions, function_domain_);
+}
+
 PiecewiseLinearFunction PiecewiseLinearFunction::operator+(PiecewiseLinearFunction other) {
     auto f = [](auto&& left, auto&& right) {
         return left + right;
@@ -133,8 +158,8 @@ Segment PiecewiseLinearFunction::FindFunctionZeroValue() const {
 
 template<typename Operator>
 PiecewiseLinearFunction PiecewiseLinearFunction::AddOrSubtract(PiecewiseLinearFunction other, Operator op) {
-    std::vector<LinearFunctionDefineOnSegment> curr_functions = functions_;
-    std::vector<LinearFunctionDefineOnSegment> other_functions = other.functions_;
+    std::vector<LinearFunctionDefineOnSegment> curr_functions = functions_.ToVector();
+    std::vector<LinearFunctionDefineOnSegment> other_functions = other.functions_.ToVector();
 
     std::vector<LinearFunctionDefineOnSegment> curr_functions_in_domain_zone;
     std::vector<LinearFunctionDefineOnSegment> other_functions_in_domain_zone;
@@ -232,9 +257,9 @@ PiecewiseLinearFunction PiecewiseLinearFunction::CreateDpFunction(long double c,
 /*
  * Generate Non Increasing function Dp(+inf) = 0
  */
-PiecewiseLinearFunction PiecewiseLinearFunction::GenerateDpFunction() {
+PiecewiseLinearFunction PiecewiseLinearFunction::GenerateDpFunction(RandomStream& random) {
     Segment function_domain(0, kINF);
-    auto f = PiecewiseLinearFunction::GenerateNonIncreasingLinearFunction(Segment(0, kINF - 1));
+    auto f = PiecewiseLinearFunction::GenerateNonIncreasingLinearFunction(Segment(0, kINF - 1), random);
     auto functions = f.GetFunctions();
     auto min_value = functions.back().GetValueAtEndPoint().GetSinglePoint();
     for (auto& func : functions) {
@@ -248,9 +273,9 @@ PiecewiseLinearFunction PiecewiseLinearFunction::GenerateDpFunction() {
 /*
  * Generate Non Decreasing function Sp(0) = 0
  */
-PiecewiseLinearFunction PiecewiseLinearFunction::GenerateSpFunction() {
+PiecewiseLinearFunction PiecewiseLinearFunction::GenerateSpFunction(RandomStream& random) {
     Segment function_domain(0,kINF);
-    auto f = PiecewiseLinearFunction::GenerateNonDecreasingLinearFunction(function_domain);
+    auto f = PiecewiseLinearFunction::GenerateNonDecreasingLinearFunction(function_domain, random);
     auto functions = f.GetFunctions();
     auto value_at_zero = f.GetValueAtPoint(0);
     for (auto& func : functions) {
@@ -260,21 +285,23 @@ PiecewiseLinearFunction PiecewiseLinearFunction::GenerateSpFunction() {
     return PiecewiseLinearFunction(functions, function_domain);
 }
 
-PiecewiseLinearFunction PiecewiseLinearFunction::GenerateNonIncreasingLinearFunction(Segment function_domain) {
+PiecewiseLinearFunction PiecewiseLinearFunction::GenerateNonIncreasingLinearFunction(Segment function_domain,
+        RandomStream& random) {
     auto result = PiecewiseLinearFunction::GenerateLinearFunction(
             LinearFunctionDefineOnSegment::GenerateNonIncreasingLinearFunction,
             [](auto func_value_at_start_point, auto prev_func_value_at_end_point) {
                 return func_value_at_start_point > prev_func_value_at_end_point;
-            }, function_domain);
+            }, function_domain, random);
     return result;
 }
 
-PiecewiseLinearFunction PiecewiseLinearFunction::GenerateNonDecreasingLinearFunction(Segment function_domain) {
+PiecewiseLinearFunction PiecewiseLinearFunction::GenerateNonDecreasingLinearFunction(Segment function_domain,
+        RandomStream& random) {
     auto result = PiecewiseLinearFunction::GenerateLinearFunction(
             LinearFunctionDefineOnSegment::GenerateNonDecreasingLinearFunction,
             [](auto func_value_at_start_point, auto prev_func_value_at_end_point) {
                 return func_value_at_start_point < prev_func_value_at_end_point;
-            }, function_domain);
+            }, function_domain, random);
     return result;
 }
 
@@ -282,22 +309,24 @@ template<typename FunctionGenerator, typename ShiftComparator>
 PiecewiseLinearFunction PiecewiseLinearFunction::GenerateLinearFunction(
         FunctionGenerator linear_function_generator,
         ShiftComparator shift_comparator,
-        Segment function_domain)
+        Segment function_domain,
+        RandomStream& random)
 {
     long double prev_x_coord = function_domain.GetStart();
-    auto coords_count = GenerateRandomValue(kMinCoordsCount, kMaxCoordsCount);
-    auto x_coords = GenerateVectorOfValues<>(function_domain.GetStart(), function_domain.GetEnd(), coords_count);
+    auto coords_count = GenerateRandomValue(kMinCoordsCount, kMaxCoordsCount, random);
+    auto x_coords = GenerateVectorOfValues<>(function_domain.GetStart(), function_domain.GetEnd(), coords_count,
+            random);
     std::vector<LinearFunctionDefineOnSegment> functions;
 
     for (auto&& x_coord : x_coords) {
-        auto func = linear_function_generator(prev_x_coord, x_coord);
+        auto func = linear_function_generator(prev_x_coord, x_coord, random);
         auto func_value_at_start_point = func.GetValueAtStartPoint().GetSinglePoint();
         if (!functions.empty()) {
             auto prev_func_value_at_end_point = functions.back().GetValueAtEndPoint().GetSinglePoint();
 
             if (shift_comparator(func.GetValueAtStartPoint().GetSinglePoint(), prev_func_value_at_end_point)) {
                 auto shift_value = prev_func_value_at_end_point - func_value_at_start_point;
-                auto small_add = GenerateRandomValue<long double>(0.1, 1.);
+                auto small_add = GenerateRandomValue<long double>(0.1, 1., random);
                 if (shift_value > 0) {
                     shift_value += small_add;
                 } else {
@@ -398,19 +427,28 @@ void PiecewiseLinearFunction::ValidateFunctions() {
             }
         }
     }
+    // Functions are changed only if needed, so borrowed functions which are valid stay borrowed
     for (size_t func_pos = 1; func_pos < functions_.size(); func_pos++) {
         auto x_end_prev = functions_[func_pos - 1].GetXEndCoordinate();
-        auto x_start = functions_[func_pos].GetXStartCoordinate();
-        if (x_start > x_end_prev) {
-            functions_[func_pos].SetXStartCoordinate(x_end_prev);
-        } else if (x_start < x_end_prev) {
-            functions_[func_pos].SetXStartCoordinate(x_end_prev);
+        if (functions_[func_pos].GetXStartCoordinate() != x_end_prev) {
+            functions_.GetMutable()[func_pos].SetXStartCoordinate(x_end_prev);
         }
     }
 
-    std::vector<LinearFunctionDefineOnSegment> result_functions{functions_[0]};
-    for (size_t func_pos = 1; func_pos < functions_.size(); func_pos++) {
-        if (functions_[func_pos - 1].IsHorizontal() && functions_[func_pos].IsHorizontal()) {
+    auto is_horizontal_pair = [&](size_t func_pos) {
+        return functions_[func_pos - 1].IsHorizontal() && functions_[func_pos].IsHorizontal();
+    };
+    size_t first_merged_pos = 1;
+    while (first_merged_pos < functions_.size() && !is_horizontal_pair(first_merged_pos)) {
+        first_merged_pos++;
+    }
+    if (first_merged_pos == functions_.size()) {
+        return;
+    }
+    std::vector<LinearFunctionDefineOnSegment> result_functions(functions_.begin(),
+            functions_.begin() + first_merged_pos);
+    for (size_t func_pos = first_merged_pos; func_pos < functions_.size(); func_pos++) {
+        if (is_horizontal_pair(func_pos)) {
             result_functions.back().SetXEndCoordinate(functions_[func_pos].GetXEndCoordinate());
         } else {
             result_functions.push_back(functions_[func_pos]);
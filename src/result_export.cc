@@ -0,0 +1,178 @@
+#include "result_export.h"
+#include <charconv>
+#include <cstring>
+#include <functional>
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "Result export is little endian");
+
+ResultColumns ResultColumns::Collect(StarChainMarket& market) {
+    auto nodes = market.GetNodes();
+    auto edges = market.GetEdges();
+    ResultColumns columns;
+    columns.nodes_prices.reserve(nodes.size());
+    columns.nodes_vs.reserve(nodes.size());
+    columns.nodes_vd.reserve(nodes.size());
+    columns.nodes_zero_prices.reserve(nodes.size());
+    std::unordered_map<Node*, uint32_t> node_numbers;
+    for (size_t i = 0; i < nodes.size(); i++) {
+        node_numbers[nodes[i].get()] = i;
+        columns.nodes_prices.push_back(nodes[i]->GetP());
+        columns.nodes_vs.push_back(nodes[i]->GetVs());
+        columns.nodes_vd.push_back(nodes[i]->GetVd());
+        columns.nodes_zero_prices.push_back(nodes[i]->GetZeroPrice());
+    }
+
+    for (auto&& edge : edges) {
+        // qij goes from child to parent
+        auto flow = edge->GetqijParentNode() == edge->GetEndNode() ? edge->Getqij() : -edge->Getqij();
+        auto excess = std::max<long double>(0, std::fabs(flow) - edge->GetQ());
+        auto is_expand = edge->IsExpand();
+        columns.lines_from.push_back(node_numbers.at(edge->GetStartNode().get()));
+        columns.lines_to.push_back(node_numbers.at(edge->GetEndNode().get()));
+        columns.lines_flows.push_back(flow);
+        columns.lines_expand.push_back(is_expand);
+        columns.lines_algorithm_types.push_back(static_cast<uint8_t>(edge->GetAlgorithmType()));
+        columns.lines_transport_costs.push_back(edge->Getet() * std::fabs(flow));
+        columns.lines_fixed_costs.push_back(is_expand ? edge->Getef() : 0);
+        columns.lines_expansion_costs.push_back(is_expand ? edge->GetEvCoeff() * excess * excess : 0);
+    }
+    return columns;
+}
+
+/*
+ * Calls visitor with name, table and values of each column in export order
+ */
+template<typename Visitor>
+static void ForEachColumn(const ResultColumns& columns, Visitor&& visitor) {
+    using Table = ResultExport::Table;
+    visitor("p", Table::NODES, columns.nodes_prices);
+    visitor("vs", Table::NODES, columns.nodes_vs);
+    visitor("vd", Table::NODES, columns.nodes_vd);
+    visitor("zero_price", Table::NODES, columns.nodes_zero_prices);
+    visitor("from", Table::LINES, columns.lines_from);
+    visitor("to", Table::LINES, columns.lines_to);
+    visitor("flow", Table::LINES, columns.lines_flows);
+    visitor("expand", Table::LINES, columns.lines_expand);
+    visitor("algorithm_type", Table::LINES, columns.lines_algorithm_types);
+    visitor("transport_cost", Table::LINES, columns.lines_transport_costs);
+    visitor("fixed_cost", Table::LINES, columns.lines_fixed_costs);
+    visitor("expansion_cost", Table::LINES, columns.lines_expansion_costs);
+}
+
+void ResultExport::StoreBinary(std::ostream& os, const ResultColumns& columns) {
+    std::vector<ColumnRecord> records;
+    std::vector<std::pair<const void*, uint64_t>> columns_data;
+    ForEachColumn(columns, [&](const char* name, Table table, const auto& values) {
+        using T = typename std::decay_t<decltype(values)>::value_type;
+        ColumnRecord record;
+        std::memset(&record, 0, sizeof(record));
+        std::strncpy(record.name, name, sizeof(record.name) - 1);
+        record.table = table;
+        record.type = GetColumnType<T>();
+        records.push_back(record);
+        columns_data.emplace_back(values.data(), values.size() * sizeof(T));
+    });
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.columns_count = records.size();
+    header.nodes_count = columns.nodes_prices.size();
+    header.lines_count = columns.lines_flows.size();
+    auto offset = Align(sizeof(Header) + records.size() * sizeof(ColumnRecord));
+    for (size_t i = 0; i < records.size(); i++) {
+        records[i].offset = offset;
+        offset = Align(offset + columns_data[i].second);
+    }
+    header.file_size = offset;
+
+    uint64_t written = 0;
+    auto write = [&](uint64_t offset, const void* data, uint64_t size) {
+        static const char kPadding[kAlignment] = {};
+        os.write(kPadding, offset - written);
+        os.write(static_cast<const char*>(data), size);
+        written = offset + size;
+    };
+    write(0, &header, sizeof(header));
+    write(sizeof(header), records.data(), records.size() * sizeof(ColumnRecord));
+    for (size_t i = 0; i < records.size(); i++) {
+        write(records[i].offset, columns_data[i].first, columns_data[i].second);
+    }
+    write(header.file_size, nullptr, 0);
+}
+
+/*
+ * Writes columns of table as CSV rows, values are formatted with std::to_chars into one buffer
+ */
+static void StoreCsv(std::ostream& os, const ResultColumns& columns, ResultExport::Table table, size_t rows_count) {
+    std::vector<std::function<void(std::string&, size_t)>> writers;
+    std::string text;
+    ForEachColumn(columns, [&](const char* name, ResultExport::Table column_table, const auto& values) {
+        if (column_table != table) {
+            return;
+        }
+        text += writers.empty() ? "" : ",";
+        text += name;
+        writers.push_back([&values](std::string& text, size_t row) {
+            char buffer[32];
+            auto result = std::to_chars(buffer, buffer + sizeof(buffer), +values[row]);
+            text.append(buffer, result.ptr);
+        });
+    });
+    text += '\n';
+    for (size_t row = 0; row < rows_count; row++) {
+        for (size_t i = 0; i < writers.size(); i++) {
+            if (i > 0) {
+                text += ',';
+            }
+            writers[i](text, row);
+        }
+        text += '\n';
+        if (text.size() >= (1 << 20)) {
+            os.write(text.data(), text.size());
+            text.clear();
+        }
+    }
+    os.write(text.data(), text.size());
+}
+
+void ResultExport::StoreNodesCsv(std::ostream& os, const ResultColumns& columns) {
+    StoreCsv(os, columns, Table::NODES, columns.nodes_prices.size());
+}
+
+void ResultExport::StoreLinesCsv(std::ostream& os, const ResultColumns& columns) {
+    StoreCsv(os, columns, Table::LINES, columns.lines_flows.size());
+}
+
+ResultExport::View::View(std::string_view data) : data_(data) {
+    if (reinterpret_cast<uintptr_t>(data.data()) % kAlignment != 0) {
+        throw std::runtime_error("Result export must be aligned");
+    }
+    if (data.size() < sizeof(Header)) {
+        throw std::runtime_error("Result export is truncated");
+    }
+    header_ = reinterpret_cast<const Header*>(data.data());
+    if (std::memcmp(header_->magic, kMagic, sizeof(kMagic)) != 0) {
+        throw std::runtime_error("Not a result export");
+    }
+    if (header_->version != kVersion) {
+        throw std::runtime_error("Unsupported result export version " + std::to_string(header_->version));
+    }
+    if (header_->file_size != data.size()
+            || header_->columns_count > (data.size() - sizeof(Header)) / sizeof(ColumnRecord)) {
+        throw std::runtime_error("Result export is truncated");
+    }
+    auto records = reinterpret_cast<const ColumnRecord*>(data.data() + sizeof(Header));
+    columns_.assign(records, records + header_->columns_count);
+    for (auto&& column : columns_) {
+        column.name[sizeof(column.name) - 1] = '\0';
+        auto count = column.table == Table::NODES ? header_->nodes_count : header_->lines_count;
+        auto size = column.type == ColumnType::FLOAT64 ? sizeof(double) : column.type == ColumnType::UINT32 ?
+                sizeof(uint32_t) : sizeof(uint8_t);
+        if (column.offset % kAlignment != 0 || column.offset > data.size()
+                || count > (data.size() - column.offset) / size) {
+            throw std::runtime_error("Result column " + std::string(column.name) + " out of file");
+        }
+    }
+}
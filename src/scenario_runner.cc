@@ -0,0 +1,196 @@
+#include "scenario_runner.h"
+
+ScenarioRunner::ScenarioRunner(StarChainMarket& base) : market_(base), nodes_(base.GetNodes()),
+        edges_(base.GetEdges()) {
+    market_.SolveAuxiliarySubtask();
+    base_welfare_ = market_.CalculateWelfare();
+    SaveMarketParameters();
+}
+
+ScenarioResult ScenarioRunner::Run(const ScenarioDelta& delta) {
+    std::vector<size_t> changed_nodes;
+    std::vector<std::shared_ptr<Edge>> changed_edges;
+    for (auto&& node_delta : delta.nodes) {
+        if (node_delta.node_pos >= nodes_.size()) {
+            throw std::runtime_error("Scenario node " + std::to_string(node_delta.node_pos) + " out of range");
+        }
+        changed_nodes.push_back(node_delta.node_pos);
+    }
+    for (auto&& line_delta : delta.lines) {
+        if (line_delta.edge_pos >= edges_.size()) {
+            throw std::runtime_error("Scenario line " + std::to_string(line_delta.edge_pos) + " out of range");
+        }
+        changed_edges.push_back(edges_[line_delta.edge_pos]);
+    }
+
+    SavedState state;
+    for (auto node_pos : market_.GetPathsToRoot(changed_nodes, changed_edges)) {
+        state.nodes_delta_s_dash.emplace_back(nodes_[node_pos], nodes_[node_pos]->GetDeltaSDash());
+        for (auto&& edge : market_.GetMatrix()[node_pos]) {
+            if (edge != market_.GetParentEdge(node_pos)) {
+                state.edges_delta_s.emplace_back(edge, edge->GetDeltaSij());
+            }
+        }
+    }
+    for (auto&& node_delta : delta.nodes) {
+        auto node = nodes_[node_delta.node_pos];
+        state.nodes_functions.emplace_back(node, node->GetD(), node->GetS());
+        node->SetFunctions(node_delta.demand.value_or(node->GetD()), node_delta.supply.value_or(node->GetS()));
+    }
+    for (auto&& line_delta : delta.lines) {
+        auto edge = edges_[line_delta.edge_pos];
+        state.edges_parameters.emplace_back(edge, edge->Getet(), edge->GetQ(), edge->Getef(), edge->GetEvCoeff());
+        edge->SetParameters(line_delta.et.value_or(edge->Getet()), line_delta.Q.value_or(edge->GetQ()),
+                line_delta.ef.value_or(edge->Getef()), line_delta.Ev_coeff.value_or(edge->GetEvCoeff()));
+    }
+
+    ScenarioResult result;
+    try {
+        result.rebalanced_nodes_count = market_.SolveAuxiliarySubtaskAlongPaths(changed_nodes, changed_edges);
+        result.welfare = market_.CalculateWelfare();
+    } catch (...) {
+        Restore(state);
+        throw;
+    }
+    result.welfare_change = result.welfare - base_welfare_;
+    for (auto node_pos : changed_nodes) {
+        result.nodes_prices.push_back(nodes_[node_pos]->GetP());
+    }
+    for (auto&& edge : changed_edges) {
+        result.lines_flows.push_back(edge->Getqij());
+    }
+    Restore(state);
+    return result;
+}
+
+void ScenarioRunner::SaveMarketParameters() {
+    for (auto&& node : nodes_) {
+        nodes_parameters_.push_back({node->GetP(), node->GetVs(), node->GetVd()});
+    }
+    for (auto&& edge : edges_) {
+        edges_flows_.emplace_back(edge->Getqij(), edge->GetqijParentNode());
+    }
+}
+
+void ScenarioRunner::Restore(const SavedState& state) {
+    // Functions are restored in reverse order, so node or line changed twice gets its first saved value
+    for (auto it = state.nodes_functions.rbegin(); it != state.nodes_functions.rend(); it++) {
+        std::get<0>(*it)->SetFunctions(std::get<1>(*it), std::get<2>(*it));
+    }
+    for (auto it = state.edges_parameters.rbegin(); it != state.edges_parameters.rend(); it++) {
+        auto&& [edge, et, Q, ef, Ev_coeff] = *it;
+        edge->SetParameters(et, Q, ef, Ev_coeff);
+    }
+    for (auto&& [node, delta_s_dash] : state.nodes_delta_s_dash) {
+        node->SetDeltaSDash(delta_s_dash);
+    }
+    for (auto&& [edge, delta_s] : state.edges_delta_s) {
+        edge->SetDeltaSij(delta_s);
+    }
+    for (size_t i = 0; i < nodes_.size(); i++) {
+        nodes_[i]->SetP(nodes_parameters_[i][0]);
+        nodes_[i]->SetVs(nodes_parameters_[i][1]);
+        nodes_[i]->SetVd(nodes_parameters_[i][2]);
+    }
+    for (size_t i = 0; i < edges_.size(); i++) {
+        edges_[i]->Setqij(edges_flows_[i].first);
+        edges_[i]->SetqijParentNode(edges_flows_[i].second);
+    }
+}
+
+ScenarioDelta ScenarioRunner::ParseDelta(const JsonValue& scenario) {
+    auto read_points = [](const JsonValue& points_value) {
+        std::vector<Point> points;
+        for (auto&& point : points_value.GetArray()) {
+            const auto& coordinates = point.GetArray();
+            if (coordinates.size() != 2) {
+                throw std::runtime_error("Point must be [x, y]");
+            }
+            points.emplace_back(coordinates[0].GetNumber(), coordinates[1].GetNumber());
+        }
+        return PiecewiseLinearFunction(points);
+    };
+    auto read_position = [](const JsonValue& value) {
+        auto pos = value.GetInteger();
+        if (pos < 0) {
+            throw std::runtime_error("Position must be non negative");
+        }
+        return static_cast<size_t>(pos);
+    };
+
+    ScenarioDelta delta;
+    if (auto nodes = scenario.Find("nodes")) {
+        for (auto&& node : nodes->GetArray()) {
+            NodeFunctionsDelta node_delta{read_position(node.At("node")), std::nullopt, std::nullopt};
+            if (auto supply = node.Find("supply")) {
+                node_delta.supply = read_points(*supply);
+            }
+            if (auto demand = node.Find("demand")) {
+                node_delta.demand = read_points(*demand);
+            }
+            delta.nodes.push_back(std::move(node_delta));
+        }
+    }
+    if (auto lines = scenario.Find("lines")) {
+        for (auto&& line : lines->GetArray()) {
+            LineParametersDelta line_delta{read_position(line.At("line")), {}, {}, {}, {}};
+            for (auto&& [key, parameter] : {std::make_pair("et", &line_delta.et), std::make_pair("Q", &line_delta.Q),
+                    std::make_pair("ef", &line_delta.ef), std::make_pair("Ev_coeff", &line_delta.Ev_coeff)}) {
+                if (auto value = line.Find(key)) {
+                    *parameter = value->GetNumber();
+                }
+            }
+            delta.lines.push_back(line_delta);
+        }
+    }
+    return delta;
+}
+
+void ScenarioRunner::WriteResult(std::string& text, const ScenarioResult& result) {
+    text += ",\"welfare\":";
+    WriteJsonNumber(text, result.welfare);
+    text += ",\"welfare_change\":";
+    WriteJsonNumber(text, result.welfare_change);
+    for (auto&& [key, values] : {std::make_pair("nodes_prices", &result.nodes_prices),
+            std::make_pair("lines_flows", &result.lines_flows)}) {
+        text += ",\"";
+        text += key;
+        text += "\":[";
+        for (size_t i = 0; i < values->size(); i++) {
+            if (i > 0) {
+                text.push_back(',');
+            }
+            WriteJsonNumber(text, (*values)[i]);
+        }
+        text.push_back(']');
+    }
+    text += ",\"rebalanced_nodes_count\":" + std::to_string(result.rebalanced_nodes_count);
+}
+
+int64_t ScenarioRunner::RunStream(std::istream& in, std::ostream& out) {
+    int64_t errors_count = 0;
+    std::string line;
+    std::string result;
+    while (std::getline(in, line)) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+        std::string id = "null";
+        result.clear();
+        try {
+            auto scenario = JsonValue::Parse(line);
+            if (auto id_value = scenario.Find("id")) {
+                id = id_value->ToString();
+            }
+            result += ",\"status\":\"ok\"";
+            WriteResult(result, Run(ParseDelta(scenario)));
+        } catch (const std::exception& error) {
+            result = ",\"status\":\"error\",\"error\":";
+            WriteJsonString(result, error.what());
+            errors_count++;
+        }
+        out << "{\"id\":" << id << result << "}\n";
+    }
+    out.flush();
+    return errors_count;
+}
@@ -0,0 +1,241 @@
+#include "shared_market.h"
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <ostream>
+#include <streambuf>
+
+namespace {
+
+/*
+ * Output buffer of stream writing to file descriptor, failed write makes stream bad
+ */
+class FdOutputBuffer : public std::streambuf {
+public:
+    explicit FdOutputBuffer(int fd) : fd_(fd) {
+        setp(buffer_, buffer_ + sizeof(buffer_));
+    }
+
+    ~FdOutputBuffer() override {
+        sync();
+    }
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (sync() < 0) {
+            return traits_type::eof();
+        }
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    int sync() override {
+        for (auto data = pbase(); data < pptr();) {
+            auto written = write(fd_, data, pptr() - data);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return -1;
+            }
+            data += written;
+        }
+        setp(buffer_, buffer_ + sizeof(buffer_));
+        return 0;
+    }
+
+private:
+    int fd_;
+    char buffer_[1 << 16];
+};
+
+}
+
+SharedMarket::Header SharedMarket::CreateHeader(StarChainMarket& market) {
+    auto nodes = market.GetNodes();
+    uint64_t points_count = 0;
+    uint64_t functions_count = 0;
+    uint64_t central_node = nodes.size();
+    for (size_t i = 0; i < nodes.size(); i++) {
+        auto D = nodes[i]->GetD();
+        auto S = nodes[i]->GetS();
+        points_count += S.GetPoints().size() + D.GetPoints().size();
+        functions_count += D.GetFunctionsStorage().size() + S.GetFunctionsStorage().size()
+                + nodes[i]->GetDeltaS().GetFunctionsStorage().size();
+        if (market.IsCentralNode(nodes[i])) {
+            central_node = i;
+        }
+    }
+    auto snapshot_size = MarketSnapshot::CreateHeader(nodes.size(), market.GetEdges().size(), points_count,
+            central_node).file_size;
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.nodes_count = nodes.size();
+    header.edges_count = market.GetEdges().size();
+    header.tree_root = market.GetRootNodePos() >= 0 ? market.GetRootNodePos() : nodes.size();
+    header.snapshot_offset = Align(sizeof(Header));
+    header.snapshot_size = snapshot_size;
+    header.function_offsets_offset = Align(header.snapshot_offset + snapshot_size);
+    header.functions_offset = Align(header.function_offsets_offset + (3 * nodes.size() + 1) * sizeof(uint64_t));
+    header.functions_count = functions_count;
+    header.file_size = Align(header.functions_offset + functions_count * sizeof(LinearFunctionDefineOnSegment));
+    return header;
+}
+
+void SharedMarket::StoreSections(std::ostream& os, StarChainMarket& market, const Header& header) {
+    uint64_t written = sizeof(Header);
+    auto pad = [&](uint64_t offset) {
+        static const char kPadding[kAlignment] = {};
+        os.write(kPadding, offset - written);
+        written = offset;
+    };
+    auto write = [&](const void* data, uint64_t size) {
+        os.write(static_cast<const char*>(data), size);
+        written += size;
+    };
+    pad(header.snapshot_offset);
+    MarketSnapshot::Store(os, market);
+    written += header.snapshot_size;
+
+    // Functions of node in order of offsets
+    auto node_functions = [](const std::shared_ptr<Node>& node) {
+        return std::array<PiecewiseLinearFunction, 3>{node->GetD(), node->GetS(), node->GetDeltaS()};
+    };
+    // Sections are written node by node, so functions are not copied all together
+    auto nodes = market.GetNodes();
+    pad(header.function_offsets_offset);
+    uint64_t function_offset = 0;
+    write(&function_offset, sizeof(uint64_t));
+    for (auto&& node : nodes) {
+        for (auto&& function : node_functions(node)) {
+            function_offset += function.GetFunctionsStorage().size();
+            write(&function_offset, sizeof(uint64_t));
+        }
+    }
+    pad(header.functions_offset);
+    for (auto&& node : nodes) {
+        for (auto&& function : node_functions(node)) {
+            const auto& functions = function.GetFunctionsStorage();
+            write(functions.begin(), functions.size() * sizeof(LinearFunctionDefineOnSegment));
+        }
+    }
+    pad(header.file_size);
+}
+
+void SharedMarket::Store(std::ostream& os, StarChainMarket& market) {
+    auto header = CreateHeader(market);
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    StoreSections(os, market, header);
+}
+
+void SharedMarket::Publish(const std::string& name, StarChainMarket& market) {
+    auto header = CreateHeader(market);
+    // Object is created again, so mappings of attached workers are not changed
+    if (shm_unlink(name.c_str()) < 0 && errno != ENOENT) {
+        throw std::runtime_error("Can't replace shared memory object " + name);
+    }
+    auto fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Can't create shared memory object " + name);
+    }
+    if (ftruncate(fd, header.file_size) < 0) {
+        close(fd);
+        shm_unlink(name.c_str());
+        throw std::runtime_error("Can't resize shared memory object " + name);
+    }
+    // Header goes last, worker attached before sees zero magic instead of part of model
+    bool is_written;
+    {
+        FdOutputBuffer buffer(fd);
+        std::ostream os(&buffer);
+        Header empty_header;
+        std::memset(&empty_header, 0, sizeof(empty_header));
+        os.write(reinterpret_cast<const char*>(&empty_header), sizeof(empty_header));
+        StoreSections(os, market, header);
+        is_written = static_cast<bool>(os.flush());
+    }
+    is_written = is_written && pwrite(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header));
+    close(fd);
+    if (!is_written) {
+        shm_unlink(name.c_str());
+        throw std::runtime_error("Can't write shared memory object " + name);
+    }
+}
+
+void SharedMarket::Unpublish(const std::string& name) {
+    if (shm_unlink(name.c_str()) < 0 && errno != ENOENT) {
+        throw std::runtime_error("Can't remove shared memory object " + name);
+    }
+}
+
+int SharedMarket::Open(const std::string& name, SharedMarketSource source) {
+    return source == SharedMarketSource::SHARED_MEMORY ? shm_open(name.c_str(), O_RDONLY, 0) :
+            open(name.c_str(), O_RDONLY);
+}
+
+SharedMarket::SharedMarket(const std::string& name, SharedMarketSource source)
+        : file_(std::make_shared<const MappedFile>(Open(name, source),
+                (source == SharedMarketSource::SHARED_MEMORY ? "shared memory object " : "file ") + name)),
+        data_(file_->GetData()) {
+    if (data_.size() < sizeof(Header)) {
+        throw std::runtime_error("Shared market is truncated");
+    }
+    header_ = reinterpret_cast<const Header*>(data_.data());
+    if (std::memcmp(header_->magic, kMagic, sizeof(kMagic)) != 0) {
+        static const char kEmptyMagic[sizeof(kMagic)] = {};
+        throw std::runtime_error(std::memcmp(header_->magic, kEmptyMagic, sizeof(kMagic)) == 0 ?
+                "Shared market is not published yet" : "Not a shared market");
+    }
+    if (header_->version != kVersion) {
+        throw std::runtime_error("Unsupported shared market version " + std::to_string(header_->version));
+    }
+    if (header_->file_size != data_.size()) {
+        throw std::runtime_error("Shared market is truncated");
+    }
+    auto in_file = [&](uint64_t offset, uint64_t count, uint64_t size) {
+        return offset % kAlignment == 0 && offset <= data_.size() && count <= (data_.size() - offset) / size;
+    };
+    if (!in_file(header_->snapshot_offset, header_->snapshot_size, 1)
+            || header_->nodes_count > data_.size()
+            || !in_file(header_->function_offsets_offset, 3 * header_->nodes_count + 1, sizeof(uint64_t))
+            || !in_file(header_->functions_offset, header_->functions_count, sizeof(LinearFunctionDefineOnSegment))) {
+        throw std::runtime_error("Shared market section out of file");
+    }
+    function_offsets_ = reinterpret_cast<const uint64_t*>(data_.data() + header_->function_offsets_offset);
+    functions_ = reinterpret_cast<const LinearFunctionDefineOnSegment*>(data_.data() + header_->functions_offset);
+}
+
+StarChainMarket SharedMarket::CreateWorkspace() const {
+    auto borrow_function = [&](size_t func_pos) {
+        auto start = function_offsets_[func_pos];
+        auto end = function_offsets_[func_pos + 1];
+        if (start > end || end > header_->functions_count) {
+            throw std::runtime_error("Shared market functions out of range");
+        }
+        return PiecewiseLinearFunction(LinearFunctionsStorage(file_, functions_ + start, end - start));
+    };
+    std::vector<std::shared_ptr<Node>> nodes;
+    nodes.reserve(header_->nodes_count);
+    for (uint64_t i = 0; i < header_->nodes_count; i++) {
+        nodes.push_back(std::make_shared<Node>(borrow_function(3 * i), borrow_function(3 * i + 1),
+                borrow_function(3 * i + 2)));
+    }
+
+    auto market = MarketSnapshot::Load(data_.substr(header_->snapshot_offset, header_->snapshot_size),
+            std::move(nodes));
+    if (market.GetNodes().empty()) {
+        throw std::runtime_error("Market has no nodes");
+    }
+    if (header_->tree_root < header_->nodes_count) {
+        market.SetRootNodePos(header_->tree_root);
+    } else {
+        market.BuildTreeMinDepth();
+    }
+    return market;
+}
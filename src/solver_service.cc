@@ -0,0 +1,366 @@
+#include "solver_service.h"
+#include "batch_solver.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cstring>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+std::string SolverService::Handle(std::string_view request_line) {
+    JsonValue request;
+    try {
+        request = JsonValue::Parse(request_line);
+    } catch (const std::exception& error) {
+        std::string result = "{\"id\":null,\"status\":\"error\",\"error\":";
+        WriteJsonString(result, error.what());
+        return result + "}";
+    }
+    return HandleRequest(request);
+}
+
+std::string SolverService::HandleRequest(const JsonValue& request) {
+    std::string id = "null";
+    std::string result = ",\"status\":";
+    try {
+        if (auto id_value = request.Find("id")) {
+            id = id_value->ToString();
+        }
+        std::string operation_result;
+        HandleOperation(request, operation_result);
+        result += "\"ok\"" + operation_result;
+    } catch (const std::exception& error) {
+        result += "\"error\",\"error\":";
+        WriteJsonString(result, error.what());
+    }
+    return "{\"id\":" + id + result + "}";
+}
+
+void SolverService::Submit(ThreadPool& pool, std::string_view request_line, Respond respond) {
+    JsonValue request;
+    try {
+        request = JsonValue::Parse(request_line);
+    } catch (const std::exception&) {
+        respond(Handle(request_line));
+        return;
+    }
+    auto market_id_value = request.IsObject() ? request.Find("market_id") : nullptr;
+    if (!market_id_value || !market_id_value->IsString()) {
+        pool.Submit([this, request = std::move(request), respond = std::move(respond)] {
+            respond(HandleRequest(request));
+        });
+        return;
+    }
+    auto market_id = market_id_value->GetString();
+    std::lock_guard<std::mutex> lock(queues_mutex_);
+    auto& queue = queues_[market_id];
+    queue.requests.emplace_back(std::move(request), std::move(respond));
+    if (queue.is_busy) {
+        return;
+    }
+    queue.is_busy = true;
+    pool.Submit([this, &pool, market_id] {
+        RunQueued(pool, market_id);
+    });
+}
+
+void SolverService::RunQueued(ThreadPool& pool, const std::string& market_id) {
+    std::pair<JsonValue, Respond> queued;
+    {
+        std::lock_guard<std::mutex> lock(queues_mutex_);
+        auto& requests = queues_.at(market_id).requests;
+        queued = std::move(requests.front());
+        requests.pop_front();
+    }
+    queued.second(HandleRequest(queued.first));
+
+    std::lock_guard<std::mutex> lock(queues_mutex_);
+    auto it = queues_.find(market_id);
+    if (it->second.requests.empty()) {
+        queues_.erase(it);
+        return;
+    }
+    pool.Submit([this, &pool, market_id] {
+        RunQueued(pool, market_id);
+    });
+}
+
+std::shared_ptr<SolverService::ResidentMarket> SolverService::FindMarket(const JsonValue& request) {
+    const auto& market_id = request.At("market_id").GetString();
+    std::shared_lock<std::shared_mutex> lock(markets_mutex_);
+    auto it = markets_.find(market_id);
+    if (it == markets_.end()) {
+        throw std::runtime_error("Unknown market " + market_id);
+    }
+    return it->second;
+}
+
+void SolverService::HandleOperation(const JsonValue& request, std::string& result) {
+    const auto& operation = request.At("operation").GetString();
+    if (operation == "load") {
+        auto resident_market = std::make_shared<ResidentMarket>();
+        resident_market->market = BatchSolver::LoadRequestMarket(request.At("market"));
+        result += ",\"nodes_count\":" + std::to_string(resident_market->market.GetNodes().size())
+                + ",\"lines_count\":" + std::to_string(resident_market->market.GetEdges().size());
+        std::unique_lock<std::shared_mutex> lock(markets_mutex_);
+        markets_[request.At("market_id").GetString()] = std::move(resident_market);
+        return;
+    }
+    if (operation == "unload") {
+        std::unique_lock<std::shared_mutex> lock(markets_mutex_);
+        if (!markets_.erase(request.At("market_id").GetString())) {
+            throw std::runtime_error("Unknown market " + request.At("market_id").GetString());
+        }
+        return;
+    }
+    if (operation == "list") {
+        std::shared_lock<std::shared_mutex> lock(markets_mutex_);
+        result += ",\"market_ids\":[";
+        bool is_first = true;
+        for (auto&& [market_id, resident_market] : markets_) {
+            if (!is_first) {
+                result.push_back(',');
+            }
+            WriteJsonString(result, market_id);
+            is_first = false;
+        }
+        result.push_back(']');
+        return;
+    }
+
+    auto resident_market = FindMarket(request);
+    std::lock_guard<std::mutex> lock(resident_market->mutex);
+    auto& market = resident_market->market;
+    if (operation == "what_if") {
+        auto edges = market.GetEdges();
+        auto mask_value = request.Find("mask");
+        auto mask = mask_value ? mask_value->GetString() : std::string(edges.size(), '0');
+        if (mask.size() != edges.size() || mask.find_first_not_of("01") != std::string::npos) {
+            throw std::runtime_error("Mask must have 0 or 1 for each of " + std::to_string(edges.size()) + " lines");
+        }
+        auto delta = ScenarioRunner::ParseDelta(request.At("scenario"));
+        if (!resident_market->scenario_runner || resident_market->scenario_mask != mask) {
+            resident_market->scenario_runner.reset();
+            for (size_t i = 0; i < edges.size(); i++) {
+                edges[i]->SetAlgorithmType(mask[i] == '1' ? AlgorithmType::L_plus : AlgorithmType::L_minus);
+            }
+            resident_market->scenario_runner = std::make_unique<ScenarioRunner>(market);
+            resident_market->scenario_mask = mask;
+        }
+        ScenarioRunner::WriteResult(result, resident_market->scenario_runner->Run(delta));
+        return;
+    }
+    resident_market->scenario_runner.reset();
+    market.ClearMarketEdgesAlgorithmType();
+    BatchSolver::SolveOperation(market, request, result);
+}
+
+void SolverService::ServeStream(std::istream& in, std::ostream& out) {
+    std::mutex out_mutex;
+    ThreadPool pool(threads_count_);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+        Submit(pool, line, [&out, &out_mutex](std::string response) {
+            std::lock_guard<std::mutex> lock(out_mutex);
+            out << response << std::endl;
+        });
+    }
+}
+
+namespace {
+
+struct Connection {
+    int fd;
+    std::string input;
+    std::string output;
+    // Requests sent to pool and not yet answered
+    int64_t pending_count = 0;
+    bool is_input_closed = false;
+    // Events watched by event loop
+    uint32_t events = EPOLLIN;
+};
+
+}
+
+void SolverService::ServeSocket(const std::string& path) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Socket path is too long: " + path);
+    }
+    std::strcpy(address.sun_path, path.c_str());
+    auto listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    // Socket left by previous run is replaced, bind fails on other files
+    struct stat path_stat;
+    if (lstat(path.c_str(), &path_stat) == 0 && S_ISSOCK(path_stat.st_mode)) {
+        unlink(path.c_str());
+    }
+    if (listen_fd < 0 || bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0
+            || listen(listen_fd, SOMAXCONN) < 0) {
+        if (listen_fd >= 0) {
+            close(listen_fd);
+        }
+        throw std::runtime_error("Can't listen socket " + path + ": " + std::strerror(errno));
+    }
+    auto wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    auto epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    auto watch = [&](int fd, uint32_t events, int operation) {
+        epoll_event event;
+        std::memset(&event, 0, sizeof(event));
+        event.events = events;
+        event.data.fd = fd;
+        epoll_ctl(epoll_fd, operation, fd, &event);
+    };
+    watch(listen_fd, EPOLLIN, EPOLL_CTL_ADD);
+    watch(wake_fd, EPOLLIN, EPOLL_CTL_ADD);
+    wake_fd_ = wake_fd;
+
+    std::mutex completed_mutex;
+    // Responses of pool by connection descriptor and number
+    std::vector<std::tuple<int, int64_t, std::string>> completed;
+    std::unordered_map<int, Connection> connections;
+    // Number of connection by descriptor, responses to closed connection with reused descriptor are dropped
+    std::unordered_map<int, int64_t> connection_numbers;
+    int64_t next_connection_number = 0;
+    {
+        ThreadPool pool(threads_count_);
+        auto close_connection = [&](int fd) {
+            epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+            close(fd);
+            connections.erase(fd);
+            connection_numbers.erase(fd);
+        };
+        auto flush = [&](Connection& connection) {
+            while (!connection.output.empty()) {
+                auto written = send(connection.fd, connection.output.data(), connection.output.size(), MSG_NOSIGNAL);
+                if (written < 0) {
+                    if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                        close_connection(connection.fd);
+                        return;
+                    }
+                    break;
+                }
+                connection.output.erase(0, written);
+            }
+            if (connection.is_input_closed && connection.pending_count == 0 && connection.output.empty()) {
+                close_connection(connection.fd);
+                return;
+            }
+            uint32_t events = (connection.is_input_closed ? 0u : uint32_t(EPOLLIN)) | (connection.output.empty() ? 0u : uint32_t(EPOLLOUT));
+            if (events != connection.events) {
+                connection.events = events;
+                watch(connection.fd, events, EPOLL_CTL_MOD);
+            }
+        };
+
+        std::vector<epoll_event> events(64);
+        while (!is_stopped_) {
+            auto events_count = epoll_wait(epoll_fd, events.data(), events.size(), -1);
+            for (int i = 0; i < events_count; i++) {
+                auto fd = events[i].data.fd;
+                if (fd == listen_fd) {
+                    int client_fd;
+                    while ((client_fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+                        connections[client_fd].fd = client_fd;
+                        connection_numbers[client_fd] = next_connection_number++;
+                        watch(client_fd, EPOLLIN, EPOLL_CTL_ADD);
+                    }
+                } else if (fd == wake_fd) {
+                    uint64_t value;
+                    [[maybe_unused]] auto read_size = read(wake_fd, &value, sizeof(value));
+                    std::vector<std::tuple<int, int64_t, std::string>> responses;
+                    {
+                        std::lock_guard<std::mutex> lock(completed_mutex);
+                        responses.swap(completed);
+                    }
+                    for (auto&& [client_fd, connection_number, response] : responses) {
+                        auto it = connection_numbers.find(client_fd);
+                        if (it == connection_numbers.end() || it->second != connection_number) {
+                            continue;
+                        }
+                        auto& connection = connections.at(client_fd);
+                        connection.pending_count--;
+                        connection.output += response;
+                        connection.output.push_back('\n');
+                        flush(connection);
+                    }
+                } else if (connections.count(fd)) {
+                    auto& connection = connections.at(fd);
+                    auto is_hangup = (events[i].events & (EPOLLHUP | EPOLLERR)) != 0;
+                    // Input written before hangup is still read, so requests sent without waiting are run
+                    if (is_hangup || (events[i].events & EPOLLIN)) {
+                        char buffer[1 << 16];
+                        while (true) {
+                            auto read_size = read(fd, buffer, sizeof(buffer));
+                            if (read_size > 0) {
+                                connection.input.append(buffer, read_size);
+                                continue;
+                            }
+                            if (read_size == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+                                connection.is_input_closed = true;
+                            }
+                            break;
+                        }
+                        size_t line_start = 0;
+                        while (line_start < connection.input.size()) {
+                            auto line_end = connection.input.find('\n', line_start);
+                            if (line_end == std::string::npos) {
+                                if (!connection.is_input_closed) {
+                                    break;
+                                }
+                                // Last request of closed input may have no line end
+                                line_end = connection.input.size();
+                            }
+                            auto line = connection.input.substr(line_start, line_end - line_start);
+                            line_start = line_end + 1;
+                            if (line.find_first_not_of(" \t\r") == std::string::npos) {
+                                continue;
+                            }
+                            connection.pending_count++;
+                            Submit(pool, line, [&completed_mutex, &completed, wake_fd, fd,
+                                    connection_number = connection_numbers.at(fd)](std::string response) {
+                                {
+                                    std::lock_guard<std::mutex> lock(completed_mutex);
+                                    completed.emplace_back(fd, connection_number, std::move(response));
+                                }
+                                uint64_t value = 1;
+                                [[maybe_unused]] auto write_size = write(wake_fd, &value, sizeof(value));
+                            });
+                        }
+                        connection.input.erase(0, std::min(line_start, connection.input.size()));
+                    }
+                    if (is_hangup) {
+                        // Client is gone, responses to its requests are dropped
+                        close_connection(fd);
+                        continue;
+                    }
+                    flush(connection);
+                }
+            }
+        }
+    }
+    wake_fd_ = -1;
+    for (auto&& [fd, connection] : connections) {
+        close(fd);
+    }
+    close(epoll_fd);
+    close(wake_fd);
+    close(listen_fd);
+    unlink(path.c_str());
+}
+
+void SolverService::Stop() {
+    is_stopped_ = true;
+    auto wake_fd = wake_fd_.load();
+    if (wake_fd >= 0) {
+        uint64_t value = 1;
+        [[maybe_unused]] auto write_size = write(wake_fd, &value, sizeof(value));
+    }
+}
@@ -1,5 +1,12 @@
 #include "star_chain_market.h"
+#include "mapped_file.h"
+#include "market_parser.h"
+#include "market_writer.h"
+#include "market_snapshot.h"
+#include <algorithm>
 #include <cassert>
+#include <numeric>
+#include <tuple>
 #include <variant>
 #include <fstream>
 #include <sstream>
@@ -35,6 +42,19 @@ bool StarChainMarket::AddNodeAndEdge(std::shared_ptr<Node> node, std::shared_ptr
     return AddNode(node) && AddEdge(edge);
 }
 
+void StarChainMarket::Reserve(size_t nodes_count, size_t edges_count) {
+    unique_id_to_vector_pos_.reserve(nodes_count);
+    nodes_.reserve(nodes_count);
+    matrix_.reserve(nodes_count);
+    edges_.reserve(edges_count);
+}
+
+void StarChainMarket::ReserveAdjacency(const std::vector<size_t>& degrees) {
+    for (size_t i = 0; i < std::min(degrees.size(), matrix_.size()); i++) {
+        matrix_[i].reserve(degrees[i]);
+    }
+}
+
 void StarChainMarket::SetCentralNode(std::shared_ptr<Node> node) {
     central_market_node_ = node;
 }
@@ -47,36 +67,55 @@ int64_t StarChainMarket::GetVectorPosByNode(std::shared_ptr<Node> node) {
     return unique_id_to_vector_pos_[node->GetUniqueId()];
 }
 
+int64_t StarChainMarket::GetVectorPosByNode(std::shared_ptr<Node> node) const {
+    auto it = unique_id_to_vector_pos_.find(node->GetUniqueId());
+    if (it == unique_id_to_vector_pos_.end()) {
+        throw std::runtime_error("Node is not in market");
+    }
+    return it->second;
+}
+
 std::optional<StarChainMarket> StarChainMarket::GenerateRandomMarket(int64_t import_from_center_nodes_count,
         int64_t export_to_center_node_nodes_count, int64_t chain_nodes_count) {
+    return GenerateRandomMarket(import_from_center_nodes_count, export_to_center_node_nodes_count, chain_nodes_count,
+            GetThreadRandomStream().Next());
+}
+
+std::optional<StarChainMarket> StarChainMarket::GenerateRandomMarket(int64_t import_from_center_nodes_count,
+        int64_t export_to_center_node_nodes_count, int64_t chain_nodes_count, uint64_t seed) {
     StarChainMarket market;
     auto is_success = true;
-    auto c = GenerateRandomValue(1, 10);
-    auto d = GenerateRandomValue(1, 10);
+    uint64_t node_number = 0;
+    RandomStream central_random(seed, node_number++);
+    auto c = GenerateRandomValue(1, 10, central_random);
+    auto d = GenerateRandomValue(1, 10, central_random);
     auto central_node = Node::GenerateRandomNode(c, d * c);
     market.AddNode(central_node, true);
 
     for (auto import_num = 0; import_num < import_from_center_nodes_count; import_num++) {
-        auto node = Node::GenerateRandomNodeWithZeroPriceMoreThan(central_node->GetZeroPrice());
-        auto edge = Edge::GenerateRandomEdge(central_node, node, EdgeType::STAR_FROM_CENTER);
-        is_success = is_success && market.AddNodeAndEdge(node, edge);
+        RandomStream random(seed, node_number++);
+        auto node = Node::GenerateRandomNodeWithZeroPriceMoreThan(central_node->GetZeroPrice(), random);
+        auto edge = Edge::GenerateRandomEdge(central_node, node, EdgeType::STAR_FROM_CENTER, random);
+        is_success = market.AddNodeAndEdge(node, edge) && is_success;
     }
 
     for (auto export_num = 0; export_num < export_to_center_node_nodes_count; export_num++) {
-        auto node = Node::GenerateRandomNodeWithZeroPriceLessThan(central_node->GetZeroPrice());
-        auto edge = Edge::GenerateRandomEdge(node, central_node, EdgeType::STAR_TO_CENTER);
-        is_success = is_success && market.AddNodeAndEdge(node, edge);
+        RandomStream random(seed, node_number++);
+        auto node = Node::GenerateRandomNodeWithZeroPriceLessThan(central_node->GetZeroPrice(), random);
+        auto edge = Edge::GenerateRandomEdge(node, central_node, EdgeType::STAR_TO_CENTER, random);
+        is_success = market.AddNodeAndEdge(node, edge) && is_success;
     }
 
     auto prev_node_in_chain = central_node;
     for (auto chain_num = 0; chain_num < chain_nodes_count; chain_num++) {
-        auto c = GenerateRandomValue(1, 10);
-        auto d = GenerateRandomValue(1, 10);
+        RandomStream random(seed, node_number++);
+        auto c = GenerateRandomValue(1, 10, random);
+        auto d = GenerateRandomValue(1, 10, random);
         auto node = Node::GenerateRandomNode(c, c * d);
         auto edge = (node->GetZeroPrice() > prev_node_in_chain->GetZeroPrice()) ? Edge::GenerateRandomEdge(
-                prev_node_in_chain, node, EdgeType::CHAIN_FROM_CENTER) : Edge::GenerateRandomEdge(node,
-                prev_node_in_chain, EdgeType::CHAIN_TO_CENTER);
-        is_success = is_success && market.AddNodeAndEdge(node, edge);
+                prev_node_in_chain, node, EdgeType::CHAIN_FROM_CENTER, random) : Edge::GenerateRandomEdge(node,
+                prev_node_in_chain, EdgeType::CHAIN_TO_CENTER, random);
+        is_success = market.AddNodeAndEdge(node, edge) && is_success;
         prev_node_in_chain = node;
     }
     market.ExtendAllSupplyAndDemandFunctionsToMaxDemandZeroingPrice();
@@ -118,13 +157,44 @@ bool StarChainMarket::FindTreeRootWithMinDepth(size_t node_pos, size_t to, int64
     return false;
 }
 
-void StarChainMarket::BuildTreeMinDepth() {
-    auto random_node_pos = GenerateRandomValue<int>(0, kINF) % nodes_.size();
-    while (matrix_[random_node_pos].size() == 1) {
-        random_node_pos = GenerateRandomValue<int>(0, kINF) % nodes_.size();
+bool StarChainMarket::IsTree() const {
+    if (nodes_.empty() || edges_.size() + 1 != nodes_.size()) {
+        return false;
+    }
+    std::vector<bool> used(nodes_.size(), false);
+    std::vector<size_t> stack{0};
+    used[0] = true;
+    size_t reached_nodes_count = 1;
+    while (!stack.empty()) {
+        auto node_pos = stack.back();
+        stack.pop_back();
+        for (auto&& edge : matrix_[node_pos]) {
+            auto to_index = GetVectorPosByNode(edge->GetAnotherNode(nodes_[node_pos]));
+            if (!used[to_index]) {
+                used[to_index] = true;
+                reached_nodes_count++;
+                stack.push_back(to_index);
+            }
+        }
     }
+    return reached_nodes_count == nodes_.size();
+}
 
+void StarChainMarket::BuildTreeMinDepth() {
+    std::vector<size_t> inner_nodes_pos;
+    for (size_t i = 0; i < nodes_.size(); i++) {
+        if (matrix_[i].size() != 1) {
+            inner_nodes_pos.push_back(i);
+        }
+    }
     std::vector<bool> used(nodes_.size(), false);
+    // Tree of two nodes has only leaves, both of them are roots with min depth
+    if (inner_nodes_pos.empty()) {
+        tree_root_pos_ = 0;
+        Dfs(tree_root_pos_, used, 0);
+        return;
+    }
+    auto random_node_pos = inner_nodes_pos[GenerateRandomValue<size_t>(0, inner_nodes_pos.size() - 1)];
     Dfs(random_node_pos, used, 0);
 
     std::shared_ptr<Node> max_node, min_node;
@@ -155,9 +225,14 @@ void StarChainMarket::BuildTreeMinDepth() {
 
 PiecewiseLinearFunction StarChainMarket::CreateDeltaSForLine(std::shared_ptr<Node> node,
         std::shared_ptr<Edge> edge) {
+    return CreateDeltaSForLine(node, edge, edge->GetAnotherNode(node)->GetDeltaSDash());
+}
+
+PiecewiseLinearFunction StarChainMarket::CreateDeltaSForLine(std::shared_ptr<Node> node,
+        std::shared_ptr<Edge> edge, const PiecewiseLinearFunction& another_node_balance) {
     auto to_node = edge->GetAnotherNode(node);
 
-    auto Si_inv = to_node->GetDeltaSDash().GetInverseFunction();
+    auto Si_inv = another_node_balance.GetInverseFunction();
     auto eij = edge->Getev();
 
     PiecewiseLinearFunction eij_final;
@@ -174,7 +249,6 @@ PiecewiseLinearFunction StarChainMarket::CreateDeltaSForLine(std::shared_ptr<Nod
 }
 
 void StarChainMarket::SolveAuxiliarySubtask() {
-    std::vector<bool> used(nodes_.size(), false);
     for (auto&& edge : edges_) {
         if (edge->GetAlgorithmType() == AlgorithmType::L_plus) {
             edge->SetLineExpand();
@@ -182,36 +256,595 @@ void StarChainMarket::SolveAuxiliarySubtask() {
             edge->SetLineNotExpand();
         }
     }
+    SolveAuxiliarySubtaskForLinesExpansion();
+}
+
+void StarChainMarket::SolveAuxiliarySubtaskForLinesExpansion() {
+    std::vector<bool> used(nodes_.size(), false);
+    parent_edges_.assign(nodes_.size(), nullptr);
     FindSDBalance(tree_root_pos_, used);
     used.assign(nodes_.size(), false);
     FindMarketParameters(nullptr, tree_root_pos_, used, -1);
     CheckFoundMarketParameters();
 }
 
+int64_t StarChainMarket::SolveAuxiliarySubtaskAlongPath(std::shared_ptr<Edge> changed_edge) {
+    if (parent_edges_.size() != nodes_.size()) {
+        throw std::runtime_error("Auxiliary subtask must be solved on whole tree before path update");
+    }
+    if (changed_edge->GetAlgorithmType() == AlgorithmType::L_plus) {
+        changed_edge->SetLineExpand();
+    } else {
+        changed_edge->SetLineNotExpand();
+    }
+
+    auto start_pos = GetVectorPosByNode(changed_edge->GetStartNode());
+    auto end_pos = GetVectorPosByNode(changed_edge->GetEndNode());
+    size_t node_pos = parent_edges_[start_pos] == changed_edge ? end_pos : start_pos;
+    auto child_edge = changed_edge;
+    int64_t rebalanced_nodes_count = 0;
+    while (true) {
+        child_edge->SetDeltaSij(CreateDeltaSForLine(nodes_[node_pos], child_edge));
+        SumChildrenSDBalance(node_pos);
+        rebalanced_nodes_count++;
+        child_edge = parent_edges_[node_pos];
+        if (!child_edge) {
+            break;
+        }
+        node_pos = GetVectorPosByNode(child_edge->GetAnotherNode(nodes_[node_pos]));
+    }
+
+    std::vector<bool> used(nodes_.size(), false);
+    FindMarketParameters(nullptr, tree_root_pos_, used, -1);
+    CheckFoundMarketParameters();
+    return rebalanced_nodes_count;
+}
+
+std::vector<size_t> StarChainMarket::GetPathsToRoot(const std::vector<size_t>& changed_nodes,
+        const std::vector<std::shared_ptr<Edge>>& changed_edges) {
+    if (parent_edges_.size() != nodes_.size()) {
+        throw std::runtime_error("Auxiliary subtask must be solved on whole tree before path update");
+    }
+    std::vector<size_t> path_starts = changed_nodes;
+    for (auto&& edge : changed_edges) {
+        // Balance of line is part of balance of its parent node
+        auto start_pos = GetVectorPosByNode(edge->GetStartNode());
+        auto end_pos = GetVectorPosByNode(edge->GetEndNode());
+        path_starts.push_back(parent_edges_[start_pos] == edge ? end_pos : start_pos);
+    }
+
+    // Path goes up until the root or node already taken, nodes are ordered by decreasing distance to the root
+    std::vector<int64_t> distances(nodes_.size(), -1);
+    std::vector<size_t> result;
+    for (auto node_pos : path_starts) {
+        std::vector<size_t> path;
+        int64_t distance = -1;
+        for (auto pos = node_pos;;) {
+            if (distances.at(pos) >= 0) {
+                distance = distances[pos];
+                break;
+            }
+            path.push_back(pos);
+            if (!parent_edges_[pos]) {
+                break;
+            }
+            pos = GetVectorPosByNode(parent_edges_[pos]->GetAnotherNode(nodes_[pos]));
+        }
+        for (auto it = path.rbegin(); it != path.rend(); it++) {
+            distances[*it] = ++distance;
+            result.push_back(*it);
+        }
+    }
+    std::stable_sort(result.begin(), result.end(), [&](auto lhs, auto rhs) {
+        return distances[lhs] > distances[rhs];
+    });
+    return result;
+}
+
+int64_t StarChainMarket::SolveAuxiliarySubtaskAlongPaths(const std::vector<size_t>& changed_nodes,
+        const std::vector<std::shared_ptr<Edge>>& changed_edges) {
+    auto path_nodes = GetPathsToRoot(changed_nodes, changed_edges);
+    std::vector<bool> is_on_path(nodes_.size(), false);
+    for (auto pos : path_nodes) {
+        is_on_path[pos] = true;
+    }
+    for (auto node_pos : path_nodes) {
+        for (auto&& edge : matrix_[node_pos]) {
+            if (edge == parent_edges_[node_pos]) {
+                continue;
+            }
+            auto child_pos = GetVectorPosByNode(edge->GetAnotherNode(nodes_[node_pos]));
+            if (is_on_path[child_pos] || std::find(changed_edges.begin(), changed_edges.end(), edge) != changed_edges.end()) {
+                edge->SetDeltaSij(CreateDeltaSForLine(nodes_[node_pos], edge));
+            }
+        }
+        SumChildrenSDBalance(node_pos);
+    }
+
+    std::vector<bool> used(nodes_.size(), false);
+    FindMarketParameters(nullptr, tree_root_pos_, used, -1);
+    CheckFoundMarketParameters();
+    return path_nodes.size();
+}
+
 void StarChainMarket::FindSDBalance(size_t node_pos, std::vector<bool>& used) {
     used[node_pos] = true;
-    bool is_leaf = true;
-    std::vector<std::shared_ptr<Edge>> children_edges;
     for (auto&& edge : matrix_[node_pos]) {
         auto to_index = GetVectorPosByNode(edge->GetAnotherNode(nodes_[node_pos]));
         if (!used[to_index]) {
-            children_edges.emplace_back(edge);
-            is_leaf = false;
+            parent_edges_[to_index] = edge;
             FindSDBalance(to_index, used);
+            edge->SetDeltaSij(CreateDeltaSForLine(nodes_[node_pos], edge));
         }
     }
-    if (is_leaf) {
-        nodes_[node_pos]->SetDeltaSDash(nodes_[node_pos]->GetDeltaS());
-    } else {
-        PiecewiseLinearFunction delta_S_dash = nodes_[node_pos]->GetDeltaS();
+    SumChildrenSDBalance(node_pos);
+}
 
-        for (auto&& child_edge : children_edges) {
-            auto delta_S_for_edge = CreateDeltaSForLine(nodes_[node_pos], child_edge);
-            child_edge->SetDeltaSij(delta_S_for_edge);
-            delta_S_dash = delta_S_dash + delta_S_for_edge;
+/*
+ * Delta S dash of node is its delta S plus delta S of all lines to children, which must be already found
+ */
+void StarChainMarket::SumChildrenSDBalance(size_t node_pos) {
+    PiecewiseLinearFunction delta_S_dash = nodes_[node_pos]->GetDeltaS();
+    for (auto&& edge : matrix_[node_pos]) {
+        if (edge != parent_edges_[node_pos]) {
+            delta_S_dash = delta_S_dash + edge->GetDeltaSij();
         }
-        nodes_[node_pos]->SetDeltaSDash(delta_S_dash);
     }
+    nodes_[node_pos]->SetDeltaSDash(delta_S_dash);
+}
+
+StarChainMarket StarChainMarket::Clone() const {
+    StarChainMarket market(*this);
+    std::map<std::shared_ptr<Node>, std::shared_ptr<Node>> node_copies{{nullptr, nullptr}};
+    for (auto& node : market.nodes_) {
+        auto copy = std::make_shared<Node>(*node);
+        node_copies[node] = copy;
+        node = copy;
+    }
+    market.central_market_node_ = node_copies[central_market_node_];
+
+    // Line can't be copied directly, its cost function refers to the line it was created for
+    std::map<std::shared_ptr<Edge>, std::shared_ptr<Edge>> edge_copies{{nullptr, nullptr}};
+    for (auto& edge : market.edges_) {
+        auto copy = std::make_shared<Edge>(edge->Getet(), edge->GetQ(), edge->Getef(), edge->GetEvCoeff(),
+                node_copies[edge->GetStartNode()], node_copies[edge->GetEndNode()], edge->GetEdgeType());
+        if (edge->IsExpand()) {
+            copy->SetLineExpand();
+        }
+        copy->SetAlgorithmType(edge->GetAlgorithmType());
+        copy->SetDeltaSij(edge->GetDeltaSij());
+        copy->Setqij(edge->Getqij());
+        copy->SetqijParentNode(node_copies[edge->GetqijParentNode()]);
+        edge_copies[edge] = copy;
+        edge = copy;
+    }
+    for (auto& node_edges : market.matrix_) {
+        for (auto& edge : node_edges) {
+            edge = edge_copies[edge];
+        }
+    }
+    for (auto& edge : market.parent_edges_) {
+        edge = edge_copies[edge];
+    }
+    return market;
+}
+
+namespace {
+
+/*
+ * Side of line in depth first order of nodes: subtree range below the line or the rest of its component
+ */
+struct SideBalanceQuery {
+    long double price;
+    size_t subtree_begin;
+    size_t subtree_end;
+    size_t component_begin;
+    size_t component_end;
+    bool is_subtree;
+};
+
+/*
+ * Sums of node balances over sides at query prices, prices out of domain are moved to its bound and vertical
+ * balance gives its max or min value. Between breakpoints balance of node is linear, so one sweep over prices keeps
+ * slope and intercept of each node in Fenwick tree by position in order.
+ */
+std::vector<long double> FindSidesBalances(const std::vector<std::shared_ptr<Node>>& ordered_nodes,
+        const std::vector<SideBalanceQuery>& queries, bool is_max) {
+    struct Event {
+        long double x;
+        // Change at x itself or right after x
+        bool is_after_point;
+        size_t pos;
+        long double slope;
+        long double intercept;
+    };
+    const auto nodes_count = ordered_nodes.size();
+    std::vector<std::pair<long double, long double>> tree(nodes_count + 1);
+    auto add = [&](size_t pos, long double slope, long double intercept) {
+        for (pos++; pos <= nodes_count; pos += pos & -pos) {
+            tree[pos].first += slope;
+            tree[pos].second += intercept;
+        }
+    };
+    auto prefix_balance = [&](size_t count, long double price) {
+        long double slope = 0, intercept = 0;
+        for (; count > 0; count -= count & -count) {
+            slope += tree[count].first;
+            intercept += tree[count].second;
+        }
+        return slope * price + intercept;
+    };
+
+    std::vector<Event> events;
+    std::vector<long double> breakpoints;
+    for (size_t pos = 0; pos < nodes_count; pos++) {
+        auto balance = ordered_nodes[pos]->GetDeltaS();
+        auto domain = balance.GetFunctionDomain();
+        auto value_at = [&](long double x) {
+            auto value = balance.GetValueAtPoint(x);
+            return is_max ? value.GetEnd() : value.GetStart();
+        };
+        breakpoints = {domain.GetStart(), domain.GetEnd()};
+        for (auto&& point : balance.GetPoints()) {
+            if (point.x_coord_ > domain.GetStart() && point.x_coord_ < domain.GetEnd()) {
+                breakpoints.push_back(point.x_coord_);
+            }
+        }
+        std::sort(breakpoints.begin(), breakpoints.end());
+        breakpoints.erase(std::unique(breakpoints.begin(), breakpoints.end()), breakpoints.end());
+
+        long double slope = 0, intercept = value_at(breakpoints[0]);
+        add(pos, slope, intercept);
+        auto change = [&](long double x, bool is_after_point, long double new_slope, long double new_intercept) {
+            events.push_back({x, is_after_point, pos, new_slope - slope, new_intercept - intercept});
+            slope = new_slope;
+            intercept = new_intercept;
+        };
+        for (size_t i = 0; i + 1 < breakpoints.size(); i++) {
+            change(breakpoints[i], false, 0, value_at(breakpoints[i]));
+            auto step = (breakpoints[i + 1] - breakpoints[i]) / 4;
+            auto left = breakpoints[i] + step, right = breakpoints[i + 1] - step;
+            auto left_value = value_at(left);
+            auto piece_slope = (value_at(right) - left_value) / (right - left);
+            change(breakpoints[i], true, piece_slope, left_value - piece_slope * left);
+        }
+        change(breakpoints.back(), false, 0, value_at(breakpoints.back()));
+    }
+    std::sort(events.begin(), events.end(), [](const Event& lhs, const Event& rhs) {
+        return std::tie(lhs.x, lhs.is_after_point) < std::tie(rhs.x, rhs.is_after_point);
+    });
+
+    std::vector<size_t> queries_order(queries.size());
+    std::iota(queries_order.begin(), queries_order.end(), 0);
+    std::sort(queries_order.begin(), queries_order.end(), [&](size_t lhs, size_t rhs) {
+        return queries[lhs].price < queries[rhs].price;
+    });
+    std::vector<long double> balances(queries.size());
+    size_t next_event = 0;
+    for (auto query_pos : queries_order) {
+        const auto& query = queries[query_pos];
+        for (; next_event < events.size() && (events[next_event].x < query.price
+                || (events[next_event].x == query.price && !events[next_event].is_after_point)); next_event++) {
+            const auto& event = events[next_event];
+            add(event.pos, event.slope, event.intercept);
+        }
+        auto range_balance = [&](size_t begin, size_t end) {
+            return prefix_balance(end, query.price) - prefix_balance(begin, query.price);
+        };
+        balances[query_pos] = range_balance(query.subtree_begin, query.subtree_end);
+        if (!query.is_subtree) {
+            balances[query_pos] = range_balance(query.component_begin, query.component_end) - balances[query_pos];
+        }
+    }
+    return balances;
+}
+
+}
+
+/*
+ * Flow goes from start side to end side of line only if end price is at least start price plus et. Node with
+ * max price in end side can't export and node with min price in start side can't import, so end price is at most
+ * max zero price of end side and start price is at least min zero price of start side. With the same argument
+ * prices of start side are bounded from above and prices of end side from below, which bounds flow by start
+ * side balance at max price and end side balance at min price.
+ * Sides of all lines are found at once: in depth first order one side of line is subtree range and the other one
+ * is the rest of component, so zero prices bounds come from subtree values and prefix and suffix values of order.
+ */
+PresolveResult StarChainMarket::Presolve() {
+    PresolveResult result;
+    std::vector<std::shared_ptr<Edge>> candidate_lines;
+    for (auto&& edge : edges_) {
+        if (edge->GetAlgorithmType() != AlgorithmType::L_undefined) {
+            continue;
+        }
+        if (edge->Getef() <= 0) {
+            edge->SetAlgorithmType(AlgorithmType::L_plus);
+            result.free_expansion_lines_count++;
+            continue;
+        }
+        candidate_lines.push_back(edge);
+    }
+    if (candidate_lines.empty()) {
+        return result;
+    }
+
+    const auto nodes_count = nodes_.size();
+    std::vector<size_t> order, order_begin(nodes_count), order_end(nodes_count), component_begin(nodes_count),
+            component_end(nodes_count);
+    order.reserve(nodes_count);
+    std::vector<std::shared_ptr<Edge>> tree_parent_edges(nodes_count);
+    std::vector<bool> used(nodes_count, false);
+    std::vector<std::pair<size_t, size_t>> stack;
+    for (size_t root = 0; root < nodes_count; root++) {
+        if (used[root]) {
+            continue;
+        }
+        auto first = order.size();
+        used[root] = true;
+        order_begin[root] = order.size();
+        order.push_back(root);
+        stack.emplace_back(root, 0);
+        while (!stack.empty()) {
+            auto node_pos = stack.back().first;
+            auto next = stack.back().second++;
+            if (next == matrix_[node_pos].size()) {
+                order_end[node_pos] = order.size();
+                stack.pop_back();
+                continue;
+            }
+            auto edge = matrix_[node_pos][next];
+            auto to_pos = GetVectorPosByNode(edge->GetAnotherNode(nodes_[node_pos]));
+            if (!used[to_pos]) {
+                used[to_pos] = true;
+                tree_parent_edges[to_pos] = edge;
+                order_begin[to_pos] = order.size();
+                order.push_back(to_pos);
+                stack.emplace_back(to_pos, 0);
+            }
+        }
+        for (auto i = first; i < order.size(); i++) {
+            component_begin[order[i]] = first;
+            component_end[order[i]] = order.size();
+        }
+    }
+
+    // Zero prices bounds of subtrees, of order before position and of order from position to end of component
+    using PricesRange = std::pair<long double, long double>;
+    auto join = [](const PricesRange& lhs, const PricesRange& rhs) {
+        return PricesRange(std::min(lhs.first, rhs.first), std::max(lhs.second, rhs.second));
+    };
+    const PricesRange empty_range(std::numeric_limits<long double>::max(), std::numeric_limits<long double>::lowest());
+    std::vector<std::shared_ptr<Node>> ordered_nodes(nodes_count);
+    std::vector<PricesRange> node_range(nodes_count), subtree_range(nodes_count);
+    for (size_t i = 0; i < nodes_count; i++) {
+        ordered_nodes[i] = nodes_[order[i]];
+        auto zero_price = ordered_nodes[i]->GetZeroPrice();
+        node_range[i] = subtree_range[order[i]] = PricesRange(zero_price, zero_price);
+    }
+    for (size_t i = nodes_count; i > 0; i--) {
+        auto node_pos = order[i - 1];
+        if (tree_parent_edges[node_pos]) {
+            auto parent_pos = GetVectorPosByNode(tree_parent_edges[node_pos]->GetAnotherNode(nodes_[node_pos]));
+            subtree_range[parent_pos] = join(subtree_range[parent_pos], subtree_range[node_pos]);
+        }
+    }
+    std::vector<PricesRange> before_range(nodes_count + 1, empty_range), after_range(nodes_count + 1, empty_range);
+    for (size_t i = 0; i < nodes_count; i++) {
+        before_range[i + 1] = component_begin[order[i]] == i ? node_range[i] : join(before_range[i], node_range[i]);
+    }
+    for (size_t i = nodes_count; i > 0; i--) {
+        after_range[i - 1] = component_end[order[i - 1]] == i ? node_range[i - 1] :
+                join(after_range[i], node_range[i - 1]);
+    }
+
+    std::vector<std::shared_ptr<Edge>> bounded_lines;
+    std::vector<SideBalanceQuery> export_queries, import_queries;
+    for (auto&& edge : candidate_lines) {
+        auto start_pos = GetVectorPosByNode(edge->GetStartNode());
+        auto end_pos = GetVectorPosByNode(edge->GetEndNode());
+        bool is_start_subtree = tree_parent_edges[start_pos] == edge;
+        if (!is_start_subtree && tree_parent_edges[end_pos] != edge) {
+            // Line closes cycle, its sides are not separated
+            continue;
+        }
+        auto child_pos = is_start_subtree ? start_pos : end_pos;
+        SideBalanceQuery side{0, order_begin[child_pos], order_end[child_pos], component_begin[child_pos],
+                component_end[child_pos], false};
+        auto after_subtree = side.subtree_end == side.component_end ? empty_range : after_range[side.subtree_end];
+        auto complement_range = join(before_range[side.subtree_begin], after_subtree);
+        auto [start_side_min_price, start_side_max_price] = is_start_subtree ? subtree_range[child_pos] :
+                complement_range;
+        auto [end_side_min_price, end_side_max_price] = is_start_subtree ? complement_range :
+                subtree_range[child_pos];
+
+        if (end_side_max_price - start_side_min_price < edge->Getet() - kEPS) {
+            edge->SetAlgorithmType(AlgorithmType::L_minus);
+            result.no_flow_lines_count++;
+            continue;
+        }
+
+        bounded_lines.push_back(edge);
+        side.price = std::max(start_side_max_price, end_side_max_price - edge->Getet());
+        side.is_subtree = is_start_subtree;
+        export_queries.push_back(side);
+        side.price = std::min(end_side_min_price, start_side_min_price + edge->Getet());
+        side.is_subtree = !is_start_subtree;
+        import_queries.push_back(side);
+    }
+
+    auto max_exports = FindSidesBalances(ordered_nodes, export_queries, true);
+    auto min_balances = FindSidesBalances(ordered_nodes, import_queries, false);
+    for (size_t i = 0; i < bounded_lines.size(); i++) {
+        if (std::min(max_exports[i], -min_balances[i]) < bounded_lines[i]->GetQ() - kEPS) {
+            bounded_lines[i]->SetAlgorithmType(AlgorithmType::L_minus);
+            result.not_saturated_lines_count++;
+        }
+    }
+    return result;
+}
+
+std::vector<std::vector<std::shared_ptr<Edge>>> StarChainMarket::FindInterchangeableLines(
+        const std::vector<std::shared_ptr<Edge>>& lines) {
+    std::map<std::vector<long double>, size_t> key_to_class;
+    std::vector<std::vector<std::shared_ptr<Edge>>> classes;
+    for (auto&& edge : lines) {
+        auto key = GetSpokeCanonicalKey(edge);
+        if (!key) {
+            classes.push_back({edge});
+            continue;
+        }
+        auto [it, is_inserted] = key_to_class.emplace(std::move(*key), classes.size());
+        if (is_inserted) {
+            classes.emplace_back();
+        }
+        classes[it->second].push_back(edge);
+    }
+    return classes;
+}
+
+std::optional<std::vector<long double>> StarChainMarket::GetSpokeCanonicalKey(std::shared_ptr<Edge> edge) {
+    auto start_pos = GetVectorPosByNode(edge->GetStartNode());
+    auto end_pos = GetVectorPosByNode(edge->GetEndNode());
+    bool is_start_leaf = matrix_[start_pos].size() == 1;
+    bool is_end_leaf = matrix_[end_pos].size() == 1;
+    if (is_start_leaf == is_end_leaf) {
+        return std::nullopt;
+    }
+    auto leaf = is_start_leaf ? edge->GetStartNode() : edge->GetEndNode();
+    auto hub_pos = is_start_leaf ? end_pos : start_pos;
+
+    std::vector<long double> key{static_cast<long double>(hub_pos), static_cast<long double>(is_start_leaf),
+            static_cast<long double>(edge->GetEdgeType()), static_cast<long double>(edge->GetAlgorithmType()),
+            edge->Getet(), edge->GetQ(), edge->Getef(), edge->GetEvCoeff()};
+    for (auto&& func : {leaf->GetD(), leaf->GetS()}) {
+        auto points = func.GetPoints();
+        key.push_back(points.size());
+        for (auto&& point : points) {
+            key.push_back(point.x_coord_);
+            key.push_back(point.y_coord_);
+        }
+    }
+    return key;
+}
+
+std::vector<long double> StarChainMarket::CalculateWelfareWithEachLineFlipped() {
+    if (parent_edges_.size() != nodes_.size()) {
+        throw std::runtime_error("Auxiliary subtask must be solved on whole tree before lines what-if");
+    }
+    std::unordered_map<const Edge*, size_t> edge_positions;
+    edge_positions.reserve(edges_.size());
+    for (size_t i = 0; i < edges_.size(); i++) {
+        edge_positions[edges_[i].get()] = i;
+    }
+    std::vector<long double> flipped_welfare(edges_.size());
+    FindComplementSDBalance(tree_root_pos_, std::nullopt, CalculateWelfare(), edge_positions, flipped_welfare);
+    return flipped_welfare;
+}
+
+/*
+ * Outside balance is flow to node from the rest of tree above it as function of node price. Complement balance
+ * of line to child is node balance without this child subtree.
+ */
+void StarChainMarket::FindComplementSDBalance(size_t node_pos,
+        const std::optional<PiecewiseLinearFunction>& outside_balance, long double welfare,
+        const std::unordered_map<const Edge*, size_t>& edge_positions, std::vector<long double>& flipped_welfare) {
+    std::vector<std::shared_ptr<Edge>> child_edges;
+    for (auto&& edge : matrix_[node_pos]) {
+        if (edge != parent_edges_[node_pos]) {
+            child_edges.push_back(edge);
+        }
+    }
+    if (child_edges.empty()) {
+        return;
+    }
+
+    auto balance = nodes_[node_pos]->GetDeltaS();
+    if (outside_balance) {
+        balance = balance + *outside_balance;
+    }
+    FlipChildLines(node_pos, child_edges, 0, child_edges.size(), balance, welfare, edge_positions, flipped_welfare);
+}
+
+/*
+ * Balance without children is node balance without lines to children of range [begin, end). Flows of one half
+ * of range are added to it for the other half, so only balances on the way to one child are kept at once.
+ */
+void StarChainMarket::FlipChildLines(size_t node_pos, const std::vector<std::shared_ptr<Edge>>& child_edges,
+        size_t begin, size_t end, const PiecewiseLinearFunction& balance_without_children, long double welfare,
+        const std::unordered_map<const Edge*, size_t>& edge_positions, std::vector<long double>& flipped_welfare) {
+    if (end - begin == 1) {
+        auto edge = child_edges[begin];
+        auto complement_balance = balance_without_children.RemoveEmptySegments();
+        flipped_welfare[edge_positions.at(edge.get())] = CalculateWelfareWithLineFlipped(edge, node_pos,
+                complement_balance, welfare);
+
+        auto child = edge->GetAnotherNode(nodes_[node_pos]);
+        auto child_pos = GetVectorPosByNode(child);
+        // Outside balance of leaf isn't used
+        if (matrix_[child_pos].size() > 1) {
+            FindComplementSDBalance(child_pos, CreateDeltaSForLine(child, edge, complement_balance), welfare,
+                    edge_positions, flipped_welfare);
+        }
+        return;
+    }
+    auto add_children = [&](size_t from, size_t to) {
+        auto children_balance = child_edges[from]->GetDeltaSij();
+        for (auto i = from + 1; i < to; i++) {
+            children_balance = children_balance + child_edges[i]->GetDeltaSij();
+        }
+        return children_balance + balance_without_children;
+    };
+    auto middle = (begin + end) / 2;
+    FlipChildLines(node_pos, child_edges, begin, middle, add_children(middle, end), welfare, edge_positions,
+            flipped_welfare);
+    FlipChildLines(node_pos, child_edges, middle, end, add_children(begin, middle), welfare, edge_positions,
+            flipped_welfare);
+}
+
+/*
+ * Child side exporting q at price p has welfare F(p) - p * q, parent side importing q has welfare G(p) + p * q,
+ * where derivatives of F and G are side balances, so welfare change is found by integrals of balances
+ */
+long double StarChainMarket::CalculateWelfareWithLineFlipped(std::shared_ptr<Edge> edge, size_t parent_pos,
+        PiecewiseLinearFunction complement_balance, long double welfare) {
+    auto parent = nodes_[parent_pos];
+    auto child = edge->GetAnotherNode(parent);
+    auto child_balance = child->GetDeltaSDash();
+    auto integrate = [](PiecewiseLinearFunction& func, long double from, long double to) {
+        return from <= to ? func.Integrate(from, to) : -func.Integrate(to, from);
+    };
+
+    const auto old_flow = edge->Getqij();
+    const auto old_cost = edge->GetEValueAtPoint(old_flow);
+    const bool is_expand = edge->IsExpand();
+    if (is_expand) {
+        edge->SetLineNotExpand();
+    } else {
+        edge->SetLineExpand();
+    }
+
+    auto flow_to_parent = CreateDeltaSForLine(parent, edge, child_balance);
+    auto parent_price = (complement_balance + flow_to_parent).GetInverseFunction().GetValueAtPoint(0).GetStart();
+    auto flow_segment = flow_to_parent.GetValueAtPoint(parent_price);
+    auto complement_segment = complement_balance.GetValueAtPoint(parent_price);
+    auto flow = std::max(flow_segment.GetStart(), -complement_segment.GetEnd());
+    if (!edge->IsExpand()) {
+        flow = std::max(-edge->GetQ(), std::min(edge->GetQ(), flow));
+    }
+    auto child_price = child_balance.GetInverseFunction().GetValueAtPoint(flow).GetStart();
+    auto cost = edge->GetEValueAtPoint(flow);
+
+    if (is_expand) {
+        edge->SetLineExpand();
+    } else {
+        edge->SetLineNotExpand();
+    }
+
+    return welfare + integrate(child_balance, child->GetP(), child_price)
+            + integrate(complement_balance, parent->GetP(), parent_price)
+            - child_price * flow + child->GetP() * old_flow
+            + parent_price * flow - parent->GetP() * old_flow
+            - cost + old_cost;
 }
 
 void StarChainMarket::FindMarketParameters(std::shared_ptr<Edge> edge, size_t node_pos,
@@ -312,6 +945,9 @@ void StarChainMarket::CheckFoundMarketParameters() {
         auto Q = edge->GetQ();
         auto et = edge->Getet();
         auto ev_coeff = edge->GetEvCoeff();
+        // Flow goes only from start to end of line, so flow against line direction is zero
+        [[maybe_unused]] auto max_flow_to_parent = edge->GetStartNode() == child_node ? Q : 0;
+        [[maybe_unused]] auto max_flow_to_child = edge->GetStartNode() == parent_node ? Q : 0;
 
         if (fabs(pj - pi + et) < kEPS) {
             assert(qij >= -Q);
@@ -320,7 +956,7 @@ void StarChainMarket::CheckFoundMarketParameters() {
             assert(qij >= 0);
             assert(qij <= Q);
         } else if (!edge->IsExpand() && pj - pi < -et) {
-            assert(fabs(qij + Q) < kEPS);
+            assert(fabs(qij + max_flow_to_child) < kEPS);
         } else if (edge->IsExpand() && qij < -Q) {
             assert(fabs(pj - pi + et + 2 * ev_coeff * (fabs(qij) - Q)) < kEPS);
         } else if (pj - pi > -et && pj - pi < et) {
@@ -328,7 +964,7 @@ void StarChainMarket::CheckFoundMarketParameters() {
         } else if (edge->IsExpand() && qij > Q) {
             assert(fabs(pj - pi - et - 2 * ev_coeff * (fabs(qij) - Q)) < kEPS);
         } else if (!edge->IsExpand() && pj - pi > et) {
-            assert(fabs(qij - Q) < kEPS);
+            assert(fabs(qij - max_flow_to_parent) < kEPS);
         }
     }
 }
@@ -358,100 +994,26 @@ void StarChainMarket::ClearMarketEdgesAlgorithmType() {
 }
 
 StarChainMarket StarChainMarket::LoadMarket(std::ifstream& stream) {
-    StarChainMarket market;
-    int64_t nodes_count = 0, edges_count = 0;
-    stream >> nodes_count >> edges_count;
-    std::cout << nodes_count << edges_count << std::endl;
-    std::string line;
-    std::vector<std::stringstream> tokens;
-    std::vector<Point> points;
-    std::vector<std::shared_ptr<Node>> nodes;
-    // Read info about each node
-    for (auto node_number = 0; node_number < nodes_count; node_number++) {
-        int32_t num = 0;
-        bool is_central_market_node;
-        stream >> num >> is_central_market_node;
-        // Read Supply function
-        stream.ignore(256, '\n');
-        std::getline(stream, line);
-        Point p(0, 0);
-        Split(line, tokens, ' ');
-        for (auto&& token : tokens) {
-            //std::cout << token.str() << std::endl;
-            token >> p;
-            points.emplace_back(p);
-        }
-        PiecewiseLinearFunction supply(points);
-        points.clear();
-        // Read Demand function
-        std::getline(stream, line);
-        //std::cout << line << std::endl;
-        Split(line, tokens, ' ');
-        for (auto&& token : tokens) {
-            token >> p;
-            points.emplace_back(p);
-        }
-        PiecewiseLinearFunction demand(points);
-        points.clear();
-        auto node = std::make_shared<Node>(demand, supply);
-        nodes.push_back(node);
-        market.AddNode(node, is_central_market_node);
-    }
-    for (auto edge_number = 0; edge_number < edges_count; edge_number++) {
-        long double et = 0, Q = 0, ef = 0, Ev_coeff = 0;
-        int32_t from = 0, to = 0;
-        std::string edge_type;
-        stream >> from >> to >> edge_type;
-        stream >> et >> Q >> ef >> Ev_coeff;
-        auto edge = std::make_shared<Edge>(et, Q, ef, Ev_coeff, nodes[from], nodes[to], StrToEdgeType.at(edge_type));
-        market.AddEdge(edge);
-    }
-    return market;
+    std::string text{std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+    return MarketParser(text).Parse();
 }
 
-void StarChainMarket::StoreMarket(std::ofstream& os, StarChainMarket market) {
-    os << market.GetNodes().size() << " " << market.GetEdges().size() << "\n";
-    int32_t node_number = 0;
-    auto nodes = market.GetNodes();
-    for (auto&& node : nodes) {
-        os << node_number << " " << market.IsCentralNode(node) << "\n";
-        auto points = node->GetS().GetPoints();
-        for (size_t i = 0; i < points.size(); i++) {
-            os << points[i];
-            if (i != points.size() - 1) {
-                os << " ";
-            }
-        }
-        os << "\n";
-        points = node->GetD().GetPoints();
-        for (size_t i = 0; i < points.size(); i++) {
-            os << points[i];
-            if (i != points.size() - 1) {
-                os << " ";
-            }
-        }
-        os << "\n";
-        node_number++;
-    }
+StarChainMarket StarChainMarket::LoadMarket(const std::string& path) {
+    MappedFile file(path);
+    auto data = file.GetData();
+    return MarketSnapshot::IsSnapshot(data) ? MarketSnapshot::Load(data) : MarketParser(data).Parse();
+}
 
-    for (auto&& edge : market.GetEdges()) {
-        auto from = edge->GetStartNode();
-        int32_t from_pos = -1;
-        auto to = edge->GetEndNode();
-        int32_t to_pos = -1;
-        node_number = 0;
-        for (auto&& node : nodes) {
-            if (node == from) {
-                from_pos = node_number;
-            }
-            if (node == to) {
-                to_pos = node_number;
-            }
-            node_number++;
-        }
-        os << from_pos << " " << to_pos << " " << EdgeTypeText[static_cast<int>(edge->GetEdgeType())] << "\n";
-        os << edge->Getet() << " " << edge->GetQ() << " " << edge->Getef() << " " << edge->GetEvCoeff() << "\n";
-    }
+void StarChainMarket::StoreMarket(std::ofstream& os, const StarChainMarket& market) {
+    MarketWriter(os).Write(market);
+}
+
+void StarChainMarket::StoreMarketBinary(std::ofstream& os, StarChainMarket& market) {
+    MarketSnapshot::Store(os, market);
+}
+
+StarChainMarket StarChainMarket::LoadMarketBinary(const std::string& path) {
+    return MarketSnapshot::LoadFile(path);
 }
 
 int64_t StarChainMarket::CompareWelrafeAndChangeLinesSubsetForChainLines(
@@ -476,7 +1038,7 @@ int64_t StarChainMarket::CompareWelrafeAndChangeLinesSubsetForChainLines(
             throw std::runtime_error("Invalid variant");
         }
 
-        SolveAuxiliarySubtask();
+        SolveAuxiliarySubtaskForLinesExpansion();
         tasks_solved++;
         auto welrafe_without_lines = CalculateWelfare();
 
@@ -486,7 +1048,7 @@ int64_t StarChainMarket::CompareWelrafeAndChangeLinesSubsetForChainLines(
         for (auto&& edge : l_minus_lines) {
             edge->SetLineNotExpand();
         }
-        SolveAuxiliarySubtask();
+        SolveAuxiliarySubtaskForLinesExpansion();
         tasks_solved++;
         auto welrafe_with_lines = CalculateWelfare();
         if (welrafe_without_lines <= welrafe_with_lines) {
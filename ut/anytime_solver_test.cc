@@ -0,0 +1,44 @@
+#include "anytime_solver.h"
+#include "brute_force.h"
+#include "helpers.h"
+#include <gtest/gtest.h>
+
+TEST(anytime_solver, converges_within_budget) {
+    auto market = CreateTestMarket();
+    auto best_welfare = BruteForce(market, market.GetEdges()).welfare;
+    market.ClearMarketEdgesAlgorithmType();
+
+    // Clock goes forward by tick on each reading, so deadline is reached after fixed count of checks
+    const auto tick = std::chrono::milliseconds(1);
+    const auto budget = std::chrono::milliseconds(300);
+    std::chrono::steady_clock::time_point now;
+    RandomStream random(1);
+    AnytimeSolver solver(market, budget, random);
+    solver.SetClock([&] {
+        return now += tick;
+    });
+    auto result = solver.Solve();
+    EXPECT_TRUE(result.is_converged);
+    EXPECT_TRUE(result.is_presolved);
+    // Clock is read at start, before presolve and at first deadline check of local search
+    EXPECT_EQ(result.startup_time, 2 * tick);
+    EXPECT_GT(result.restarts_count, 0);
+    // After deadline search only unwinds through a few checks without moves
+    EXPECT_GT(result.elapsed_time, budget);
+    EXPECT_LE(result.elapsed_time, budget + 5 * tick);
+    EXPECT_LE(result.welfare, best_welfare + kEPS);
+    EXPECT_NEAR(market.CalculateWelfare(), result.welfare, kEPS);
+    EXPECT_EQ(market.GetLplushLinesMask(), result.l_plus_lines_mask);
+    EXPECT_EQ(market.UndefinedLinesCount(), 0);
+}
+
+TEST(anytime_solver, zero_budget_keeps_feasible_incumbent) {
+    auto market = CreateTestMarket();
+    auto result = AnytimeSolver(market, std::chrono::milliseconds(0)).Solve();
+    EXPECT_FALSE(result.is_converged);
+    EXPECT_FALSE(result.is_presolved);
+    EXPECT_LE(result.startup_time, result.elapsed_time);
+    EXPECT_EQ(result.flip_moves_count + result.swap_moves_count + result.restarts_count, 0);
+    EXPECT_NEAR(market.CalculateWelfare(), result.welfare, kEPS);
+    EXPECT_EQ(market.UndefinedLinesCount(), 0);
+}
@@ -0,0 +1,160 @@
+#include "batch_solver.h"
+#include "brute_force.h"
+#include "helpers.h"
+#include "market_writer.h"
+#include <gtest/gtest.h>
+#include <sstream>
+
+TEST(json, parse_and_write) {
+    auto value = JsonValue::Parse(R"( {"a": [1, 2.5, -3e2], "b": "x\"\né", "c": true, "d": null} )");
+    ASSERT_TRUE(value.IsObject());
+    EXPECT_EQ(value.At("a").GetArray().size(), 3);
+    EXPECT_EQ(value.At("a").GetArray()[2].GetInteger(), -300);
+    EXPECT_EQ(value.At("b").GetString(), "x\"\n\xc3\xa9");
+    EXPECT_TRUE(value.At("c").GetBool());
+    EXPECT_TRUE(value.At("d").IsNull());
+    EXPECT_EQ(value.Find("e"), nullptr);
+    EXPECT_EQ(value.ToString(), R"({"a":[1,2.5,-300],"b":"x\"\n)" "\xc3\xa9" R"(","c":true,"d":null})");
+    EXPECT_THROW(JsonValue::Parse("{\"a\": }"), std::runtime_error);
+    EXPECT_THROW(JsonValue::Parse("[1, 2"), std::runtime_error);
+}
+
+TEST(batch_solver, requests_in_order) {
+    auto market = CreateTestMarket();
+    std::ostringstream market_text;
+    MarketWriter(market_text).Write(market);
+    std::string market_json;
+    WriteJsonString(market_json, market_text.str());
+
+    auto brute_force_market = market.Clone();
+    auto expected = BruteForce(brute_force_market, brute_force_market.GetEdges());
+    std::string expected_mask;
+    for (auto is_l_plus : expected.l_plus_lines_mask) {
+        expected_mask.push_back(is_l_plus ? '1' : '0');
+    }
+
+    std::stringstream requests;
+    const int requests_count = 12;
+    for (int i = 0; i < requests_count; i++) {
+        std::string operation = i % 3 == 0 ? R"("operation":"brute_force")" :
+                i % 3 == 1 ? R"("operation":"algorithm","options":{"local_search":false})" :
+                R"("operation":"solve_mask","mask":")" + expected_mask + "\"";
+        requests << R"({"id":)" << i << R"(,"market":{"text":)" << market_json << "}," << operation << "}\n";
+    }
+    requests << "\n" << R"({"id":"bad","market":{"text":"1 0"},"operation":"algorithm"})" << "\n";
+    requests << R"({"id":"unknown","market":{"nodes":[],"lines":[]},"operation":"algorithm"})" << "\n";
+    requests << "not json\n";
+
+    std::ostringstream results;
+    auto batch_result = BatchSolver(4, 2).Run(requests, results);
+    EXPECT_EQ(batch_result.requests_count, requests_count + 3);
+    EXPECT_EQ(batch_result.errors_count, 3);
+
+    std::istringstream results_stream(results.str());
+    std::string line;
+    int line_number = 0;
+    while (std::getline(results_stream, line)) {
+        auto result = JsonValue::Parse(line);
+        if (line_number < requests_count) {
+            EXPECT_EQ(result.At("id").GetInteger(), line_number);
+            EXPECT_EQ(result.At("status").GetString(), "ok") << line;
+            if (line_number % 3 != 1) {
+                EXPECT_NEAR(result.At("welfare").GetNumber(), expected.welfare, 1e-6);
+                EXPECT_EQ(result.At("mask").GetString(), expected_mask);
+            }
+        } else {
+            EXPECT_EQ(result.At("status").GetString(), "error");
+        }
+        line_number++;
+    }
+    EXPECT_EQ(line_number, requests_count + 3);
+}
+
+TEST(batch_solver, inline_market) {
+    auto market = CreateTestMarket();
+    auto nodes = market.GetNodes();
+    auto write_points = [](std::string& text, const std::vector<Point>& points) {
+        text += "[";
+        for (size_t i = 0; i < points.size(); i++) {
+            text += i > 0 ? ",[" : "[";
+            WriteJsonNumber(text, points[i].x_coord_);
+            text += ",";
+            WriteJsonNumber(text, points[i].y_coord_);
+            text += "]";
+        }
+        text += "]";
+    };
+    std::string market_json = R"({"nodes":[)";
+    for (size_t i = 0; i < nodes.size(); i++) {
+        market_json += i > 0 ? "," : "";
+        market_json += market.IsCentralNode(nodes[i]) ? R"({"central":true,"supply":)" : R"({"supply":)";
+        write_points(market_json, nodes[i]->GetS().GetPoints());
+        market_json += R"(,"demand":)";
+        write_points(market_json, nodes[i]->GetD().GetPoints());
+        market_json += "}";
+    }
+    market_json += R"(],"lines":[)";
+    auto edges = market.GetEdges();
+    for (size_t i = 0; i < edges.size(); i++) {
+        market_json += i > 0 ? "," : "";
+        market_json += R"({"from":)" + std::to_string(market.GetVectorPosByNode(edges[i]->GetStartNode()))
+                + R"(,"to":)" + std::to_string(market.GetVectorPosByNode(edges[i]->GetEndNode()))
+                + R"(,"type":")" + EdgeTypeText[static_cast<int>(edges[i]->GetEdgeType())] + R"(","et":)";
+        WriteJsonNumber(market_json, edges[i]->Getet());
+        market_json += R"(,"Q":)";
+        WriteJsonNumber(market_json, edges[i]->GetQ());
+        market_json += R"(,"ef":)";
+        WriteJsonNumber(market_json, edges[i]->Getef());
+        market_json += R"(,"Ev_coeff":)";
+        WriteJsonNumber(market_json, edges[i]->GetEvCoeff());
+        market_json += "}";
+    }
+    market_json += "]}";
+
+    std::string mask(edges.size(), '1');
+    bool is_error = true;
+    auto result = JsonValue::Parse(BatchSolver::SolveRequest(R"({"id":"inline","market":)" + market_json
+            + R"(,"operation":"solve_mask","mask":")" + mask + R"("})", is_error));
+    EXPECT_FALSE(is_error) << result.ToString();
+    EXPECT_EQ(result.At("id").GetString(), "inline");
+    EXPECT_EQ(result.At("mask").GetString(), mask);
+
+    for (auto&& edge : edges) {
+        edge->SetAlgorithmType(AlgorithmType::L_plus);
+    }
+    market.SolveAuxiliarySubtask();
+    EXPECT_NEAR(result.At("welfare").GetNumber(), market.CalculateWelfare(), 1e-6);
+}
+
+TEST(batch_solver, small_markets_and_invalid_topology) {
+    for (int64_t import_nodes_count : {0, 1}) {
+        std::optional<StarChainMarket> market;
+        for (uint64_t seed = 0; !market; seed++) {
+            market = StarChainMarket::GenerateRandomMarket(import_nodes_count, 0, 0, seed);
+        }
+        std::ostringstream market_text;
+        MarketWriter(market_text).Write(*market);
+        std::string market_json;
+        WriteJsonString(market_json, market_text.str());
+        bool is_error = true;
+        auto result = JsonValue::Parse(BatchSolver::SolveRequest(R"({"id":1,"market":{"text":)" + market_json
+                + R"(},"operation":"algorithm"})", is_error));
+        EXPECT_FALSE(is_error) << result.ToString();
+        EXPECT_EQ(result.At("mask").GetString().size(), size_t(import_nodes_count));
+    }
+
+    const std::string node = R"({"supply":[[0,0],[10,10]],"demand":[[0,10],[10,0]]})";
+    const std::string line = R"("type":"STAR_FROM_CENTER","et":1,"Q":1,"ef":1,"Ev_coeff":1})";
+    auto solve_inline = [&](const std::string& lines, bool& is_error) {
+        return JsonValue::Parse(BatchSolver::SolveRequest(R"({"id":1,"market":{"nodes":[)" + node + "," + node
+                + "," + node + R"(],"lines":[)" + lines + R"(]},"operation":"algorithm"})", is_error));
+    };
+    bool is_error = false;
+    auto result = solve_inline(R"({"from":0,"to":1,)" + line + R"(,{"from":1,"to":0,)" + line, is_error);
+    EXPECT_TRUE(is_error);
+    EXPECT_NE(result.At("error").GetString().find("without cycles"), std::string::npos);
+    is_error = false;
+    result = solve_inline(R"({"from":0,"to":1,)" + line + R"(,{"from":0,"to":3,)" + line, is_error);
+    EXPECT_TRUE(is_error);
+    EXPECT_NE(result.At("error").GetString().find("out of range"), std::string::npos);
+}
@@ -0,0 +1,95 @@
+#include "bit_masks_enumerator.h"
+#include <gtest/gtest.h>
+#include <set>
+
+TEST(BitMasksEnumerator, base_test) {
+    std::vector<uint64_t> masks;
+    std::vector<size_t> ones_bits_counts;
+    for (BitMasksEnumerator it(3); !it.IsEnd(); it.Next()) {
+        masks.push_back(it.GetMask());
+        ones_bits_counts.push_back(it.GetOnesBitsCount());
+    }
+    EXPECT_EQ(masks, std::vector<uint64_t>({0, 1, 2, 4, 3, 5, 6, 7}));
+    EXPECT_EQ(ones_bits_counts, std::vector<size_t>({0, 1, 1, 1, 2, 2, 2, 3}));
+}
+
+TEST(BitMasksEnumerator, ones_bits_count_bounds) {
+    std::vector<uint64_t> masks;
+    for (BitMasksEnumerator it(4, 2, 2); !it.IsEnd(); it.Next()) {
+        masks.push_back(it.GetMask());
+    }
+    EXPECT_EQ(masks, std::vector<uint64_t>({3, 5, 6, 9, 10, 12}));
+
+    BitMasksEnumerator empty(3, 4);
+    EXPECT_TRUE(empty.IsEnd());
+}
+
+TEST(BitMasksEnumerator, wide_masks) {
+    size_t count = 0;
+    for (BitMasksEnumerator it(64, 63); !it.IsEnd(); it.Next()) {
+        EXPECT_EQ(__builtin_popcountll(it.GetMask()), it.GetOnesBitsCount());
+        count++;
+    }
+    EXPECT_EQ(count, 65);
+
+    BitMasksEnumerator it(40, 1, 1);
+    for (size_t i = 0; i < 39; i++) {
+        it.Next();
+    }
+    EXPECT_EQ(it.GetMask(), uint64_t(1) << 39);
+    EXPECT_TRUE(it.IsBitSet(39));
+}
+
+TEST(MultiwordBitMasksEnumerator, same_order_as_single_word) {
+    BitMasksEnumerator single_word(10);
+    MultiwordBitMasksEnumerator multiword(10);
+    for (; !single_word.IsEnd(); single_word.Next(), multiword.Next()) {
+        ASSERT_FALSE(multiword.IsEnd());
+        EXPECT_EQ(multiword.GetMask()[0], single_word.GetMask());
+        EXPECT_EQ(multiword.GetOnesBitsCount(), single_word.GetOnesBitsCount());
+    }
+    EXPECT_TRUE(multiword.IsEnd());
+}
+
+TEST(MultiwordBitMasksEnumerator, more_than_64_bits) {
+    const size_t length = 130;
+    size_t count = 0;
+    size_t prev_highest_bit = 0;
+    for (MultiwordBitMasksEnumerator it(length, 2, 2); !it.IsEnd(); it.Next()) {
+        std::vector<size_t> bits;
+        for (size_t i = 0; i < length; i++) {
+            if (it.IsBitSet(i)) {
+                bits.push_back(i);
+            }
+        }
+        ASSERT_EQ(bits.size(), 2);
+        EXPECT_GE(bits[1], prev_highest_bit);
+        prev_highest_bit = bits[1];
+        count++;
+    }
+    EXPECT_EQ(count, length * (length - 1) / 2);
+}
+
+TEST(CountsGrayCodeEnumerator, base_test) {
+    std::vector<size_t> radices{2, 0, 3, 1};
+    std::set<std::vector<size_t>> visited;
+    CountsGrayCodeEnumerator counts(radices);
+    auto previous = counts.GetCounts();
+    visited.insert(previous);
+    for (counts.Next(); !counts.IsEnd(); counts.Next()) {
+        auto current = counts.GetCounts();
+        size_t changed_count = 0;
+        for (size_t i = 0; i < radices.size(); i++) {
+            EXPECT_LE(current[i], radices[i]);
+            if (current[i] != previous[i]) {
+                changed_count++;
+                EXPECT_EQ(i, counts.GetChangedPos());
+                EXPECT_EQ(int64_t(current[i]) - int64_t(previous[i]), counts.GetChangeDirection());
+            }
+        }
+        EXPECT_EQ(changed_count, 1);
+        visited.insert(current);
+        previous = current;
+    }
+    EXPECT_EQ(visited.size(), 3 * 1 * 4 * 2);
+}
@@ -0,0 +1,22 @@
+#include "branch_and_bound.h"
+#include "helpers.h"
+#include <gtest/gtest.h>
+
+TEST(branch_and_bound, same_as_brute_force) {
+    auto market = CreateTestMarket();
+    auto edges = market.GetEdges();
+    long double best_welfare = -1e9;
+    for (uint64_t mask = 0; mask < (uint64_t(1) << edges.size()); mask++) {
+        for (size_t i = 0; i < edges.size(); i++) {
+            edges[i]->SetAlgorithmType(((mask >> i) & 1) ? AlgorithmType::L_plus : AlgorithmType::L_minus);
+        }
+        market.SolveAuxiliarySubtask();
+        best_welfare = std::max(best_welfare, market.CalculateWelfare());
+    }
+
+    auto result = BranchAndBound(market).Solve();
+    EXPECT_NEAR(result.welfare, best_welfare, kEPS);
+    EXPECT_EQ(result.l_plus_lines_mask, market.GetLplushLinesMask());
+    EXPECT_NEAR(market.CalculateWelfare(), best_welfare, kEPS);
+    EXPECT_LT(result.explored_nodes_count, 2 * (int64_t(1) << edges.size()));
+}
@@ -0,0 +1,67 @@
+#include "brute_force.h"
+#include "helpers.h"
+#include <gtest/gtest.h>
+
+/*
+ * Star with groups of equal spokes
+ */
+static StarChainMarket CreateSymmetricTestMarket() {
+    StarChainMarket market;
+    auto add_node = [&](long double c, long double d, bool is_central_market_node = false) {
+        auto node = Node::GenerateRandomNode(c, d * c);
+        market.AddNode(node, is_central_market_node);
+        return node;
+    };
+    auto central_node = add_node(4, 5, true);
+    for (int i = 0; i < 3; i++) {
+        market.AddEdge(std::make_shared<Edge>(2, 3, 4, 2, central_node, add_node(2, 9), EdgeType::STAR_FROM_CENTER));
+    }
+    for (int i = 0; i < 2; i++) {
+        market.AddEdge(std::make_shared<Edge>(1, 4, 2, 3, add_node(5, 2), central_node, EdgeType::STAR_TO_CENTER));
+    }
+    market.AddEdge(std::make_shared<Edge>(3, 2, 5, 1, add_node(6, 3), central_node, EdgeType::STAR_TO_CENTER));
+    market.ExtendAllSupplyAndDemandFunctionsToMaxDemandZeroingPrice();
+    market.BuildTreeMinDepth();
+    return market;
+}
+
+TEST(brute_force, interchangeable_lines) {
+    auto market = CreateSymmetricTestMarket();
+    auto edges = market.GetEdges();
+    auto line_classes = market.FindInterchangeableLines(edges);
+    ASSERT_EQ(line_classes.size(), 3);
+    EXPECT_EQ(line_classes[0], std::vector<std::shared_ptr<Edge>>(edges.begin(), edges.begin() + 3));
+    EXPECT_EQ(line_classes[1], std::vector<std::shared_ptr<Edge>>(edges.begin() + 3, edges.begin() + 5));
+    EXPECT_EQ(line_classes[2].size(), 1);
+
+    // Test market has no equal spokes
+    auto test_market = CreateTestMarket();
+    EXPECT_EQ(test_market.FindInterchangeableLines(test_market.GetEdges()).size(), test_market.GetEdges().size());
+}
+
+TEST(brute_force, same_as_all_masks) {
+    std::vector<StarChainMarket> markets{CreateTestMarket(), CreateSymmetricTestMarket()};
+    for (auto& market : markets) {
+        auto edges = market.GetEdges();
+        long double best_welfare = -1e9;
+        for (uint64_t mask = 0; mask < (uint64_t(1) << edges.size()); mask++) {
+            for (size_t i = 0; i < edges.size(); i++) {
+                edges[i]->SetAlgorithmType(((mask >> i) & 1) ? AlgorithmType::L_plus : AlgorithmType::L_minus);
+            }
+            market.SolveAuxiliarySubtask();
+            best_welfare = std::max(best_welfare, market.CalculateWelfare());
+        }
+
+        auto result = BruteForce(market, edges);
+        EXPECT_NEAR(result.welfare, best_welfare, kEPS);
+        for (size_t i = 0; i < edges.size(); i++) {
+            edges[i]->SetAlgorithmType(result.l_plus_lines_mask[i] ? AlgorithmType::L_plus : AlgorithmType::L_minus);
+        }
+        market.SolveAuxiliarySubtask();
+        EXPECT_NEAR(market.CalculateWelfare(), best_welfare, kEPS);
+    }
+
+    // Counts of L_plus lines among 3, 2 and 1 equal spokes instead of 2^6 masks
+    auto market = CreateSymmetricTestMarket();
+    EXPECT_EQ(BruteForce(market, market.GetEdges()).configurations_count, 4 * 3 * 2);
+}
@@ -1,8 +1,41 @@
 #pragma once
 #include <utils.h>
+#include "star_chain_market.h"
 
-static auto GenerateFunctionDomain() {
+inline auto GenerateFunctionDomain() {
     auto vec = GenerateVectorOfValues(-10000, 10000, 2);
     Segment function_domain(vec[0], vec[1]);
     return function_domain;
 }
+
+/*
+ * Star with import and export lines plus chain, same shape as StarChainMarket::GenerateRandomMarket
+ * but with fixed node and line parameters, capacities of lines are multiplied by capacity scale
+ */
+inline StarChainMarket CreateTestMarket(long double capacity_scale = 1) {
+    StarChainMarket market;
+    auto add_node = [&](long double c, long double d, bool is_central_market_node = false) {
+        auto node = Node::GenerateRandomNode(c, d * c);
+        market.AddNode(node, is_central_market_node);
+        return node;
+    };
+    auto central_node = add_node(4, 5, true);
+    auto import_node1 = add_node(2, 9);
+    auto import_node2 = add_node(3, 7);
+    auto export_node1 = add_node(5, 2);
+    auto export_node2 = add_node(6, 3);
+    auto chain_node1 = add_node(2, 8);
+    auto chain_node2 = add_node(7, 4);
+    auto chain_node3 = add_node(3, 6);
+
+    market.AddEdge(std::make_shared<Edge>(2, 3 * capacity_scale, 4, 2, central_node, import_node1, EdgeType::STAR_FROM_CENTER));
+    market.AddEdge(std::make_shared<Edge>(1, 2 * capacity_scale, 3, 5, central_node, import_node2, EdgeType::STAR_FROM_CENTER));
+    market.AddEdge(std::make_shared<Edge>(1, 4 * capacity_scale, 2, 3, export_node1, central_node, EdgeType::STAR_TO_CENTER));
+    market.AddEdge(std::make_shared<Edge>(3, 2 * capacity_scale, 5, 1, export_node2, central_node, EdgeType::STAR_TO_CENTER));
+    market.AddEdge(std::make_shared<Edge>(1, 3 * capacity_scale, 2, 4, central_node, chain_node1, EdgeType::CHAIN_FROM_CENTER));
+    market.AddEdge(std::make_shared<Edge>(2, 5 * capacity_scale, 3, 2, chain_node2, chain_node1, EdgeType::CHAIN_TO_CENTER));
+    market.AddEdge(std::make_shared<Edge>(1, 2 * capacity_scale, 2, 6, chain_node2, chain_node3, EdgeType::CHAIN_FROM_CENTER));
+    market.ExtendAllSupplyAndDemandFunctionsToMaxDemandZeroingPrice();
+    market.BuildTreeMinDepth();
+    return market;
+}
@@ -0,0 +1,120 @@
+#include "algorithm.h"
+#include "lines_worklist.h"
+#include "helpers.h"
+#include <gtest/gtest.h>
+
+TEST(lines_worklist, lines_tested_once_without_changes) {
+    auto market = CreateTestMarket();
+    LinesWorklist worklist(market);
+    int tasks_solved = 0;
+    // Comparison which never holds leaves all lines undefined
+    auto never = [](long double, long double) { return false; };
+    for (auto line_type : {EdgeType::STAR_TO_CENTER, EdgeType::STAR_FROM_CENTER,
+            EdgeType::CHAIN_TO_CENTER, EdgeType::CHAIN_FROM_CENTER}) {
+        EXPECT_EQ(worklist.Process(line_type, ConcurentTypes, AlgorithmType::L_plus, never, tasks_solved), 0);
+    }
+    EXPECT_EQ(worklist.GetTestsCount(), int64_t(market.GetEdges().size()));
+    // Constant comparison is decided by expansion bound, solve with line is skipped
+    EXPECT_EQ(tasks_solved, int(market.GetEdges().size()));
+
+    for (auto line_type : {EdgeType::STAR_TO_CENTER, EdgeType::STAR_FROM_CENTER,
+            EdgeType::CHAIN_TO_CENTER, EdgeType::CHAIN_FROM_CENTER}) {
+        worklist.Process(line_type, ConcurentTypes, AlgorithmType::L_plus, never, tasks_solved);
+    }
+    EXPECT_EQ(worklist.GetTestsCount(), int64_t(market.GetEdges().size()));
+    for (auto&& edge : market.GetEdges()) {
+        EXPECT_FALSE(worklist.IsPending(edge, AlgorithmType::L_plus));
+        EXPECT_TRUE(worklist.IsPending(edge, AlgorithmType::L_minus));
+    }
+}
+
+TEST(lines_worklist, decision_requeues_all_lines) {
+    auto market = CreateTestMarket();
+    LinesWorklist worklist(market);
+    auto edges = market.GetEdges();
+    int tasks_solved = 0;
+    auto never = [](long double, long double) { return false; };
+    for (auto line_type : {EdgeType::STAR_TO_CENTER, EdgeType::STAR_FROM_CENTER,
+            EdgeType::CHAIN_TO_CENTER, EdgeType::CHAIN_FROM_CENTER}) {
+        worklist.Process(line_type, ConcurentTypes, AlgorithmType::L_plus, never, tasks_solved);
+    }
+
+    // Decision changes the root price, which comparisons of lines in all subtrees read
+    edges[0]->SetAlgorithmType(AlgorithmType::L_plus);
+    worklist.LineDecided(edges[0]);
+    for (size_t i = 1; i < edges.size(); i++) {
+        EXPECT_TRUE(worklist.IsPending(edges[i], AlgorithmType::L_plus));
+        EXPECT_TRUE(worklist.IsPending(edges[i], AlgorithmType::L_minus));
+    }
+}
+
+TEST(lines_worklist, star_same_types_as_full_rescan) {
+    int compared_markets_count = 0;
+    for (uint64_t seed = 0; seed < 10; seed++) {
+        auto generated_market = StarChainMarket::GenerateRandomMarket(5, 5, 0, seed);
+        if (!generated_market) {
+            continue;
+        }
+        compared_markets_count++;
+        generated_market->BuildTreeMinDepth();
+        auto rescanned_market = generated_market->Clone();
+        int tasks_solved = 0;
+        LinesWorklist worklist(*generated_market);
+        AlgorithmProcessStarEdges(*generated_market, worklist, tasks_solved);
+
+        // All undefined lines are compared in each pass
+        int64_t changed_lines = 0;
+        do {
+            changed_lines = 0;
+            changed_lines += rescanned_market.CompareWelrafeAndChangeLinesSubset(EdgeType::STAR_TO_CENTER,
+                    ConcurentTypes, AlgorithmType::L_plus, std::less_equal<>(), tasks_solved);
+            changed_lines += rescanned_market.CompareWelrafeAndChangeLinesSubset(EdgeType::STAR_FROM_CENTER,
+                    AdditionalTypes, AlgorithmType::L_minus, std::greater_equal<>(), tasks_solved);
+            changed_lines += rescanned_market.CompareWelrafeAndChangeLinesSubset(EdgeType::STAR_TO_CENTER,
+                    AdditionalTypes, AlgorithmType::L_minus, std::greater_equal<>(), tasks_solved);
+            changed_lines += rescanned_market.CompareWelrafeAndChangeLinesSubset(EdgeType::STAR_FROM_CENTER,
+                    ConcurentTypes, AlgorithmType::L_plus, std::less_equal<>(), tasks_solved);
+        } while (rescanned_market.UndefinedLinesCount() && changed_lines > 0);
+
+        auto edges = generated_market->GetEdges();
+        auto rescanned_edges = rescanned_market.GetEdges();
+        ASSERT_EQ(edges.size(), rescanned_edges.size());
+        for (size_t i = 0; i < edges.size(); i++) {
+            EXPECT_EQ(edges[i]->GetAlgorithmType(), rescanned_edges[i]->GetAlgorithmType()) << "seed " << seed;
+        }
+    }
+    EXPECT_GT(compared_markets_count, 0);
+}
+
+TEST(lines_worklist, impact_order) {
+    auto market = CreateTestMarket();
+    market.SolveAuxiliarySubtask();
+    LinesWorklist worklist(market);
+    auto lines = market.GetEdges();
+    worklist.RankLines(lines, AlgorithmType::L_plus);
+    EXPECT_EQ(lines, market.GetEdges());
+
+    worklist.SetLinesOrderPolicy(LinesOrderPolicy::IMPACT);
+    for (auto result_line_type : {AlgorithmType::L_plus, AlgorithmType::L_minus}) {
+        worklist.RankLines(lines, result_line_type);
+        for (size_t i = 1; i < lines.size(); i++) {
+            auto previous = market.EstimateLineImpact(lines[i - 1]);
+            auto current = market.EstimateLineImpact(lines[i]);
+            if (result_line_type == AlgorithmType::L_plus) {
+                EXPECT_GE(previous, current);
+            } else {
+                EXPECT_LE(previous, current);
+            }
+        }
+    }
+    // Market is solved without expanded lines, so some lines are saturated with price gap
+    EXPECT_GT(market.EstimateLineImpact(lines.back()), 0);
+
+    int tasks_solved = 0;
+    auto never = [](long double, long double) { return false; };
+    worklist.Process(EdgeType::STAR_TO_CENTER, ConcurentTypes, AlgorithmType::L_plus, never, tasks_solved);
+    // Market is solved once with current types before ranking, constant comparisons are decided by bound
+    EXPECT_EQ(tasks_solved, worklist.GetTestsCount() + 1);
+    worklist.Process(EdgeType::STAR_TO_CENTER, ConcurentTypes, AlgorithmType::L_plus, never, tasks_solved);
+    EXPECT_EQ(worklist.GetPassesCount(), 1);
+}
@@ -0,0 +1,75 @@
+#include "local_search.h"
+#include "brute_force.h"
+#include "helpers.h"
+#include <gtest/gtest.h>
+
+TEST(local_search, reaches_local_optimum) {
+    auto market = CreateTestMarket();
+    auto edges = market.GetEdges();
+    auto best_welfare = BruteForce(market, edges).welfare;
+    for (auto&& edge : edges) {
+        edge->SetAlgorithmType(AlgorithmType::L_minus);
+    }
+    market.SolveAuxiliarySubtask();
+    auto start_welfare = market.CalculateWelfare();
+
+    auto result = LocalSearch(market, edges).Solve();
+    EXPECT_TRUE(result.is_local_optimum);
+    EXPECT_GE(result.welfare, start_welfare - kEPS);
+    EXPECT_LE(result.welfare, best_welfare + kEPS);
+    EXPECT_NEAR(market.CalculateWelfare(), result.welfare, kEPS);
+    EXPECT_EQ(market.GetLplushLinesMask(), result.l_plus_lines_mask);
+
+    // No single flip improves result
+    for (auto welfare : market.CalculateWelfareWithEachLineFlipped()) {
+        EXPECT_LE(welfare, result.welfare + kEPS);
+    }
+    // No swap improves result
+    for (auto&& l_plus_line : edges) {
+        for (auto&& l_minus_line : edges) {
+            if (l_plus_line->GetAlgorithmType() != AlgorithmType::L_plus
+                    || l_minus_line->GetAlgorithmType() != AlgorithmType::L_minus) {
+                continue;
+            }
+            l_plus_line->SetAlgorithmType(AlgorithmType::L_minus);
+            l_minus_line->SetAlgorithmType(AlgorithmType::L_plus);
+            market.SolveAuxiliarySubtask();
+            EXPECT_LE(market.CalculateWelfare(), result.welfare + kEPS);
+            l_plus_line->SetAlgorithmType(AlgorithmType::L_plus);
+            l_minus_line->SetAlgorithmType(AlgorithmType::L_minus);
+        }
+    }
+}
+
+TEST(local_search, restarts_keep_best) {
+    auto market = CreateTestMarket();
+    auto edges = market.GetEdges();
+    for (auto&& edge : edges) {
+        edge->SetAlgorithmType(AlgorithmType::L_plus);
+    }
+    auto single_descent_welfare = LocalSearch(market, edges).Solve().welfare;
+    for (auto&& edge : edges) {
+        edge->SetAlgorithmType(AlgorithmType::L_plus);
+    }
+    auto result = LocalSearch(market, edges).Solve(10);
+    EXPECT_EQ(result.restarts_count, 10);
+    EXPECT_GE(result.welfare, single_descent_welfare - kEPS);
+    EXPECT_NEAR(market.CalculateWelfare(), result.welfare, kEPS);
+}
+
+TEST(local_search, restarts_reproduced_by_random_stream) {
+    auto market = CreateTestMarket();
+    auto edges = market.GetEdges();
+    std::vector<LocalSearchResult> results;
+    for (int run = 0; run < 2; run++) {
+        for (auto&& edge : edges) {
+            edge->SetAlgorithmType(AlgorithmType::L_plus);
+        }
+        RandomStream random(7);
+        results.push_back(LocalSearch(market, edges, random).Solve(5));
+    }
+    EXPECT_EQ(results[0].l_plus_lines_mask, results[1].l_plus_lines_mask);
+    EXPECT_EQ(results[0].flip_moves_count, results[1].flip_moves_count);
+    EXPECT_EQ(results[0].swap_moves_count, results[1].swap_moves_count);
+    EXPECT_EQ(results[0].solved_subtasks_count, results[1].solved_subtasks_count);
+}
@@ -0,0 +1,157 @@
+#include "market_generator.h"
+#include "market_parser.h"
+#include "helpers.h"
+#include <gtest/gtest.h>
+#include <sstream>
+
+static MarketGeneratorOptions CreateTestOptions(size_t threads_count) {
+    MarketGeneratorOptions options;
+    options.import_star_nodes_count = 3;
+    options.export_star_nodes_count = 4;
+    options.chains_count = 2;
+    options.chain_length = 5;
+    options.seed = 42;
+    options.threads_count = threads_count;
+    options.block_size = 3;
+    return options;
+}
+
+static void ExpectSameMarkets(StarChainMarket& lhs, StarChainMarket& rhs) {
+    auto lhs_nodes = lhs.GetNodes();
+    auto rhs_nodes = rhs.GetNodes();
+    auto lhs_edges = lhs.GetEdges();
+    auto rhs_edges = rhs.GetEdges();
+    ASSERT_EQ(lhs_nodes.size(), rhs_nodes.size());
+    ASSERT_EQ(lhs_edges.size(), rhs_edges.size());
+    for (size_t i = 0; i < lhs_nodes.size(); i++) {
+        EXPECT_EQ(lhs.IsCentralNode(lhs_nodes[i]), rhs.IsCentralNode(rhs_nodes[i]));
+        auto lhs_points = lhs_nodes[i]->GetS().GetPoints();
+        auto rhs_points = rhs_nodes[i]->GetS().GetPoints();
+        ASSERT_EQ(lhs_points.size(), rhs_points.size());
+        for (size_t j = 0; j < lhs_points.size(); j++) {
+            EXPECT_EQ(lhs_points[j].x_coord_, rhs_points[j].x_coord_);
+            EXPECT_EQ(lhs_points[j].y_coord_, rhs_points[j].y_coord_);
+        }
+        EXPECT_EQ(lhs.GetMatrix()[i].size(), rhs.GetMatrix()[i].size());
+    }
+    for (size_t i = 0; i < lhs_edges.size(); i++) {
+        auto lhs_edge = lhs_edges[i];
+        auto rhs_edge = rhs_edges[i];
+        EXPECT_EQ(lhs.GetVectorPosByNode(lhs_edge->GetStartNode()), rhs.GetVectorPosByNode(rhs_edge->GetStartNode()));
+        EXPECT_EQ(lhs.GetVectorPosByNode(lhs_edge->GetEndNode()), rhs.GetVectorPosByNode(rhs_edge->GetEndNode()));
+        EXPECT_EQ(lhs_edge->GetEdgeType(), rhs_edge->GetEdgeType());
+        EXPECT_EQ(lhs_edge->Getet(), rhs_edge->Getet());
+        EXPECT_EQ(lhs_edge->GetQ(), rhs_edge->GetQ());
+        EXPECT_EQ(lhs_edge->Getef(), rhs_edge->Getef());
+        EXPECT_EQ(lhs_edge->GetEvCoeff(), rhs_edge->GetEvCoeff());
+    }
+}
+
+TEST(market_generator, text_and_binary_match_generated) {
+    MarketGenerator generator(CreateTestOptions(3));
+    EXPECT_EQ(generator.GetNodesCount(), 18);
+    EXPECT_EQ(generator.GetLinesCount(), 17);
+    auto market = generator.Generate();
+
+    std::ostringstream text;
+    generator.WriteText(text);
+    auto parsed = MarketParser(text.str()).Parse();
+    ExpectSameMarkets(market, parsed);
+
+    auto path = ::testing::TempDir() + "market_generator_test.bin";
+    {
+        std::ofstream os(path, std::ios_base::binary);
+        generator.WriteBinary(os);
+    }
+    auto loaded = MarketSnapshot::LoadFile(path);
+    ExpectSameMarkets(market, loaded);
+
+    // Binary is the same as snapshot of generated market
+    std::ostringstream generated_binary, stored_binary;
+    generator.WriteBinary(generated_binary);
+    MarketSnapshot::Store(stored_binary, market);
+    EXPECT_TRUE(generated_binary.str() == stored_binary.str());
+}
+
+TEST(market_generator, more_nodes_than_random_ids_range) {
+    MarketGeneratorOptions options;
+    options.import_star_nodes_count = 4000;
+    options.export_star_nodes_count = 4000;
+    options.chains_count = 2;
+    options.chain_length = 2000;
+    options.block_size = 1000;
+    MarketGenerator generator(options);
+    auto market = generator.Generate();
+    ASSERT_EQ(market.GetNodes().size(), generator.GetNodesCount());
+
+    std::ostringstream text;
+    generator.WriteText(text);
+    auto parsed = MarketParser(text.str()).Parse();
+    ExpectSameMarkets(market, parsed);
+
+    std::ostringstream binary;
+    generator.WriteBinary(binary);
+    auto path = ::testing::TempDir() + "market_generator_large_test.bin";
+    {
+        std::ofstream os(path, std::ios_base::binary);
+        os << binary.str();
+    }
+    auto loaded = MarketSnapshot::LoadFile(path);
+    ExpectSameMarkets(market, loaded);
+}
+
+TEST(market_generator, independent_of_threads) {
+    std::ostringstream single_thread_text, threads_text;
+    MarketGenerator(CreateTestOptions(1)).WriteText(single_thread_text);
+    MarketGenerator(CreateTestOptions(4)).WriteText(threads_text);
+    EXPECT_TRUE(single_thread_text.str() == threads_text.str());
+
+    auto options = CreateTestOptions(1);
+    options.seed = 43;
+    std::ostringstream another_seed_text;
+    MarketGenerator(options).WriteText(another_seed_text);
+    EXPECT_TRUE(single_thread_text.str() != another_seed_text.str());
+}
+
+TEST(market_generator, market_is_solved) {
+    for (uint64_t seed = 0; seed < 5; seed++) {
+        auto options = CreateTestOptions(2);
+        options.seed = seed;
+        auto market = MarketGenerator(options).Generate();
+        market.BuildTreeMinDepth();
+        for (auto&& edge : market.GetEdges()) {
+            edge->SetAlgorithmType(AlgorithmType::L_minus);
+        }
+        market.SolveAuxiliarySubtask();
+        EXPECT_NO_THROW(market.CheckFoundMarketParameters());
+    }
+}
+
+TEST(market_generator, same_parameters_as_random_market) {
+    MarketGeneratorOptions options;
+    options.import_star_nodes_count = 2;
+    options.export_star_nodes_count = 3;
+    options.chains_count = 1;
+    options.chain_length = 4;
+    options.seed = 11;
+    auto generated = MarketGenerator(options).Generate();
+    auto market = StarChainMarket::GenerateRandomMarket(2, 3, 4, 11).value();
+    ASSERT_EQ(generated.GetNodes().size(), market.GetNodes().size());
+    for (size_t i = 0; i < market.GetNodes().size(); i++) {
+        EXPECT_EQ(generated.GetNodes()[i]->GetZeroPrice(), market.GetNodes()[i]->GetZeroPrice());
+    }
+    ASSERT_EQ(generated.GetEdges().size(), market.GetEdges().size());
+    for (size_t i = 0; i < market.GetEdges().size(); i++) {
+        auto generated_edge = generated.GetEdges()[i];
+        auto edge = market.GetEdges()[i];
+        EXPECT_EQ(generated.GetVectorPosByNode(generated_edge->GetStartNode()),
+                market.GetVectorPosByNode(edge->GetStartNode()));
+        EXPECT_EQ(generated.GetVectorPosByNode(generated_edge->GetEndNode()),
+                market.GetVectorPosByNode(edge->GetEndNode()));
+        EXPECT_EQ(generated_edge->GetEdgeType(), edge->GetEdgeType());
+        EXPECT_EQ(generated_edge->Getet(), edge->Getet());
+        EXPECT_EQ(generated_edge->GetQ(), edge->GetQ());
+        EXPECT_EQ(generated_edge->Getef(), edge->Getef());
+        EXPECT_EQ(generated_edge->GetEvCoeff(), edge->GetEvCoeff());
+    }
+}
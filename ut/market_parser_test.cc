@@ -0,0 +1,109 @@
+#include "market_parser.h"
+#include "market_generator.h"
+#include "market_writer.h"
+#include "helpers.h"
+#include <gtest/gtest.h>
+#include <sstream>
+
+static std::string StoreMarketToString(StarChainMarket& market, const std::string& path) {
+    {
+        std::ofstream os(path);
+        StarChainMarket::StoreMarket(os, market);
+    }
+    std::ifstream is(path);
+    std::stringstream text;
+    text << is.rdbuf();
+    return text.str();
+}
+
+TEST(market_parser, store_and_load) {
+    auto market = CreateTestMarket();
+    auto path = ::testing::TempDir() + "market_parser_test.txt";
+    auto text = StoreMarketToString(market, path);
+
+    auto loaded = StarChainMarket::LoadMarket(path);
+    ASSERT_EQ(loaded.GetNodes().size(), market.GetNodes().size());
+    ASSERT_EQ(loaded.GetEdges().size(), market.GetEdges().size());
+    for (size_t i = 0; i < market.GetNodes().size(); i++) {
+        EXPECT_EQ(loaded.IsCentralNode(loaded.GetNodes()[i]), market.IsCentralNode(market.GetNodes()[i]));
+    }
+    for (size_t i = 0; i < market.GetEdges().size(); i++) {
+        EXPECT_EQ(loaded.GetEdges()[i]->GetEdgeType(), market.GetEdges()[i]->GetEdgeType());
+        EXPECT_EQ(loaded.GetVectorPosByNode(loaded.GetEdges()[i]->GetStartNode()),
+                market.GetVectorPosByNode(market.GetEdges()[i]->GetStartNode()));
+    }
+    EXPECT_EQ(StoreMarketToString(loaded, path), text);
+
+    std::ifstream stream(path);
+    auto stream_loaded = StarChainMarket::LoadMarket(stream);
+    EXPECT_EQ(StoreMarketToString(stream_loaded, path), text);
+}
+
+TEST(market_parser, errors_with_position) {
+    auto expect_error = [](const std::string& text, const std::string& position) {
+        try {
+            MarketParser(text).Parse();
+            FAIL() << "No error for " << text;
+        } catch (const std::runtime_error& error) {
+            EXPECT_NE(std::string(error.what()).find(position), std::string::npos) << error.what();
+        }
+    };
+    expect_error("", "line 1 column 1");
+    expect_error("1 0\n0 1\n(0,0) (1,1)\n(0,1) (1;0)\n", "line 4 column 9");
+    expect_error("1 1\n0 1\n(0,0) (1,1)\n(0,1) (1,0)\n0 1 STAR_TO_CENTER\n1 2 3 4\n", "line 5 column 3");
+    expect_error("1 1\n0 1\n(0,0) (1,1)\n(0,1) (1,0)\n0 0 STAR\n1 2 3 4\n", "line 5 column 5");
+}
+
+TEST(market_parser, exact_round_trip) {
+    auto market = StarChainMarket::GenerateRandomMarket(2, 3, 4);
+    ASSERT_TRUE(market);
+    std::ostringstream os;
+    {
+        // Small buffer is flushed many times
+        MarketWriter writer(os, 1);
+        writer.Write(*market);
+    }
+    auto text = os.str();
+    auto loaded = MarketParser(text).Parse();
+    ASSERT_EQ(loaded.GetNodes().size(), market->GetNodes().size());
+    for (size_t i = 0; i < loaded.GetNodes().size(); i++) {
+        auto points = loaded.GetNodes()[i]->GetD().GetPoints();
+        auto expected_points = market->GetNodes()[i]->GetD().GetPoints();
+        ASSERT_EQ(points.size(), expected_points.size());
+        for (size_t j = 0; j < points.size(); j++) {
+            EXPECT_EQ(points[j].x_coord_, expected_points[j].x_coord_);
+            EXPECT_EQ(points[j].y_coord_, expected_points[j].y_coord_);
+        }
+    }
+    ASSERT_EQ(loaded.GetEdges().size(), market->GetEdges().size());
+    for (size_t i = 0; i < loaded.GetEdges().size(); i++) {
+        EXPECT_EQ(loaded.GetEdges()[i]->Getet(), market->GetEdges()[i]->Getet());
+        EXPECT_EQ(loaded.GetEdges()[i]->GetEvCoeff(), market->GetEdges()[i]->GetEvCoeff());
+    }
+
+    market->BuildTreeMinDepth();
+    market->SolveAuxiliarySubtask();
+    loaded.BuildTreeMinDepth();
+    loaded.SolveAuxiliarySubtask();
+    EXPECT_EQ(market->CalculateWelfare(), loaded.CalculateWelfare());
+}
+
+TEST(market_parser, more_nodes_than_random_ids_range) {
+    MarketGeneratorOptions options;
+    options.import_star_nodes_count = 4000;
+    options.export_star_nodes_count = 4000;
+    options.chains_count = 2;
+    options.chain_length = 2000;
+    MarketGenerator generator(options);
+    std::ostringstream os;
+    generator.WriteText(os);
+
+    auto loaded = MarketParser(os.str()).Parse();
+    auto nodes = loaded.GetNodes();
+    ASSERT_EQ(nodes.size(), generator.GetNodesCount());
+    ASSERT_EQ(loaded.GetEdges().size(), generator.GetLinesCount());
+    for (size_t i = 0; i < nodes.size(); i++) {
+        ASSERT_EQ(loaded.GetVectorPosByNode(nodes[i]), static_cast<int64_t>(i));
+    }
+    EXPECT_TRUE(loaded.IsTree());
+}
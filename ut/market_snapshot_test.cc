@@ -0,0 +1,111 @@
+#include "market_snapshot.h"
+#include "market_generator.h"
+#include "helpers.h"
+#include <gtest/gtest.h>
+
+static void ExpectSameMarkets(StarChainMarket& lhs, StarChainMarket& rhs) {
+    ASSERT_EQ(lhs.GetNodes().size(), rhs.GetNodes().size());
+    ASSERT_EQ(lhs.GetEdges().size(), rhs.GetEdges().size());
+    for (size_t i = 0; i < lhs.GetNodes().size(); i++) {
+        auto lhs_node = lhs.GetNodes()[i];
+        auto rhs_node = rhs.GetNodes()[i];
+        EXPECT_EQ(lhs.IsCentralNode(lhs_node), rhs.IsCentralNode(rhs_node));
+        for (auto&& [lhs_points, rhs_points] : {std::make_pair(lhs_node->GetS().GetPoints(), rhs_node->GetS().GetPoints()),
+                std::make_pair(lhs_node->GetD().GetPoints(), rhs_node->GetD().GetPoints())}) {
+            ASSERT_EQ(lhs_points.size(), rhs_points.size());
+            for (size_t j = 0; j < lhs_points.size(); j++) {
+                EXPECT_EQ(lhs_points[j].x_coord_, rhs_points[j].x_coord_);
+                EXPECT_EQ(lhs_points[j].y_coord_, rhs_points[j].y_coord_);
+            }
+        }
+    }
+    for (size_t i = 0; i < lhs.GetEdges().size(); i++) {
+        auto lhs_edge = lhs.GetEdges()[i];
+        auto rhs_edge = rhs.GetEdges()[i];
+        EXPECT_EQ(lhs.GetVectorPosByNode(lhs_edge->GetStartNode()), rhs.GetVectorPosByNode(rhs_edge->GetStartNode()));
+        EXPECT_EQ(lhs.GetVectorPosByNode(lhs_edge->GetEndNode()), rhs.GetVectorPosByNode(rhs_edge->GetEndNode()));
+        EXPECT_EQ(lhs_edge->GetEdgeType(), rhs_edge->GetEdgeType());
+        EXPECT_EQ(lhs_edge->Getet(), rhs_edge->Getet());
+        EXPECT_EQ(lhs_edge->GetQ(), rhs_edge->GetQ());
+        EXPECT_EQ(lhs_edge->Getef(), rhs_edge->Getef());
+        EXPECT_EQ(lhs_edge->GetEvCoeff(), rhs_edge->GetEvCoeff());
+    }
+}
+
+TEST(market_snapshot, store_and_load) {
+    auto market = StarChainMarket::GenerateRandomMarket(2, 3, 4);
+    ASSERT_TRUE(market);
+    // Parameters which double can't represent are kept exactly
+    for (auto&& edge : market->GetEdges()) {
+        edge->SetParameters(edge->Getet() + 1.0L / 3, edge->GetQ() + 1.0L / 7, edge->Getef() + 1.0L / 11,
+                edge->GetEvCoeff() + 1.0L / 13);
+    }
+    auto clone = market->Clone();
+    ExpectSameMarkets(*market, clone);
+    auto path = ::testing::TempDir() + "market_snapshot_test.bin";
+    {
+        std::ofstream os(path, std::ios_base::binary);
+        StarChainMarket::StoreMarketBinary(os, *market);
+    }
+    auto loaded = StarChainMarket::LoadMarketBinary(path);
+    ExpectSameMarkets(*market, loaded);
+
+    market->BuildTreeMinDepth();
+    market->SolveAuxiliarySubtask();
+    loaded.BuildTreeMinDepth();
+    loaded.SolveAuxiliarySubtask();
+    EXPECT_EQ(market->CalculateWelfare(), loaded.CalculateWelfare());
+}
+
+TEST(market_snapshot, more_nodes_than_random_ids_range) {
+    MarketGeneratorOptions options;
+    options.import_star_nodes_count = 4000;
+    options.export_star_nodes_count = 4000;
+    options.chains_count = 2;
+    options.chain_length = 2000;
+    MarketGenerator generator(options);
+    std::ostringstream generated;
+    generator.WriteBinary(generated);
+    auto path = ::testing::TempDir() + "market_snapshot_large_test.bin";
+    {
+        std::ofstream os(path, std::ios_base::binary);
+        os << generated.str();
+    }
+
+    auto loaded = StarChainMarket::LoadMarketBinary(path);
+    auto nodes = loaded.GetNodes();
+    ASSERT_EQ(nodes.size(), generator.GetNodesCount());
+    for (size_t i = 0; i < nodes.size(); i++) {
+        ASSERT_EQ(loaded.GetVectorPosByNode(nodes[i]), static_cast<int64_t>(i));
+    }
+    std::ostringstream stored;
+    MarketSnapshot::Store(stored, loaded);
+    EXPECT_TRUE(stored.str() == generated.str());
+}
+
+TEST(market_snapshot, invalid_snapshot) {
+    auto market = CreateTestMarket();
+    auto path = ::testing::TempDir() + "market_snapshot_test.bin";
+    std::string data;
+    {
+        std::ostringstream os;
+        MarketSnapshot::Store(os, market);
+        data = os.str();
+    }
+    auto store = [&](const std::string& file_data) {
+        std::ofstream os(path, std::ios_base::binary);
+        os.write(file_data.data(), file_data.size());
+    };
+
+    store(data.substr(0, data.size() - 16));
+    EXPECT_THROW(MarketSnapshot::LoadFile(path), std::runtime_error);
+    auto other_version = data;
+    other_version[offsetof(MarketSnapshot::Header, version)]++;
+    store(other_version);
+    EXPECT_THROW(MarketSnapshot::LoadFile(path), std::runtime_error);
+    store("(0,0) (1,1)");
+    EXPECT_THROW(MarketSnapshot::LoadFile(path), std::runtime_error);
+    store(data);
+    auto loaded = MarketSnapshot::LoadFile(path);
+    ExpectSameMarkets(market, loaded);
+}
@@ -405,3 +405,43 @@ TEST(piecewise_linear_function, multiply_horizontal_segments) {
     PiecewiseLinearFunction f(funcs, Segment(0, 4));
     EXPECT_EQ(f.GetFunctions().size(), 1);
 }
+
+TEST(piecewise_linear_function, remove_empty_segments) {
+    PiecewiseLinearFunction func({Point(0, 0), Point(1, 1), Point(1, 1), Point(1, 2), Point(2, 4)});
+    EXPECT_EQ(func.GetFunctions().size(), 4);
+
+    auto result = func.RemoveEmptySegments();
+    EXPECT_EQ(result.GetFunctions().size(), 3);
+    EXPECT_FLOAT_EQ(result.GetFunctionDomain().GetStart(), 0);
+    EXPECT_FLOAT_EQ(result.GetFunctionDomain().GetEnd(), 2);
+    EXPECT_FLOAT_EQ(result.GetValueAtPoint(1).GetStart(), 1);
+    EXPECT_FLOAT_EQ(result.GetValueAtPoint(1).GetEnd(), 2);
+    EXPECT_FLOAT_EQ(result.GetValueAtPoint(1.5).GetSinglePoint(), 3);
+    EXPECT_NO_THROW(result.GetInverseFunction());
+}
+
+TEST(piecewise_linear_function, borrowed_functions) {
+    auto owner = std::make_shared<std::vector<LinearFunctionDefineOnSegment>>(
+            PiecewiseLinearFunction({Point(0, 0), Point(1, 1), Point(1, 2), Point(3, 4)}).GetFunctions());
+    PiecewiseLinearFunction func(LinearFunctionsStorage(owner, owner->data(), owner->size()));
+    EXPECT_TRUE(func.GetFunctionsStorage().IsBorrowed());
+    EXPECT_FLOAT_EQ(func.GetFunctionDomain().GetStart(), 0);
+    EXPECT_FLOAT_EQ(func.GetFunctionDomain().GetEnd(), 3);
+    EXPECT_FLOAT_EQ(func.GetValueAtPoint(2).GetSinglePoint(), 3);
+
+    // Copy shares functions, change copies them first
+    auto copy = func;
+    EXPECT_EQ(copy.GetFunctionsStorage().begin(), owner->data());
+    copy.Shift(1);
+    EXPECT_FALSE(copy.GetFunctionsStorage().IsBorrowed());
+    EXPECT_FLOAT_EQ(copy.GetValueAtPoint(2).GetSinglePoint(), 4);
+    EXPECT_FLOAT_EQ(func.GetValueAtPoint(2).GetSinglePoint(), 3);
+    copy.ExtendFunctionDomain(5);
+    EXPECT_FLOAT_EQ(func.GetFunctionDomain().GetEnd(), 3);
+
+    // Functions which are not valid are not borrowed
+    std::vector<LinearFunctionDefineOnSegment> gap{LinearFunctionDefineOnSegment(Point(0, 0), Point(1, 1)),
+            LinearFunctionDefineOnSegment(Point(2, 1), Point(3, 2))};
+    EXPECT_THROW(PiecewiseLinearFunction(LinearFunctionsStorage(owner, gap.data(), gap.size())), std::runtime_error);
+    EXPECT_THROW(PiecewiseLinearFunction(LinearFunctionsStorage(owner, owner->data(), 0)), std::runtime_error);
+}
@@ -0,0 +1,46 @@
+#include "brute_force.h"
+#include "helpers.h"
+#include "portfolio_solver.h"
+#include <gtest/gtest.h>
+
+TEST(portfolio_solver, clone_is_independent) {
+    auto market = CreateTestMarket();
+    market.SolveAuxiliarySubtask();
+    auto welfare = market.CalculateWelfare();
+
+    auto clone = market.Clone();
+    ASSERT_EQ(clone.GetEdges().size(), market.GetEdges().size());
+    for (size_t i = 0; i < market.GetEdges().size(); i++) {
+        EXPECT_NE(clone.GetEdges()[i], market.GetEdges()[i]);
+        EXPECT_NE(clone.GetEdges()[i]->GetStartNode(), market.GetEdges()[i]->GetStartNode());
+    }
+    clone.SolveAuxiliarySubtask();
+    EXPECT_NEAR(clone.CalculateWelfare(), welfare, kEPS);
+
+    for (auto&& edge : clone.GetEdges()) {
+        edge->SetAlgorithmType(AlgorithmType::L_plus);
+    }
+    clone.SolveAuxiliarySubtask();
+    for (auto&& edge : market.GetEdges()) {
+        EXPECT_NE(edge->GetAlgorithmType(), AlgorithmType::L_plus);
+    }
+    market.SolveAuxiliarySubtask();
+    EXPECT_NEAR(market.CalculateWelfare(), welfare, kEPS);
+}
+
+TEST(portfolio_solver, not_worse_than_strategies) {
+    for (auto capacity_scale : {1.0L, 5.0L}) {
+        auto market = CreateTestMarket(capacity_scale);
+        auto brute_force_market = market.Clone();
+        auto expected = BruteForce(brute_force_market, brute_force_market.GetEdges());
+
+        auto result = PortfolioSolver(market, 4).Solve();
+        EXPECT_TRUE(result.is_optimal);
+        EXPECT_NEAR(result.welfare, expected.welfare, kEPS);
+        EXPECT_NEAR(market.CalculateWelfare(), result.welfare, kEPS);
+        EXPECT_EQ(market.GetLplushLinesMask(), result.l_plus_lines_mask);
+        for (auto&& [strategy, welfare] : result.strategies_welfare) {
+            EXPECT_GE(result.welfare, welfare - kEPS) << strategy;
+        }
+    }
+}
@@ -0,0 +1,99 @@
+#include "random_stream.h"
+#include "star_chain_market.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+TEST(random_stream, philox_known_answers) {
+    EXPECT_EQ(RandomStream::Philox({0, 0, 0, 0}, {0, 0}),
+            (RandomStream::Block{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}));
+    EXPECT_EQ(RandomStream::Philox({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff}),
+            (RandomStream::Block{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}));
+    EXPECT_EQ(RandomStream::Philox({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0}),
+            (RandomStream::Block{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}));
+
+    RandomStream random(0);
+    EXPECT_EQ(random.Next(), 0xe169c58d6627e8d5ULL);
+    EXPECT_EQ(random.Next(), 0x9b00dbd8bc57ac4cULL);
+}
+
+TEST(random_stream, streams_are_reproducible) {
+    RandomStream lhs(42, 7), rhs(42, 7), other_stream(42, 8), other_seed(43, 7);
+    auto has_difference_with_other_stream = false, has_difference_with_other_seed = false;
+    for (int i = 0; i < 100; i++) {
+        auto value = lhs.Next();
+        EXPECT_EQ(value, rhs.Next());
+        has_difference_with_other_stream = has_difference_with_other_stream || value != other_stream.Next();
+        has_difference_with_other_seed = has_difference_with_other_seed || value != other_seed.Next();
+    }
+    EXPECT_TRUE(has_difference_with_other_stream);
+    EXPECT_TRUE(has_difference_with_other_seed);
+}
+
+TEST(random_stream, uniform_ranges) {
+    RandomStream random(1);
+    std::vector<int> counts(10);
+    for (int i = 0; i < 10000; i++) {
+        auto value = random.Uniform<int>(1, 10);
+        ASSERT_GE(value, 1);
+        ASSERT_LE(value, 10);
+        counts[value - 1]++;
+        auto real = random.Uniform<double>(-2.5, 3.5);
+        ASSERT_GE(real, -2.5);
+        ASSERT_LT(real, 3.5);
+    }
+    for (auto&& count : counts) {
+        EXPECT_GT(count, 800);
+    }
+    EXPECT_EQ(random.Uniform<int64_t>(5, 5), 5);
+    random.Uniform<int64_t>(std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max());
+}
+
+TEST(random_stream, market_is_same_for_seed_on_any_thread) {
+    auto market = StarChainMarket::GenerateRandomMarket(2, 3, 4, 17).value();
+    std::optional<StarChainMarket> thread_market;
+    std::thread thread([&thread_market] {
+        thread_market = StarChainMarket::GenerateRandomMarket(2, 3, 4, 17);
+    });
+    thread.join();
+    auto other_seed_market = StarChainMarket::GenerateRandomMarket(2, 3, 4, 18).value();
+    ASSERT_EQ(market.GetNodes().size(), thread_market->GetNodes().size());
+    auto has_difference = false;
+    for (size_t i = 0; i < market.GetNodes().size(); i++) {
+        EXPECT_EQ(market.GetNodes()[i]->GetZeroPrice(), thread_market->GetNodes()[i]->GetZeroPrice());
+        has_difference = has_difference
+                || market.GetNodes()[i]->GetZeroPrice() != other_seed_market.GetNodes()[i]->GetZeroPrice();
+    }
+    for (size_t i = 0; i < market.GetEdges().size(); i++) {
+        EXPECT_EQ(market.GetEdges()[i]->GetEdgeType(), thread_market->GetEdges()[i]->GetEdgeType());
+        EXPECT_EQ(market.GetEdges()[i]->Getet(), thread_market->GetEdges()[i]->Getet());
+        EXPECT_EQ(market.GetEdges()[i]->GetQ(), thread_market->GetEdges()[i]->GetQ());
+        EXPECT_EQ(market.GetEdges()[i]->Getef(), thread_market->GetEdges()[i]->Getef());
+        EXPECT_EQ(market.GetEdges()[i]->GetEvCoeff(), thread_market->GetEdges()[i]->GetEvCoeff());
+    }
+    EXPECT_TRUE(has_difference);
+}
+
+TEST(random_stream, thread_seed_repeats_values) {
+    SetThreadRandomSeed(5);
+    auto first = GenerateRandomValue(0, 1000000);
+    auto function = PiecewiseLinearFunction::GenerateSpFunction();
+    SetThreadRandomSeed(5);
+    EXPECT_EQ(GenerateRandomValue(0, 1000000), first);
+    EXPECT_EQ(PiecewiseLinearFunction::GenerateSpFunction().GetPoints().size(), function.GetPoints().size());
+}
+
+TEST(random_stream, seeded_markets_are_complete) {
+    // Every node gets own id, so all nodes and lines are added for any seed
+    for (uint64_t seed = 0; seed < 1000; seed++) {
+        ASSERT_TRUE(StarChainMarket::GenerateRandomMarket(4, 4, 3, seed)) << "seed " << seed;
+    }
+
+    std::vector<int64_t> roots;
+    for (int run = 0; run < 2; run++) {
+        SetThreadRandomSeed(3);
+        auto market = StarChainMarket::GenerateRandomMarket(2, 2, 6, 11).value();
+        market.BuildTreeMinDepth();
+        roots.push_back(market.GetRootNodePos());
+    }
+    EXPECT_EQ(roots[0], roots[1]);
+}
@@ -0,0 +1,107 @@
+#include "result_export.h"
+#include "helpers.h"
+#include "mapped_file.h"
+#include <gtest/gtest.h>
+#include <sstream>
+
+static StarChainMarket CreateSolvedTestMarket() {
+    auto market = CreateTestMarket();
+    auto edges = market.GetEdges();
+    for (size_t i = 0; i < edges.size(); i++) {
+        edges[i]->SetAlgorithmType(i % 2 ? AlgorithmType::L_plus : AlgorithmType::L_minus);
+    }
+    market.SolveAuxiliarySubtask();
+    return market;
+}
+
+TEST(result_export, columns_match_market) {
+    auto market = CreateSolvedTestMarket();
+    auto columns = ResultColumns::Collect(market);
+    auto nodes = market.GetNodes();
+    auto edges = market.GetEdges();
+    ASSERT_EQ(columns.nodes_prices.size(), nodes.size());
+    ASSERT_EQ(columns.lines_flows.size(), edges.size());
+    for (size_t i = 0; i < nodes.size(); i++) {
+        EXPECT_NEAR(columns.nodes_prices[i], nodes[i]->GetP(), kEPS);
+        EXPECT_NEAR(columns.nodes_vs[i], nodes[i]->GetVs(), kEPS);
+        EXPECT_NEAR(columns.nodes_vd[i], nodes[i]->GetVd(), kEPS);
+        EXPECT_EQ(columns.nodes_zero_prices[i],
+                double(nodes[i]->GetDeltaS().FindFunctionZeroValue().GetSinglePoint()));
+    }
+    // Zero price kept by node follows its functions
+    auto zero_price = nodes[0]->GetZeroPrice();
+    nodes[0]->SetFunctions(nodes[0]->GetD(), nodes[1]->GetS());
+    EXPECT_NE(nodes[0]->GetZeroPrice(), zero_price);
+    EXPECT_EQ(nodes[0]->GetZeroPrice(), nodes[0]->GetDeltaS().FindFunctionZeroValue().GetSinglePoint());
+
+    // Costs of lines are welfare terms
+    std::vector<double> nodes_balances(nodes.size(), 0);
+    for (size_t i = 0; i < edges.size(); i++) {
+        EXPECT_EQ(columns.lines_from[i], market.GetVectorPosByNode(edges[i]->GetStartNode()));
+        EXPECT_EQ(columns.lines_to[i], market.GetVectorPosByNode(edges[i]->GetEndNode()));
+        EXPECT_EQ(columns.lines_expand[i], i % 2);
+        EXPECT_EQ(columns.lines_algorithm_types[i], static_cast<uint8_t>(edges[i]->GetAlgorithmType()));
+        EXPECT_NEAR(columns.lines_transport_costs[i] + columns.lines_fixed_costs[i] + columns.lines_expansion_costs[i],
+                edges[i]->GetEValueAtPoint(edges[i]->Getqij()), 1e-6);
+        nodes_balances[columns.lines_from[i]] += columns.lines_flows[i];
+        nodes_balances[columns.lines_to[i]] -= columns.lines_flows[i];
+    }
+    // Node sends to lines what it supplies over its demand
+    for (size_t i = 0; i < nodes.size(); i++) {
+        EXPECT_NEAR(nodes_balances[i], columns.nodes_vs[i] - columns.nodes_vd[i], 1e-6);
+    }
+}
+
+TEST(result_export, mapped_binary) {
+    auto market = CreateSolvedTestMarket();
+    auto columns = ResultColumns::Collect(market);
+    auto path = ::testing::TempDir() + "result_export_test.bin";
+    {
+        std::ofstream os(path, std::ios_base::binary);
+        ResultExport::StoreBinary(os, columns);
+    }
+    MappedFile file(path);
+    ResultExport::View view(file.GetData());
+    EXPECT_EQ(view.GetNodesCount(), columns.nodes_prices.size());
+    EXPECT_EQ(view.GetLinesCount(), columns.lines_flows.size());
+    EXPECT_EQ(view.GetColumns().size(), 12);
+    auto prices = view.GetColumn<double>("p");
+    for (size_t i = 0; i < view.GetNodesCount(); i++) {
+        EXPECT_EQ(prices[i], columns.nodes_prices[i]);
+    }
+    auto flows = view.GetColumn<double>("flow");
+    auto expand = view.GetColumn<uint8_t>("expand");
+    auto from = view.GetColumn<uint32_t>("from");
+    for (size_t i = 0; i < view.GetLinesCount(); i++) {
+        EXPECT_EQ(flows[i], columns.lines_flows[i]);
+        EXPECT_EQ(expand[i], columns.lines_expand[i]);
+        EXPECT_EQ(from[i], columns.lines_from[i]);
+    }
+    EXPECT_THROW(view.GetColumn<uint32_t>("flow"), std::runtime_error);
+    EXPECT_THROW(view.GetColumn<double>("unknown"), std::runtime_error);
+}
+
+TEST(result_export, csv) {
+    auto market = CreateSolvedTestMarket();
+    auto columns = ResultColumns::Collect(market);
+    std::ostringstream nodes_csv;
+    ResultExport::StoreNodesCsv(nodes_csv, columns);
+    std::istringstream nodes_lines(nodes_csv.str());
+    std::string line;
+    std::getline(nodes_lines, line);
+    EXPECT_EQ(line, "p,vs,vd,zero_price");
+    std::getline(nodes_lines, line);
+    EXPECT_EQ(std::stod(line), columns.nodes_prices[0]);
+
+    std::ostringstream lines_csv;
+    ResultExport::StoreLinesCsv(lines_csv, columns);
+    std::istringstream lines_lines(lines_csv.str());
+    size_t rows_count = 0;
+    std::getline(lines_lines, line);
+    EXPECT_EQ(line, "from,to,flow,expand,algorithm_type,transport_cost,fixed_cost,expansion_cost");
+    while (std::getline(lines_lines, line)) {
+        EXPECT_EQ(std::count(line.begin(), line.end(), ','), 7);
+        rows_count++;
+    }
+    EXPECT_EQ(rows_count, columns.lines_flows.size());
+}
@@ -0,0 +1,82 @@
+#include "scenario_runner.h"
+#include "helpers.h"
+#include <gtest/gtest.h>
+#include <sstream>
+
+static void SetTestLinesTypes(StarChainMarket& market) {
+    auto edges = market.GetEdges();
+    for (size_t i = 0; i < edges.size(); i++) {
+        edges[i]->SetAlgorithmType(i % 2 ? AlgorithmType::L_plus : AlgorithmType::L_minus);
+    }
+}
+
+TEST(scenario_runner, same_as_full_solve_and_rolled_back) {
+    auto market = CreateTestMarket();
+    SetTestLinesTypes(market);
+    ScenarioRunner runner(market);
+    auto base_welfare = runner.GetBaseWelfare();
+    auto base_prices = std::vector<long double>();
+    for (auto&& node : market.GetNodes()) {
+        base_prices.push_back(node->GetP());
+    }
+
+    ScenarioDelta delta;
+    delta.nodes.push_back({1, std::nullopt, market.GetNodes()[5]->GetD()});
+    delta.lines.push_back({3, 1.5, 6, std::nullopt, std::nullopt});
+    delta.lines.push_back({6, std::nullopt, 0.5, std::nullopt, 1});
+
+    // Expected result of full solve of changed copy
+    auto changed = market.Clone();
+    changed.GetNodes()[1]->SetFunctions(market.GetNodes()[5]->GetD(), changed.GetNodes()[1]->GetS());
+    changed.GetEdges()[3]->SetParameters(1.5, 6, changed.GetEdges()[3]->Getef(), changed.GetEdges()[3]->GetEvCoeff());
+    changed.GetEdges()[6]->SetParameters(changed.GetEdges()[6]->Getet(), 0.5, changed.GetEdges()[6]->Getef(), 1);
+    changed.SolveAuxiliarySubtask();
+    auto expected_welfare = changed.CalculateWelfare();
+
+    for (int repeat = 0; repeat < 2; repeat++) {
+        auto result = runner.Run(delta);
+        EXPECT_NEAR(result.welfare, expected_welfare, kEPS);
+        EXPECT_NEAR(result.welfare_change, expected_welfare - base_welfare, kEPS);
+        ASSERT_EQ(result.nodes_prices.size(), 1);
+        EXPECT_NEAR(result.nodes_prices[0], changed.GetNodes()[1]->GetP(), kEPS);
+        ASSERT_EQ(result.lines_flows.size(), 2);
+        EXPECT_NEAR(result.lines_flows[1], changed.GetEdges()[6]->Getqij(), kEPS);
+        EXPECT_LT(result.rebalanced_nodes_count, int64_t(market.GetNodes().size()));
+
+        EXPECT_NEAR(market.CalculateWelfare(), base_welfare, kEPS);
+        for (size_t i = 0; i < base_prices.size(); i++) {
+            EXPECT_EQ(market.GetNodes()[i]->GetP(), base_prices[i]);
+        }
+        EXPECT_EQ(market.GetEdges()[3]->GetQ(), 2);
+    }
+
+    // Rolled back market is solved the same way as base market
+    market.SolveAuxiliarySubtask();
+    EXPECT_NEAR(market.CalculateWelfare(), base_welfare, kEPS);
+}
+
+TEST(scenario_runner, stream) {
+    auto market = CreateTestMarket();
+    SetTestLinesTypes(market);
+    ScenarioRunner runner(market);
+    std::stringstream scenarios;
+    scenarios << R"({"id":1,"lines":[{"line":0,"Q":6}]})" << "\n"
+              << R"({"id":2,"lines":[{"line":100,"Q":6}]})" << "\n"
+              << R"({"id":3})" << "\n";
+    std::ostringstream results;
+    EXPECT_EQ(runner.RunStream(scenarios, results), 1);
+
+    std::istringstream results_stream(results.str());
+    std::string line;
+    std::vector<JsonValue> lines;
+    while (std::getline(results_stream, line)) {
+        lines.push_back(JsonValue::Parse(line));
+    }
+    ASSERT_EQ(lines.size(), 3);
+    EXPECT_EQ(lines[0].At("status").GetString(), "ok");
+    EXPECT_EQ(lines[0].At("lines_flows").GetArray().size(), 1);
+    EXPECT_EQ(lines[1].At("status").GetString(), "error");
+    EXPECT_EQ(lines[2].At("id").GetInteger(), 3);
+    EXPECT_NEAR(lines[2].At("welfare_change").GetNumber(), 0, kEPS);
+    EXPECT_EQ(lines[2].At("rebalanced_nodes_count").GetInteger(), 0);
+}
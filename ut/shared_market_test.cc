@@ -0,0 +1,117 @@
+#include "shared_market.h"
+#include "helpers.h"
+#include <gtest/gtest.h>
+#include <fstream>
+
+static void SetTestLinesTypes(StarChainMarket& market) {
+    auto edges = market.GetEdges();
+    for (size_t i = 0; i < edges.size(); i++) {
+        edges[i]->SetAlgorithmType(i % 3 ? AlgorithmType::L_plus : AlgorithmType::L_minus);
+    }
+}
+
+TEST(shared_market, file_workspace) {
+    auto market = CreateTestMarket();
+    auto path = ::testing::TempDir() + "shared_market_test.bin";
+    {
+        std::ofstream os(path, std::ios_base::binary);
+        SharedMarket::Store(os, market);
+    }
+    SetTestLinesTypes(market);
+    market.SolveAuxiliarySubtask();
+
+    SharedMarket shared(path, SharedMarketSource::FILE);
+    EXPECT_EQ(shared.GetNodesCount(), market.GetNodes().size());
+    EXPECT_EQ(shared.GetLinesCount(), market.GetEdges().size());
+    auto workspace = shared.CreateWorkspace();
+    EXPECT_EQ(workspace.GetRootNodePos(), market.GetRootNodePos());
+    for (size_t i = 0; i < market.GetNodes().size(); i++) {
+        EXPECT_NEAR(workspace.GetNodes()[i]->GetZeroPrice(), market.GetNodes()[i]->GetZeroPrice(), kEPS);
+    }
+    SetTestLinesTypes(workspace);
+    workspace.SolveAuxiliarySubtask();
+    EXPECT_NEAR(workspace.CalculateWelfare(), market.CalculateWelfare(), kEPS);
+}
+
+TEST(shared_market, shared_memory_workspaces) {
+    auto market = StarChainMarket::GenerateRandomMarket(2, 3, 4);
+    ASSERT_TRUE(market);
+    market->BuildTreeMinDepth();
+    std::string name = "/shared_market_test_" + std::to_string(getpid());
+    SharedMarket::Publish(name, *market);
+    SharedMarket shared(name);
+    SharedMarket::Unpublish(name);
+    EXPECT_THROW(SharedMarket{name}, std::runtime_error);
+
+    // Attached model stays after object is removed, workspaces are independent, but share functions of model
+    auto first = shared.CreateWorkspace();
+    auto second = shared.CreateWorkspace();
+    EXPECT_EQ(first.GetRootNodePos(), market->GetRootNodePos());
+    auto first_nodes = first.GetNodes();
+    auto second_nodes = second.GetNodes();
+    for (size_t i = 0; i < first_nodes.size(); i++) {
+        for (auto&& [lhs, rhs] : {std::pair{first_nodes[i]->GetD(), second_nodes[i]->GetD()},
+                std::pair{first_nodes[i]->GetS(), second_nodes[i]->GetS()},
+                std::pair{first_nodes[i]->GetDeltaS(), second_nodes[i]->GetDeltaS()}}) {
+            EXPECT_TRUE(lhs.GetFunctionsStorage().IsBorrowed());
+            EXPECT_EQ(lhs.GetFunctionsStorage().begin(), rhs.GetFunctionsStorage().begin());
+        }
+    }
+    for (auto&& edge : first.GetEdges()) {
+        edge->SetAlgorithmType(AlgorithmType::L_plus);
+    }
+    for (auto&& edge : second.GetEdges()) {
+        edge->SetAlgorithmType(AlgorithmType::L_minus);
+    }
+    first.SolveAuxiliarySubtask();
+    second.SolveAuxiliarySubtask();
+    for (auto&& edge : market->GetEdges()) {
+        edge->SetAlgorithmType(AlgorithmType::L_plus);
+    }
+    market->SolveAuxiliarySubtask();
+    EXPECT_NEAR(first.CalculateWelfare(), market->CalculateWelfare(), kEPS);
+    for (auto&& edge : market->GetEdges()) {
+        edge->SetAlgorithmType(AlgorithmType::L_minus);
+    }
+    market->SolveAuxiliarySubtask();
+    EXPECT_NEAR(second.CalculateWelfare(), market->CalculateWelfare(), kEPS);
+    for (size_t i = 0; i < first_nodes.size(); i++) {
+        EXPECT_TRUE(first_nodes[i]->GetDeltaS().GetFunctionsStorage().IsBorrowed());
+    }
+}
+
+TEST(shared_market, workspace_outlives_model) {
+    auto market = CreateTestMarket();
+    auto path = ::testing::TempDir() + "shared_market_test.bin";
+    {
+        std::ofstream os(path, std::ios_base::binary);
+        SharedMarket::Store(os, market);
+    }
+    auto workspace = SharedMarket(path, SharedMarketSource::FILE).CreateWorkspace();
+    SetTestLinesTypes(market);
+    market.SolveAuxiliarySubtask();
+    SetTestLinesTypes(workspace);
+    workspace.SolveAuxiliarySubtask();
+    EXPECT_NEAR(workspace.CalculateWelfare(), market.CalculateWelfare(), kEPS);
+}
+
+TEST(shared_market, invalid_model) {
+    auto path = ::testing::TempDir() + "shared_market_test.bin";
+    {
+        std::ofstream os(path, std::ios_base::binary);
+        os << "not a shared market model, just some text long enough for header";
+    }
+    EXPECT_THROW(SharedMarket(path, SharedMarketSource::FILE), std::runtime_error);
+
+    // Model which is being published has zero header
+    {
+        std::ofstream os(path, std::ios_base::binary);
+        os << std::string(4096, '\0');
+    }
+    try {
+        SharedMarket market(path, SharedMarketSource::FILE);
+        FAIL() << "Model without header is attached";
+    } catch (const std::runtime_error& error) {
+        EXPECT_EQ(std::string(error.what()), "Shared market is not published yet");
+    }
+}
@@ -0,0 +1,191 @@
+#include "solver_service.h"
+#include "helpers.h"
+#include "market_writer.h"
+#include <cstring>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <thread>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static std::string TestMarketJson() {
+    auto market = CreateTestMarket();
+    std::ostringstream market_text;
+    MarketWriter(market_text).Write(market);
+    std::string market_json = R"({"text":)";
+    WriteJsonString(market_json, market_text.str());
+    return market_json + "}";
+}
+
+TEST(solver_service, resident_markets) {
+    SolverService service(2);
+    auto handle = [&](const std::string& request) {
+        return JsonValue::Parse(service.Handle(request));
+    };
+    auto loaded = handle(R"({"id":1,"operation":"load","market_id":"test","market":)" + TestMarketJson() + "}");
+    EXPECT_EQ(loaded.At("status").GetString(), "ok");
+    EXPECT_EQ(loaded.At("lines_count").GetInteger(), 7);
+
+    auto solved = handle(R"({"id":2,"operation":"solve_mask","market_id":"test","mask":"1111111"})");
+    EXPECT_EQ(solved.At("status").GetString(), "ok");
+    auto brute_force = handle(R"({"id":3,"operation":"brute_force","market_id":"test"})");
+    auto algorithm = handle(R"({"id":4,"operation":"algorithm","market_id":"test"})");
+    // Types of previous request are cleared
+    auto brute_force_again = handle(R"({"id":5,"operation":"brute_force","market_id":"test"})");
+    EXPECT_NEAR(brute_force.At("welfare").GetNumber(), brute_force_again.At("welfare").GetNumber(), kEPS);
+    EXPECT_NEAR(algorithm.At("welfare").GetNumber(), brute_force.At("welfare").GetNumber(), kEPS);
+
+    auto what_if = handle(R"({"id":6,"operation":"what_if","market_id":"test","mask":"1111111","scenario":{}})");
+    EXPECT_NEAR(what_if.At("welfare").GetNumber(), solved.At("welfare").GetNumber(), kEPS);
+    EXPECT_NEAR(what_if.At("welfare_change").GetNumber(), 0, kEPS);
+    auto what_if_line = handle(R"({"id":7,"operation":"what_if","market_id":"test","scenario":{"lines":[{"line":0,"Q":6}]}})");
+    EXPECT_EQ(what_if_line.At("status").GetString(), "ok");
+    // Cached market of the same mask gives the same result, other operations don't change it
+    auto what_if_line_again = handle(R"({"id":7,"operation":"what_if","market_id":"test","scenario":{"lines":[{"line":0,"Q":6}]}})");
+    EXPECT_NEAR(what_if_line_again.At("welfare").GetNumber(), what_if_line.At("welfare").GetNumber(), kEPS);
+    handle(R"({"id":8,"operation":"algorithm","market_id":"test"})");
+    auto what_if_after_solve = handle(R"({"id":9,"operation":"what_if","market_id":"test","mask":"1111111","scenario":{}})");
+    EXPECT_NEAR(what_if_after_solve.At("welfare").GetNumber(), solved.At("welfare").GetNumber(), kEPS);
+
+    EXPECT_EQ(handle(R"({"operation":"list"})").At("market_ids").GetArray().size(), 1);
+    EXPECT_EQ(handle(R"({"operation":"unload","market_id":"test"})").At("status").GetString(), "ok");
+    auto unknown = handle(R"({"id":10,"operation":"algorithm","market_id":"test"})");
+    EXPECT_EQ(unknown.At("status").GetString(), "error");
+    EXPECT_EQ(unknown.At("id").GetInteger(), 10);
+}
+
+TEST(solver_service, socket_clients) {
+    SolverService service(2);
+    auto path = ::testing::TempDir() + "solver_service_test.sock";
+    std::thread server([&] {
+        service.ServeSocket(path);
+    });
+
+    auto connect_client = [&] {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::strcpy(address.sun_path, path.c_str());
+        auto fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        for (int attempt = 0; attempt < 100; attempt++) {
+            if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+                return fd;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        close(fd);
+        return -1;
+    };
+    auto exchange = [&](const std::string& requests, size_t responses_count) {
+        auto fd = connect_client();
+        EXPECT_GE(fd, 0);
+        EXPECT_EQ(write(fd, requests.data(), requests.size()), ssize_t(requests.size()));
+        shutdown(fd, SHUT_WR);
+        std::string text;
+        char buffer[4096];
+        ssize_t read_size;
+        while ((read_size = read(fd, buffer, sizeof(buffer))) > 0) {
+            text.append(buffer, read_size);
+        }
+        close(fd);
+        std::vector<JsonValue> responses;
+        std::istringstream stream(text);
+        std::string line;
+        while (std::getline(stream, line)) {
+            responses.push_back(JsonValue::Parse(line));
+        }
+        EXPECT_EQ(responses.size(), responses_count);
+        return responses;
+    };
+
+    auto loaded = exchange(R"({"id":"load","operation":"load","market_id":"m","market":)" + TestMarketJson() + "}\n", 1);
+    EXPECT_EQ(loaded[0].At("status").GetString(), "ok");
+    std::vector<std::thread> clients;
+    for (int client = 0; client < 3; client++) {
+        clients.emplace_back([&] {
+            std::string requests;
+            for (int i = 0; i < 4; i++) {
+                requests += R"({"id":)" + std::to_string(i) + R"(,"operation":"solve_mask","market_id":"m","mask":"0101010"})" + "\n";
+            }
+            for (auto&& response : exchange(requests, 4)) {
+                EXPECT_EQ(response.At("status").GetString(), "ok");
+            }
+        });
+    }
+    for (auto&& client : clients) {
+        client.join();
+    }
+
+    // Client closes right after writing, its load is run without response
+    auto fd = connect_client();
+    ASSERT_GE(fd, 0);
+    auto load = R"({"operation":"load","market_id":"closed","market":)" + TestMarketJson() + "}\n";
+    EXPECT_EQ(write(fd, load.data(), load.size()), ssize_t(load.size()));
+    close(fd);
+    auto is_loaded = false;
+    for (int attempt = 0; attempt < 200 && !is_loaded; attempt++) {
+        auto listed = exchange(R"({"operation":"list"})" "\n", 1);
+        for (auto&& market_id : listed.at(0).At("market_ids").GetArray()) {
+            is_loaded = is_loaded || market_id.GetString() == "closed";
+        }
+        if (!is_loaded) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+    EXPECT_TRUE(is_loaded);
+    service.Stop();
+    server.join();
+}
+
+TEST(solver_service, stream) {
+    SolverService service(2);
+    std::stringstream requests;
+    requests << R"({"id":1,"operation":"load","market_id":"m","market":)" << TestMarketJson() << "}\n";
+    std::ostringstream responses;
+    service.ServeStream(requests, responses);
+    EXPECT_NE(responses.str().find(R"("status":"ok")"), std::string::npos);
+}
+
+TEST(solver_service, socket_path_of_regular_file_is_kept) {
+    auto path = ::testing::TempDir() + "solver_service_test_file.sock";
+    {
+        std::ofstream file(path);
+        file << "data";
+    }
+    SolverService service(1);
+    EXPECT_THROW(service.ServeSocket(path), std::runtime_error);
+    std::ifstream file(path);
+    std::string text;
+    file >> text;
+    EXPECT_EQ(text, "data");
+    std::remove(path.c_str());
+}
+
+TEST(solver_service, market_requests_in_order_of_arrival) {
+    SolverService service(4);
+    std::stringstream requests;
+    // Requests after load wait in queue of the market until it is loaded
+    requests << R"({"id":0,"operation":"load","market_id":"m","market":)" << TestMarketJson() << "}\n";
+    const int requests_count = 20;
+    for (int i = 1; i <= requests_count; i++) {
+        requests << R"({"id":)" << i << R"(,"operation":"solve_mask","market_id":"m","mask":")"
+                 << (i % 2 ? "0101010" : "1111111") << "\"}\n";
+    }
+    requests << R"({"id":"list","operation":"list"})" << "\n";
+    std::ostringstream responses;
+    service.ServeStream(requests, responses);
+
+    std::istringstream stream(responses.str());
+    std::string line;
+    int64_t next_id = 0;
+    while (std::getline(stream, line)) {
+        auto response = JsonValue::Parse(line);
+        EXPECT_EQ(response.At("status").GetString(), "ok") << line;
+        if (response.At("id").IsString()) {
+            continue;
+        }
+        EXPECT_EQ(response.At("id").GetInteger(), next_id++);
+    }
+    EXPECT_EQ(next_id, requests_count + 1);
+}
@@ -2,6 +2,7 @@
 #include "piecewise_linear_function.h"
 #include "helpers.h"
 #include "star_chain_market.h"
+#include "market_generator.h"
 #include <gtest/gtest.h>
 #include <cmath>
 
@@ -374,3 +375,256 @@ TEST(star_chain_market, auxularity_subtask3) {
 
     market.PrintAll();
 }
+
+TEST(star_chain_market, solve_auxiliary_subtask_along_path) {
+    auto market = CreateTestMarket();
+    for (auto&& edge : market.GetEdges()) {
+        edge->SetAlgorithmType(AlgorithmType::L_minus);
+    }
+    market.SolveAuxiliarySubtask();
+
+    for (auto&& edge : market.GetEdges()) {
+        edge->SetAlgorithmType(AlgorithmType::L_plus);
+        auto rebalanced_nodes_count = market.SolveAuxiliarySubtaskAlongPath(edge);
+        EXPECT_GE(rebalanced_nodes_count, 1);
+        EXPECT_LE(rebalanced_nodes_count, static_cast<int64_t>(market.GetNodes().size()) - 1);
+        auto welfare_along_path = market.CalculateWelfare();
+        std::vector<long double> prices;
+        for (auto&& node : market.GetNodes()) {
+            prices.push_back(node->GetP());
+        }
+
+        market.SolveAuxiliarySubtask();
+        EXPECT_NEAR(market.CalculateWelfare(), welfare_along_path, kEPS);
+        auto nodes = market.GetNodes();
+        for (size_t i = 0; i < nodes.size(); i++) {
+            EXPECT_NEAR(nodes[i]->GetP(), prices[i], kEPS);
+        }
+    }
+}
+
+TEST(star_chain_market, line_expansion_bound) {
+    auto market = CreateTestMarket();
+    auto edges = market.GetEdges();
+    for (uint64_t mask = 0; mask < (uint64_t(1) << edges.size()); mask++) {
+        for (size_t i = 0; i < edges.size(); i++) {
+            edges[i]->SetAlgorithmType(((mask >> i) & 1) ? AlgorithmType::L_plus : AlgorithmType::L_minus);
+        }
+        market.SolveAuxiliarySubtask();
+        auto welfare_without_line = market.CalculateWelfare();
+        auto bounds = market.ScreenLinesExpansion();
+        for (size_t i = 0; i < edges.size(); i++) {
+            if ((mask >> i) & 1) {
+                continue;
+            }
+            edges[i]->SetAlgorithmType(AlgorithmType::L_plus);
+            market.SolveAuxiliarySubtask();
+            auto welfare_change = market.CalculateWelfare() - welfare_without_line;
+            EXPECT_GE(welfare_change, bounds[i].lower - kEPS);
+            EXPECT_LE(welfare_change, bounds[i].upper + kEPS);
+            edges[i]->SetAlgorithmType(AlgorithmType::L_minus);
+        }
+    }
+}
+
+TEST(star_chain_market, compare_welfare_screened) {
+    auto screened_market = CreateTestMarket();
+    auto market = CreateTestMarket();
+    int screened_tasks_solved = 0;
+    int tasks_solved = 0;
+    for (auto line_type : {EdgeType::STAR_TO_CENTER, EdgeType::STAR_FROM_CENTER,
+            EdgeType::CHAIN_TO_CENTER, EdgeType::CHAIN_FROM_CENTER}) {
+        std::vector<std::shared_ptr<Edge>> candidate_lines;
+        for (auto&& edge : screened_market.GetEdges()) {
+            if (edge->GetEdgeType() == line_type && edge->GetAlgorithmType() == AlgorithmType::L_undefined) {
+                candidate_lines.push_back(edge);
+            }
+        }
+        screened_market.CompareWelrafeAndChangeLinesScreened(candidate_lines, AdditionalTypes.at(line_type),
+                AlgorithmType::L_minus, std::greater_equal<>(), screened_tasks_solved);
+        market.CompareWelrafeAndChangeLinesSubset(line_type, AdditionalTypes, AlgorithmType::L_minus,
+                std::greater_equal<>(), tasks_solved);
+    }
+    auto screened_edges = screened_market.GetEdges();
+    auto edges = market.GetEdges();
+    for (size_t i = 0; i < edges.size(); i++) {
+        EXPECT_EQ(screened_edges[i]->GetAlgorithmType(), edges[i]->GetAlgorithmType());
+    }
+    EXPECT_LE(screened_tasks_solved, tasks_solved);
+}
+
+TEST(star_chain_market, welfare_with_each_line_flipped) {
+    auto market = CreateTestMarket();
+    auto edges = market.GetEdges();
+    for (uint64_t mask = 0; mask < (uint64_t(1) << edges.size()); mask++) {
+        for (size_t i = 0; i < edges.size(); i++) {
+            edges[i]->SetAlgorithmType(((mask >> i) & 1) ? AlgorithmType::L_plus : AlgorithmType::L_minus);
+        }
+        market.SolveAuxiliarySubtask();
+        auto flipped_welfare = market.CalculateWelfareWithEachLineFlipped();
+        ASSERT_EQ(flipped_welfare.size(), edges.size());
+
+        for (size_t i = 0; i < edges.size(); i++) {
+            edges[i]->SetAlgorithmType(((mask >> i) & 1) ? AlgorithmType::L_minus : AlgorithmType::L_plus);
+            market.SolveAuxiliarySubtask();
+            EXPECT_NEAR(flipped_welfare[i], market.CalculateWelfare(), 1e-6) << "mask " << mask << " line " << i;
+            edges[i]->SetAlgorithmType(((mask >> i) & 1) ? AlgorithmType::L_plus : AlgorithmType::L_minus);
+        }
+        market.SolveAuxiliarySubtask();
+    }
+}
+
+TEST(star_chain_market, welfare_with_each_line_flipped_at_wide_hub) {
+    for (uint64_t seed = 0; seed < 5; seed++) {
+        auto market = StarChainMarket::GenerateRandomMarket(7, 6, 3, seed).value();
+        market.BuildTreeMinDepth();
+        auto edges = market.GetEdges();
+        for (size_t i = 0; i < edges.size(); i++) {
+            edges[i]->SetAlgorithmType((seed >> (i % 3)) & 1 ? AlgorithmType::L_plus : AlgorithmType::L_minus);
+        }
+        market.SolveAuxiliarySubtask();
+        auto flipped_welfare = market.CalculateWelfareWithEachLineFlipped();
+        for (size_t i = 0; i < edges.size(); i++) {
+            auto type = edges[i]->GetAlgorithmType();
+            edges[i]->SetAlgorithmType(type == AlgorithmType::L_plus ? AlgorithmType::L_minus : AlgorithmType::L_plus);
+            market.SolveAuxiliarySubtask();
+            EXPECT_NEAR(flipped_welfare[i], market.CalculateWelfare(), 1e-6) << "seed " << seed << " line " << i;
+            edges[i]->SetAlgorithmType(type);
+        }
+    }
+}
+
+TEST(star_chain_market, presolve) {
+    // Lines of wide capacity can't be saturated
+    auto market = CreateTestMarket(5);
+    auto edges = market.GetEdges();
+    long double best_welfare = -1e9;
+    for (uint64_t mask = 0; mask < (uint64_t(1) << edges.size()); mask++) {
+        for (size_t i = 0; i < edges.size(); i++) {
+            edges[i]->SetAlgorithmType(((mask >> i) & 1) ? AlgorithmType::L_plus : AlgorithmType::L_minus);
+        }
+        market.SolveAuxiliarySubtask();
+        best_welfare = std::max(best_welfare, market.CalculateWelfare());
+    }
+    market.ClearMarketEdgesAlgorithmType();
+
+    auto result = market.Presolve();
+    auto free_lines = market.GetUndefinedEdges();
+    EXPECT_GT(result.GetFixedLinesCount(), 0);
+    EXPECT_EQ(result.GetFixedLinesCount() + int64_t(free_lines.size()), int64_t(edges.size()));
+    std::vector<AlgorithmType> presolved_types;
+    for (auto&& edge : edges) {
+        presolved_types.push_back(edge->GetAlgorithmType());
+    }
+
+    // Lines fixed as L_minus are never saturated and optimum over free lines is the same
+    long double best_presolved_welfare = -1e9;
+    for (uint64_t mask = 0; mask < (uint64_t(1) << edges.size()); mask++) {
+        for (size_t i = 0; i < edges.size(); i++) {
+            edges[i]->SetAlgorithmType(((mask >> i) & 1) ? AlgorithmType::L_plus : AlgorithmType::L_minus);
+        }
+        market.SolveAuxiliarySubtask();
+        bool is_presolved_mask = true;
+        for (size_t i = 0; i < edges.size(); i++) {
+            if (presolved_types[i] == AlgorithmType::L_minus) {
+                EXPECT_LT(fabs(edges[i]->Getqij()), edges[i]->GetQ() + kEPS);
+                is_presolved_mask = is_presolved_mask && !((mask >> i) & 1);
+            } else if (presolved_types[i] == AlgorithmType::L_plus) {
+                is_presolved_mask = is_presolved_mask && ((mask >> i) & 1);
+            }
+        }
+        if (is_presolved_mask) {
+            best_presolved_welfare = std::max(best_presolved_welfare, market.CalculateWelfare());
+        }
+    }
+    EXPECT_NEAR(best_presolved_welfare, best_welfare, kEPS);
+}
+
+/*
+ * Presolve rules applied to sides of each line collected by search from line ends
+ */
+static std::vector<AlgorithmType> PresolveBySideSearch(StarChainMarket& market) {
+    auto nodes = market.GetNodes();
+    auto& matrix = market.GetMatrix();
+    std::vector<AlgorithmType> types;
+    for (auto&& edge : market.GetEdges()) {
+        if (edge->Getef() <= 0) {
+            types.push_back(AlgorithmType::L_plus);
+            continue;
+        }
+        std::vector<bool> used(nodes.size(), false);
+        auto collect_side = [&](std::shared_ptr<Node> from) {
+            std::vector<std::shared_ptr<Node>> side;
+            std::vector<size_t> stack{static_cast<size_t>(market.GetVectorPosByNode(from))};
+            used[stack[0]] = true;
+            while (!stack.empty()) {
+                auto node_pos = stack.back();
+                stack.pop_back();
+                side.push_back(nodes[node_pos]);
+                for (auto&& line : matrix[node_pos]) {
+                    auto to_pos = market.GetVectorPosByNode(line->GetAnotherNode(nodes[node_pos]));
+                    if (line != edge && !used[to_pos]) {
+                        used[to_pos] = true;
+                        stack.push_back(to_pos);
+                    }
+                }
+            }
+            return side;
+        };
+        auto start_side = collect_side(edge->GetStartNode());
+        auto end_side = collect_side(edge->GetEndNode());
+        auto prices_range = [](const std::vector<std::shared_ptr<Node>>& side) {
+            auto min_price = std::numeric_limits<long double>::max();
+            auto max_price = std::numeric_limits<long double>::lowest();
+            for (auto&& node : side) {
+                min_price = std::min(min_price, node->GetZeroPrice());
+                max_price = std::max(max_price, node->GetZeroPrice());
+            }
+            return std::make_pair(min_price, max_price);
+        };
+        auto [start_min_price, start_max_price] = prices_range(start_side);
+        auto [end_min_price, end_max_price] = prices_range(end_side);
+        if (end_max_price - start_min_price < edge->Getet() - kEPS) {
+            types.push_back(AlgorithmType::L_minus);
+            continue;
+        }
+        auto side_balance = [](const std::vector<std::shared_ptr<Node>>& side, long double price, bool is_max) {
+            long double balance = 0;
+            for (auto&& node : side) {
+                auto delta_S = node->GetDeltaS();
+                auto domain = delta_S.GetFunctionDomain();
+                auto value = delta_S.GetValueAtPoint(std::max(domain.GetStart(), std::min(domain.GetEnd(), price)));
+                balance += is_max ? value.GetEnd() : value.GetStart();
+            }
+            return balance;
+        };
+        auto max_export = side_balance(start_side, std::max(start_max_price, end_max_price - edge->Getet()), true);
+        auto max_import = -side_balance(end_side, std::min(end_min_price, start_min_price + edge->Getet()), false);
+        types.push_back(std::min(max_export, max_import) < edge->GetQ() - kEPS ? AlgorithmType::L_minus :
+                AlgorithmType::L_undefined);
+    }
+    return types;
+}
+
+TEST(star_chain_market, presolve_same_as_side_search) {
+    std::vector<StarChainMarket> markets{CreateTestMarket(), CreateTestMarket(5)};
+    for (uint64_t seed = 0; seed < 10; seed++) {
+        markets.push_back(StarChainMarket::GenerateRandomMarket(6, 6, 8, seed).value());
+        MarketGeneratorOptions options;
+        options.import_star_nodes_count = 5;
+        options.export_star_nodes_count = 5;
+        options.chains_count = 3;
+        options.chain_length = 4;
+        options.seed = seed;
+        markets.push_back(MarketGenerator(options).Generate());
+    }
+    for (auto&& market : markets) {
+        auto expected_types = PresolveBySideSearch(market);
+        market.ClearMarketEdgesAlgorithmType();
+        market.Presolve();
+        auto edges = market.GetEdges();
+        for (size_t i = 0; i < edges.size(); i++) {
+            EXPECT_EQ(edges[i]->GetAlgorithmType(), expected_types[i]) << "line " << i;
+        }
+    }
+}
@@ -0,0 +1,76 @@
+#include "algorithm.h"
+#include "tree_dynamic_program.h"
+#include "helpers.h"
+#include <gtest/gtest.h>
+
+TEST(tree_dynamic_program, same_as_brute_force) {
+    auto market = CreateTestMarket();
+    auto edges = market.GetEdges();
+    long double best_welfare = -1e9;
+    for (uint64_t mask = 0; mask < (uint64_t(1) << edges.size()); mask++) {
+        for (size_t i = 0; i < edges.size(); i++) {
+            edges[i]->SetAlgorithmType(((mask >> i) & 1) ? AlgorithmType::L_plus : AlgorithmType::L_minus);
+        }
+        market.SolveAuxiliarySubtask();
+        best_welfare = std::max(best_welfare, market.CalculateWelfare());
+    }
+
+    auto result = TreeDynamicProgram(market).Solve();
+    EXPECT_NEAR(result.welfare, best_welfare, 1e-6);
+    EXPECT_EQ(result.l_plus_lines_mask, market.GetLplushLinesMask());
+    EXPECT_LE(result.max_frontier_size, size_t(1) << edges.size());
+}
+
+TEST(tree_dynamic_program, fixed_lines_keep_types) {
+    auto market = CreateTestMarket();
+    auto edges = market.GetEdges();
+    // Star lines are decided, chain lines are free
+    edges[0]->SetAlgorithmType(AlgorithmType::L_plus);
+    edges[1]->SetAlgorithmType(AlgorithmType::L_minus);
+    edges[2]->SetAlgorithmType(AlgorithmType::L_plus);
+    edges[3]->SetAlgorithmType(AlgorithmType::L_minus);
+    std::vector<std::shared_ptr<Edge>> chain_lines(edges.begin() + 4, edges.end());
+
+    long double best_welfare = -1e9;
+    for (uint64_t mask = 0; mask < (uint64_t(1) << chain_lines.size()); mask++) {
+        for (size_t i = 0; i < chain_lines.size(); i++) {
+            chain_lines[i]->SetAlgorithmType(((mask >> i) & 1) ? AlgorithmType::L_plus : AlgorithmType::L_minus);
+        }
+        market.SolveAuxiliarySubtask();
+        best_welfare = std::max(best_welfare, market.CalculateWelfare());
+    }
+    market.ClearMarketEdgesAlgorithmType();
+    edges[0]->SetAlgorithmType(AlgorithmType::L_plus);
+    edges[1]->SetAlgorithmType(AlgorithmType::L_minus);
+    edges[2]->SetAlgorithmType(AlgorithmType::L_plus);
+    edges[3]->SetAlgorithmType(AlgorithmType::L_minus);
+
+    auto result = TreeDynamicProgram(market, chain_lines).Solve();
+    EXPECT_NEAR(result.welfare, best_welfare, 1e-6);
+    EXPECT_EQ(edges[0]->GetAlgorithmType(), AlgorithmType::L_plus);
+    EXPECT_EQ(edges[1]->GetAlgorithmType(), AlgorithmType::L_minus);
+    EXPECT_EQ(edges[2]->GetAlgorithmType(), AlgorithmType::L_plus);
+    EXPECT_EQ(edges[3]->GetAlgorithmType(), AlgorithmType::L_minus);
+    EXPECT_EQ(market.UndefinedLinesCount(), 0);
+}
+
+TEST(tree_dynamic_program, chain_lines_jointly_count_changed_lines) {
+    auto market = CreateTestMarket();
+    auto edges = market.GetEdges();
+    edges[0]->SetAlgorithmType(AlgorithmType::L_plus);
+    edges[1]->SetAlgorithmType(AlgorithmType::L_minus);
+    edges[2]->SetAlgorithmType(AlgorithmType::L_plus);
+    edges[3]->SetAlgorithmType(AlgorithmType::L_minus);
+    LinesWorklist worklist(market);
+    int tasks_solved = 0;
+    auto changed_lines = AlgorithmProcessChainLinesJointly(market, worklist, tasks_solved);
+
+    int l_plus_chain_lines = 0;
+    for (size_t i = 4; i < edges.size(); i++) {
+        EXPECT_NE(edges[i]->GetAlgorithmType(), AlgorithmType::L_undefined);
+        l_plus_chain_lines += edges[i]->GetAlgorithmType() == AlgorithmType::L_plus;
+    }
+    EXPECT_EQ(changed_lines, l_plus_chain_lines);
+    // At least one configuration of whole tree and final solve
+    EXPECT_GE(tasks_solved, 2);
+}